@@ -6,9 +6,10 @@
 
 #include <string.h>
 
-void ap_ring_init(ap_ring_t *ring)
+void ap_ring_init(ap_ring_t *ring, audio_sample_t *storage)
 {
-    memset(ring->samples, 0, sizeof(ring->samples));
+    ring->samples = storage;
+    memset(ring->samples, 0, AP_RING_BYTES);
     ring->write_idx = 0;
     ring->read_idx = 0;
 }
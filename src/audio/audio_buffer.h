@@ -15,14 +15,18 @@
 #define AP_RING_SIZE 2048
 #define AP_RING_MASK (AP_RING_SIZE - 1)
 
+// Storage size in bytes. Storage is provided by the owner and aligned to this
+// so DMA can ring-wrap over it (packed I2S capture writes samples there directly)
+#define AP_RING_BYTES (AP_RING_SIZE * 4)
+
 typedef struct {
-    audio_sample_t samples[AP_RING_SIZE];
+    audio_sample_t *samples;     // AP_RING_SIZE entries, aligned to AP_RING_BYTES
     volatile uint32_t write_idx; // Written by producer (DMA/interrupt)
     volatile uint32_t read_idx;  // Written by consumer (processing)
 } ap_ring_t;
 
-// Initialize ring buffer
-void ap_ring_init(ap_ring_t *ring);
+// Initialize ring buffer over caller-provided storage (AP_RING_SIZE samples)
+void ap_ring_init(ap_ring_t *ring, audio_sample_t *storage);
 
 // Get number of samples available to read
 static inline uint32_t ap_ring_available(ap_ring_t *ring)
@@ -63,4 +67,48 @@ static inline void ap_ring_write_advance(ap_ring_t *ring, uint32_t n)
     ring->write_idx += n;
 }
 
+// Contiguous region of ring storage
+typedef struct {
+    audio_sample_t *data;
+    uint32_t count;
+} ap_span_t;
+
+// Split n samples starting at idx into at most two contiguous spans
+// (second span is non-empty only when the region wraps past the end)
+static inline void ap_ring_split(ap_ring_t *ring, uint32_t idx, uint32_t n, ap_span_t spans[2])
+{
+    uint32_t pos = idx & AP_RING_MASK;
+    uint32_t first = AP_RING_SIZE - pos;
+    if (first > n)
+        first = n;
+    spans[0].data = &ring->samples[pos];
+    spans[0].count = first;
+    spans[1].data = &ring->samples[0];
+    spans[1].count = n - first;
+}
+
+// Get readable samples as up to two spans, returns total count.
+// Consumer may process the spans in place; release with ap_ring_read_advance()
+static inline uint32_t ap_ring_read_spans(ap_ring_t *ring, ap_span_t spans[2])
+{
+    uint32_t n = ap_ring_available(ring);
+    ap_ring_split(ring, ring->read_idx, n, spans);
+    return n;
+}
+
+// Get free space as up to two spans, returns total count.
+// Producer fills the spans, then publishes with ap_ring_write_advance()
+static inline uint32_t ap_ring_write_spans(ap_ring_t *ring, ap_span_t spans[2])
+{
+    uint32_t n = ap_ring_free(ring);
+    ap_ring_split(ring, ring->write_idx, n, spans);
+    return n;
+}
+
+// Release n samples after processing them in place
+static inline void ap_ring_read_advance(ap_ring_t *ring, uint32_t n)
+{
+    ring->read_idx += n;
+}
+
 #endif // AUDIO_BUFFER_H
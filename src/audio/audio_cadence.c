@@ -0,0 +1,90 @@
+/**
+ * Frame-Locked Packet Cadence Implementation
+ *
+ * Quota per frame: carry += sample_rate * 1000 each frame, and every
+ * SAMPLES_PER_PACKET * frame_rate_mhz of carry is one packet, so the long-run
+ * packet rate is exactly sample_rate / SAMPLES_PER_PACKET per second.
+ */
+
+#include "audio_cadence.h"
+
+#include <string.h>
+
+// Packets in the next frame's quota (advances the fractional carry)
+static uint32_t cadence_next_quota(audio_cadence_t *c)
+{
+    const uint32_t per_packet = AUDIO_CADENCE_SAMPLES_PER_PACKET * c->frame_rate_mhz;
+    c->carry += c->sample_rate * 1000u;
+    uint32_t packets = c->carry / per_packet;
+    c->carry -= packets * per_packet;
+    return packets;
+}
+
+// Packets in the quotas of `frames` frames at once (same carry as calling
+// cadence_next_quota that many times, without the loop for long stalls)
+static uint64_t cadence_skip_quota(audio_cadence_t *c, uint32_t frames)
+{
+    const uint32_t per_packet = AUDIO_CADENCE_SAMPLES_PER_PACKET * c->frame_rate_mhz;
+    uint64_t carry = c->carry + (uint64_t)frames * c->sample_rate * 1000u;
+    uint64_t packets = carry / per_packet;
+    c->carry = (uint32_t)(carry - packets * per_packet);
+    return packets;
+}
+
+void audio_cadence_init(audio_cadence_t *c, uint32_t sample_rate, uint32_t frame_rate_mhz)
+{
+    memset(c, 0, sizeof(*c));
+    c->sample_rate = sample_rate;
+    c->frame_rate_mhz = frame_rate_mhz;
+}
+
+uint32_t audio_cadence_frame(audio_cadence_t *c, uint32_t frame)
+{
+    if (!c->started) {
+        c->started = true;
+        c->frame = frame;
+        c->frame_packets = cadence_next_quota(c);
+        return 0;
+    }
+    if (frame == c->frame)
+        return 0;
+
+    uint32_t quota = c->debt + c->frame_packets;
+    uint32_t owed = quota > c->released ? quota - c->released : 0;
+
+    // Frames that went by without a call (Core 1 stalled) were due as well.
+    // All of them go into owed (and the carry) so packets_missed counts every
+    // packet; the debt limit is applied below.
+    uint32_t skipped = frame - c->frame - 1;
+    if (skipped > 0) {
+        uint64_t total = owed + cadence_skip_quota(c, skipped);
+        owed = total > UINT32_MAX ? UINT32_MAX : (uint32_t)total;
+    }
+
+    if (owed > 0)
+        c->frames_short++;
+    c->debt = owed;
+    if (c->debt > AUDIO_CADENCE_MAX_DEBT) {
+        c->packets_missed += c->debt - AUDIO_CADENCE_MAX_DEBT;
+        c->debt = AUDIO_CADENCE_MAX_DEBT;
+    }
+
+    c->frame = frame;
+    c->frame_packets = cadence_next_quota(c);
+    c->released = 0;
+    c->frames++;
+    return owed;
+}
+
+uint32_t audio_cadence_allowance(const audio_cadence_t *c, uint32_t elapsed, uint32_t period)
+{
+    // Debt goes out first, then packet k of this frame at k / frame_packets of the period
+    uint32_t due = c->debt;
+    if (period == 0 || elapsed >= period) {
+        due += c->frame_packets;
+    } else if (c->frame_packets > 0) {
+        uint32_t n = (uint32_t)(((uint64_t)c->frame_packets * elapsed) / period) + 1;
+        due += n < c->frame_packets ? n : c->frame_packets;
+    }
+    return due > c->released ? due - c->released : 0;
+}
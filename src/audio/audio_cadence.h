@@ -0,0 +1,62 @@
+/**
+ * Audio Pipeline - Frame-Locked Packet Cadence
+ *
+ * HDMI audio is clocked from the TMDS clock, so every output video frame
+ * carries a fixed number of samples: sample_rate / frame_rate (800 at
+ * 48 kHz / 60 Hz), with a fractional carry for rates that do not divide.
+ * The cadence turns that into a packet quota per frame and releases the
+ * packets evenly over the frame, so the data island queue stays at a low,
+ * constant level instead of swinging with Core 1 background timing.
+ *
+ * Packets the output could not supply in time are owed into the next frame
+ * (up to AUDIO_CADENCE_MAX_DEBT, the rest is written off and counted).
+ *
+ * SDK-free so it can be driven by a host simulation.
+ */
+
+#ifndef AUDIO_CADENCE_H
+#define AUDIO_CADENCE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define AUDIO_CADENCE_SAMPLES_PER_PACKET 4
+
+// Packets carried into the next frame at most when the output fell behind
+#ifndef AUDIO_CADENCE_MAX_DEBT
+#define AUDIO_CADENCE_MAX_DEBT 8
+#endif
+
+typedef struct {
+    uint32_t sample_rate;    // Audio samples per second
+    uint32_t frame_rate_mhz; // Video frames per 1000 s (60000 = 60 Hz)
+    uint32_t carry;          // Fractional packet remainder, sample_rate * 1000 units
+    uint32_t frame;          // Video frame the quota belongs to
+    uint32_t frame_packets;  // Packets this frame adds to the quota
+    uint32_t debt;           // Packets owed from earlier frames (released first)
+    uint32_t released;       // Released so far this frame
+    bool started;
+
+    // Counters
+    uint32_t frames;
+    uint32_t frames_short;   // Frames that ended with packets still owed
+    uint32_t packets_missed; // Owed packets written off (over the debt limit)
+} audio_cadence_t;
+
+void audio_cadence_init(audio_cadence_t *c, uint32_t sample_rate, uint32_t frame_rate_mhz);
+
+// Move to output frame `frame` (no-op while it is the current one).
+// Returns the packets the previous frame still owed (0 = it was complete).
+uint32_t audio_cadence_frame(audio_cadence_t *c, uint32_t frame);
+
+// Packets that may be released now, at `elapsed` of a `period` long frame
+// (any unit, e.g. cycles since the frame started)
+uint32_t audio_cadence_allowance(const audio_cadence_t *c, uint32_t elapsed, uint32_t period);
+
+// Count one released packet
+static inline void audio_cadence_release(audio_cadence_t *c)
+{
+    c->released++;
+}
+
+#endif // AUDIO_CADENCE_H
@@ -14,10 +14,11 @@
 
 // Sample rate conversion modes
 typedef enum {
-    SRC_MODE_NONE = 0, // Passthrough (no conversion, plays fast)
-    SRC_MODE_DROP,     // Bresenham sample dropping
-    SRC_MODE_LINEAR,   // Linear interpolation
-    SRC_MODE_COUNT     // Number of modes (for cycling)
+    SRC_MODE_NONE = 0,  // Passthrough (no conversion, plays fast)
+    SRC_MODE_DROP,      // Bresenham sample dropping
+    SRC_MODE_LINEAR,    // Linear interpolation
+    SRC_MODE_POLYPHASE, // Polyphase windowed-sinc FIR
+    SRC_MODE_COUNT      // Number of modes (for cycling)
 } src_mode_t;
 
 // Get human-readable name for SRC mode
@@ -30,6 +31,8 @@ static inline const char *src_mode_name(src_mode_t mode)
             return "DROP";
         case SRC_MODE_LINEAR:
             return "LINEAR";
+        case SRC_MODE_POLYPHASE:
+            return "POLYPHASE";
         default:
             return "?";
     }
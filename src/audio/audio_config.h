@@ -19,6 +19,65 @@
 #define AUDIO_INPUT_RATE 55556
 #define AUDIO_OUTPUT_RATE 48000 // HSTX audio output rate
 
+// I2S capture format
+// 1: PIO packs each stereo frame into one word (right << 16 | left, the
+//    audio_sample_t layout) and DMA writes straight into the capture ring
+// 0: PIO pushes two 24-bit words per frame, unpacked by i2s_capture_poll()
+#ifndef I2S_CAPTURE_PACKED
+#define I2S_CAPTURE_PACKED 1
+#endif
+
+// Processing: run DC block + lowpass + SRC as one fused pass when all three
+// are active (LINEAR/POLYPHASE modes); 0 always runs the separate stages
+#ifndef AUDIO_FUSED_KERNEL
+#define AUDIO_FUSED_KERNEL 1
+#endif
+
+// Per-stage arithmetic: 0 = fixed point (Q16 DC blocker, Q4.28 biquads, Q15
+// resampler), 1 = single-precision float on the M33 FPU. Stages still pass
+// 16-bit samples to each other, so any mix works; compare the
+// AUDIO_DSP_BENCH table (cycles and THD+N) between builds to choose
+#ifndef AUDIO_DC_FLOAT
+#define AUDIO_DC_FLOAT 0
+#endif
+#ifndef AUDIO_LOWPASS_FLOAT
+#define AUDIO_LOWPASS_FLOAT 0
+#endif
+#ifndef AUDIO_SRC_FLOAT
+#define AUDIO_SRC_FLOAT 0
+#endif
+
+// Output video frame rate for the audio packet cadence, in mHz.
+// 640x480: 25.2 MHz pixel clock (126 MHz / 5) / (800 x 525) = 60 Hz exactly,
+// i.e. 800 samples (200 packets) per frame
+#ifndef AUDIO_CADENCE_FRAME_RATE_MHZ
+#define AUDIO_CADENCE_FRAME_RATE_MHZ 60000
+#endif
+
+// Print a per-kernel cycle table at init (audio_dsp.h)
+#ifndef AUDIO_DSP_BENCH
+#define AUDIO_DSP_BENCH 0
+#endif
+
+// Core 1 scheduling (core1_sched.h): work per task call and its cycle budget.
+// Budgets are worst cases at 126 MHz; compare with the scheduler's per-task
+// cycles_max / overruns and adjust. One 640x480 line is ~4000 cycles, so a
+// slice has to fit the idle part of a line: DSP that only gets to run in
+// vertical blanking produces a whole frame of output in one burst, more than
+// the collect ring holds with the frame cadence draining it evenly.
+#ifndef AUDIO_DSP_SLICE_SAMPLES
+#define AUDIO_DSP_SLICE_SAMPLES 8
+#endif
+#ifndef AUDIO_DSP_BUDGET_CYCLES
+#define AUDIO_DSP_BUDGET_CYCLES 1200
+#endif
+#ifndef AUDIO_ENCODE_BUDGET_CYCLES
+#define AUDIO_ENCODE_BUDGET_CYCLES 1600
+#endif
+#ifndef AUDIO_CONTROL_BUDGET_CYCLES
+#define AUDIO_CONTROL_BUDGET_CYCLES 400
+#endif
+
 // =============================================================================
 // Pin Configuration (see pins.h for actual GPIO assignments)
 // =============================================================================
@@ -0,0 +1,133 @@
+/**
+ * Audio Pipeline - Packed Stereo DSP Kernels
+ *
+ * An audio_sample_t is a 16-bit L/R pair, so one sample is one 32-bit word
+ * with left in the low half (the layout the packed I2S capture writes). The
+ * helpers below work on that word directly: loads and stores move both
+ * channels at once, and the arithmetic maps to the Armv8-M DSP extension
+ * (SMLAD, SSAT, PKHBT) when AUDIO_DSP_SIMD is set.
+ *
+ * The portable C versions compute exactly what the instructions do, so both
+ * builds produce bit-identical audio.
+ */
+
+#ifndef AUDIO_DSP_H
+#define AUDIO_DSP_H
+
+#include "audio_common.h"
+#include "audio_config.h"
+
+#include <string.h>
+
+// 1: DSP extension intrinsics, 0: portable C. Defaults to the extension when
+// the compiler targets it (RP2350 Arm cores), C otherwise (RISC-V, host)
+#ifndef AUDIO_DSP_SIMD
+#if defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP
+#define AUDIO_DSP_SIMD 1
+#else
+#define AUDIO_DSP_SIMD 0
+#endif
+#endif
+
+#if AUDIO_DSP_SIMD
+#include <arm_acle.h>
+#endif
+
+// Packed stereo sample: left in bits 0-15, right in bits 16-31
+typedef uint32_t dsp_pair_t;
+
+static inline dsp_pair_t dsp_pair_load(const audio_sample_t *s)
+{
+    dsp_pair_t p;
+    memcpy(&p, s, sizeof(p));
+    return p;
+}
+
+static inline void dsp_pair_store(audio_sample_t *s, dsp_pair_t p)
+{
+    memcpy(s, &p, sizeof(p));
+}
+
+// Sign-extended halves (SXTH / ASR)
+static inline int32_t dsp_lo(dsp_pair_t p)
+{
+    return (int16_t)(p & 0xFFFF);
+}
+
+static inline int32_t dsp_hi(dsp_pair_t p)
+{
+    return (int32_t)p >> 16;
+}
+
+// Pack the low 16 bits of two values (PKHBT)
+static inline dsp_pair_t dsp_pack(int32_t lo, int32_t hi)
+{
+    return ((uint32_t)lo & 0xFFFF) | ((uint32_t)hi << 16);
+}
+
+// Saturate to int16 (SSAT #16)
+static inline int32_t dsp_sat16(int32_t v)
+{
+#if AUDIO_DSP_SIMD
+    return __ssat(v, 16);
+#else
+    if (v > 32767)
+        return 32767;
+    if (v < -32768)
+        return -32768;
+    return v;
+#endif
+}
+
+static inline dsp_pair_t dsp_pack_sat(int32_t lo, int32_t hi)
+{
+    return dsp_pack(dsp_sat16(lo), dsp_sat16(hi));
+}
+
+// Float stages (AUDIO_*_FLOAT): round to nearest and saturate to int16.
+// Clamping in float first keeps the conversion a single VCVT
+static inline int32_t dsp_f32_sat16(float v)
+{
+    if (v >= 32767.0f)
+        return 32767;
+    if (v <= -32768.0f)
+        return -32768;
+    return (int32_t)(v + (v >= 0.0f ? 0.5f : -0.5f));
+}
+
+// acc + lo(x) * lo(y) + hi(x) * hi(y), wrapping (SMLAD)
+static inline int32_t dsp_smlad(dsp_pair_t x, dsp_pair_t y, int32_t acc)
+{
+#if AUDIO_DSP_SIMD
+    return (int32_t)__smlad(x, y, (uint32_t)acc);
+#else
+    return (int32_t)((uint32_t)acc + (uint32_t)(dsp_lo(x) * dsp_lo(y)) + (uint32_t)(dsp_hi(x) * dsp_hi(y)));
+#endif
+}
+
+// Q15 dot product of n (even) coefficients with n samples, two taps per
+// SMLAD. Either pointer may be only halfword aligned; the M33 handles the
+// unaligned word loads.
+static inline int32_t dsp_dot_q15(const int16_t *coeffs, const int16_t *x, int n, int32_t acc)
+{
+    for (int k = 0; k < n; k += 2) {
+        dsp_pair_t c, v;
+        memcpy(&c, &coeffs[k], sizeof(c));
+        memcpy(&v, &x[k], sizeof(v));
+        acc = dsp_smlad(c, v, acc);
+    }
+    return acc;
+}
+
+// Time each stage kernel (DC, lowpass, LINEAR/POLYPHASE SRC, fused) over a
+// synthetic block with the DWT counter on the calling core and print a
+// cycles-per-input-sample table for this build's path and stage arithmetic,
+// plus THD+N of the full chain (AUDIO_DSP_BENCH=1 runs it from
+// audio_pipeline_init())
+void audio_dsp_bench_print(void);
+
+// THD+N of a 1 kHz -6 dBFS tone through the staged DC + lowpass + SRC chain in
+// the given SRC mode (left channel), in 0.1 dB
+int32_t audio_dsp_bench_thdn(src_mode_t mode);
+
+#endif // AUDIO_DSP_H
@@ -16,13 +16,20 @@
 #include <string.h>
 
 #include "audio_common.h"
+#include "audio_config.h"
+#include "audio_dsp.h"
+#include "cycle_count.h"
+#include "memory_layout.h"
 
 // Processing buffer size (intermediate between stages)
 #define PROCESS_BUFFER_SIZE 64
 
-// Static buffers for processing
-static audio_sample_t process_in[PROCESS_BUFFER_SIZE];
-static audio_sample_t process_out[PROCESS_BUFFER_SIZE];
+// Capture ring storage, aligned so the I2S DMA can write into it directly
+static audio_sample_t capture_ring_storage[AP_RING_SIZE] __attribute__((aligned(AP_RING_BYTES)));
+
+// SRC output buffer (filters run in place on the capture ring)
+// Placement is a build-time choice, see memory_layout.h
+static audio_sample_t MEM_PLACE(MEM_LAYOUT_AUDIO_PROCESS, audio_process_out) process_out[PROCESS_BUFFER_SIZE];
 
 bool audio_pipeline_init(audio_pipeline_t *p, const audio_pipeline_config_t *config)
 {
@@ -30,7 +37,9 @@ bool audio_pipeline_init(audio_pipeline_t *p, const audio_pipeline_config_t *con
     p->config = *config;
 
     // Initialize ring buffer
-    ap_ring_init(&p->capture_ring);
+    ap_ring_init(&p->capture_ring, capture_ring_storage);
+    memory_layout_note("audio_ring", capture_ring_storage, sizeof(capture_ring_storage));
+    memory_layout_note("audio_process", process_out, sizeof(process_out));
 
     // Initialize capture
     i2s_capture_config_t cap_config = {.pin_bck = config->pin_bck,
@@ -47,8 +56,8 @@ bool audio_pipeline_init(audio_pipeline_t *p, const audio_pipeline_config_t *con
     dc_filter_init(&p->dc_filter);
     p->dc_filter.enabled = true;
 
-    // Initialize lowpass filter (enabled to reduce noise)
-    lowpass_init(&p->lowpass);
+    // Initialize lowpass filter (anti-aliasing, designed for the MVS input rate)
+    lowpass_init(&p->lowpass, SRC_INPUT_RATE_DEFAULT, LOWPASS_CUTOFF_HZ);
     p->lowpass.enabled = true;
 
     // Initialize SRC (DROP mode by default - proper decimation)
@@ -73,6 +82,10 @@ bool audio_pipeline_init(audio_pipeline_t *p, const audio_pipeline_config_t *con
     p->btn1_last_press = 0;
     p->btn2_last_press = 0;
 
+#if AUDIO_DSP_BENCH
+    audio_dsp_bench_print();
+#endif
+
     p->initialized = true;
     return true;
 }
@@ -94,44 +107,136 @@ void audio_pipeline_stop(audio_pipeline_t *p)
     i2s_capture_stop(&p->capture);
 }
 
-void audio_pipeline_process(audio_pipeline_t *p, audio_output_fn output_fn, void *ctx)
+// Latency probe states
+enum { PROBE_IDLE = 0, PROBE_CAPTURED, PROBE_PROCESSED };
+
+// Probes that never complete (capture restart reset the ring indices) are dropped
+#define PROBE_TIMEOUT_US 1000000
+
+static void record_latency(audio_pipeline_t *p, uint32_t us)
+{
+    p->latency_us_last = us;
+    if (p->latency_samples == 0 || us < p->latency_us_min)
+        p->latency_us_min = us;
+    if (us > p->latency_us_max)
+        p->latency_us_max = us;
+    uint32_t bucket = us / AUDIO_LATENCY_BUCKET_US;
+    if (bucket >= AUDIO_LATENCY_BUCKETS)
+        bucket = AUDIO_LATENCY_BUCKETS - 1;
+    p->latency_hist[bucket]++;
+    p->latency_samples++;
+}
+
+void audio_pipeline_note_output(audio_pipeline_t *p, uint32_t retired, uint32_t collect_level, uint32_t queue_level,
+                                bool underrun)
+{
+    if (collect_level > p->collect_max)
+        p->collect_max = collect_level;
+    if (queue_level > p->queue_max)
+        p->queue_max = queue_level;
+    if (underrun)
+        p->output_underruns++;
+
+    if (p->probe_state == PROBE_PROCESSED && (int32_t)(retired - p->probe_out_idx) >= 0) {
+        record_latency(p, time_us_32() - p->probe_time_us);
+        p->probe_state = PROBE_IDLE;
+    }
+}
+
+uint32_t audio_pipeline_process_slice(audio_pipeline_t *p, uint32_t max_samples, audio_output_fn output_fn,
+                                      void *ctx)
 {
     if (!p->initialized || !output_fn)
-        return;
+        return 0;
 
     // Poll for new samples from PIO
-    i2s_capture_poll(&p->capture);
-
-    // Read available samples from capture ring
-    uint32_t available = ap_ring_available(&p->capture_ring);
-    if (available == 0)
-        return;
+    uint32_t captured = i2s_capture_poll(&p->capture);
 
-    // Limit to buffer size
-    if (available > PROCESS_BUFFER_SIZE) {
-        available = PROCESS_BUFFER_SIZE;
+    uint32_t now = time_us_32();
+    if (p->probe_state != PROBE_IDLE && now - p->probe_time_us > PROBE_TIMEOUT_US) {
+        p->probe_state = PROBE_IDLE;
     }
-
-    // Read samples into processing buffer
-    for (uint32_t i = 0; i < available; i++) {
-        process_in[i] = ap_ring_read(&p->capture_ring);
+    if (captured > 0 && p->probe_state == PROBE_IDLE) {
+        // Tag the newest captured sample
+        p->probe_in_idx = p->capture_ring.write_idx - 1;
+        p->probe_time_us = now;
+        p->probe_state = PROBE_CAPTURED;
     }
 
-    // Apply DC filter (in-place)
-    dc_filter_process_buffer(&p->dc_filter, process_in, available);
+    // Process the capture ring in place: the stages read ring storage directly
+    // (staged filters modify it in place), only SRC output is written out
+    ap_span_t spans[2];
+    uint32_t pending = ap_ring_read_spans(&p->capture_ring, spans);
+    if (pending > p->capture_ring_max)
+        p->capture_ring_max = pending;
+    if (pending == 0)
+        return 0;
+
+    if (!p->cycle_count_ready) {
+        cycle_count_init();
+        p->cycle_count_ready = true;
+    }
 
-    // Apply lowpass filter (anti-aliasing before SRC)
-    lowpass_process_buffer(&p->lowpass, process_in, available);
+    uint32_t budget = pending < max_samples ? pending : max_samples;
+    for (int s = 0; s < 2 && spans[s].count > 0 && budget > 0; s++) {
+        audio_sample_t *in = spans[s].data;
+        uint32_t remaining = spans[s].count < budget ? spans[s].count : budget;
+        budget -= remaining;
+
+        while (remaining > 0) {
+            // Output capacity equals the block size and SRC never upsamples,
+            // so every block is consumed in full
+            uint32_t block = remaining < PROCESS_BUFFER_SIZE ? remaining : PROCESS_BUFFER_SIZE;
+            uint32_t t0 = cycle_count_now();
+
+            uint32_t in_consumed = 0;
+            uint32_t out_count;
+            if (AUDIO_FUSED_KERNEL && src_fused_supported(&p->src, &p->dc_filter, &p->lowpass)) {
+                // Single pass: DC block + lowpass + SRC, ring storage only read
+                out_count = src_process_fused(&p->src, &p->dc_filter, &p->lowpass, in, block, process_out,
+                                              PROCESS_BUFFER_SIZE, &in_consumed);
+            } else {
+                // Apply DC filter (in-place)
+                dc_filter_process_buffer(&p->dc_filter, in, block);
+
+                // Apply lowpass filter (anti-aliasing before SRC)
+                lowpass_process_buffer(&p->lowpass, in, block);
+
+                // Apply sample rate conversion
+                out_count = src_process(&p->src, in, block, process_out, PROCESS_BUFFER_SIZE, &in_consumed);
+            }
+
+            p->process_cycles += cycle_count_now() - t0;
+            p->process_samples += block;
+
+            ap_ring_read_advance(&p->capture_ring, block);
+            in += block;
+            remaining -= block;
+
+            if (out_count > p->process_out_max)
+                p->process_out_max = out_count;
+
+            // Tagged sample consumed: follow the last output of this block
+            if (p->probe_state == PROBE_CAPTURED &&
+                (int32_t)(p->capture_ring.read_idx - 1 - p->probe_in_idx) >= 0) {
+                p->probe_out_idx = p->samples_output + out_count;
+                p->probe_state = PROBE_PROCESSED;
+            }
+
+            // Output processed samples
+            if (out_count > 0) {
+                output_fn(process_out, out_count, ctx);
+                p->samples_output += out_count;
+            }
+        }
+    }
 
-    // Apply sample rate conversion
-    uint32_t in_consumed = 0;
-    uint32_t out_count = src_process(&p->src, process_in, available, process_out, PROCESS_BUFFER_SIZE, &in_consumed);
+    return ap_ring_available(&p->capture_ring);
+}
 
-    // Output processed samples
-    if (out_count > 0) {
-        output_fn(process_out, out_count, ctx);
-        p->samples_output += out_count;
-    }
+void audio_pipeline_process(audio_pipeline_t *p, audio_output_fn output_fn, void *ctx)
+{
+    audio_pipeline_process_slice(p, UINT32_MAX, output_fn, ctx);
 }
 
 void audio_pipeline_poll_buttons(audio_pipeline_t *p)
@@ -182,6 +287,22 @@ void audio_pipeline_get_status(audio_pipeline_t *p, audio_pipeline_status_t *sta
     status->output_sample_rate = p->src.output_rate;
     status->samples_output = p->samples_output;
     status->output_underruns = p->output_underruns;
+
+    // Cycles per input sample x16 over the whole run (samples/us = clk_MHz * 16 / value)
+    status->process_cycles_per_sample_x16 =
+        p->process_samples ? (uint32_t)((p->process_cycles * 16) / p->process_samples) : 0;
+
+    status->dma_backlog_max = p->capture.dma_backlog_max;
+    status->capture_ring_max = p->capture_ring_max;
+    status->process_out_max = p->process_out_max;
+    status->collect_max = p->collect_max;
+    status->queue_max = p->queue_max;
+
+    status->latency_us_last = p->latency_us_last;
+    status->latency_us_min = p->latency_us_min;
+    status->latency_us_max = p->latency_us_max;
+    status->latency_samples = p->latency_samples;
+    memcpy(status->latency_hist, p->latency_hist, sizeof(status->latency_hist));
 }
 
 void audio_pipeline_set_dc_filter(audio_pipeline_t *p, bool enabled)
@@ -24,6 +24,11 @@
 // Debounce time in milliseconds
 #define BUTTON_DEBOUNCE_MS 50
 
+// Capture -> HDMI queue latency histogram: AUDIO_LATENCY_BUCKETS buckets of
+// AUDIO_LATENCY_BUCKET_US, the last one open-ended
+#define AUDIO_LATENCY_BUCKETS 16
+#define AUDIO_LATENCY_BUCKET_US 1000
+
 // Pipeline status (for display)
 typedef struct {
     // Capture stats
@@ -40,6 +45,23 @@ typedef struct {
     uint32_t output_sample_rate;
     uint32_t samples_output;
     uint32_t output_underruns;
+
+    // Processing cost (DC + lowpass + SRC) per input sample, in 1/16 cycles
+    uint32_t process_cycles_per_sample_x16;
+
+    // Occupancy high-water marks per stage (samples; islands for the queue)
+    uint32_t dma_backlog_max;   // I2S DMA ring, unread at poll time
+    uint32_t capture_ring_max;  // Capture ring, waiting for processing
+    uint32_t process_out_max;   // SRC output per block
+    uint32_t collect_max;       // Encoder collect ring
+    uint32_t queue_max;         // HSTX data island queue
+
+    // Latency from capture (DMA data seen by the poll) to data island push
+    uint32_t latency_us_last;
+    uint32_t latency_us_min;
+    uint32_t latency_us_max;
+    uint32_t latency_samples; // Probes completed
+    uint32_t latency_hist[AUDIO_LATENCY_BUCKETS];
 } audio_pipeline_status_t;
 
 // Pipeline configuration
@@ -79,6 +101,29 @@ typedef struct {
     uint32_t samples_output;
     uint32_t output_underruns;
 
+    // Occupancy high-water marks
+    uint32_t capture_ring_max;
+    uint32_t process_out_max;
+    uint32_t collect_max;
+    uint32_t queue_max;
+
+    // Latency probe: one captured sample is tagged at a time and followed
+    // through processing (input index -> output index) to its island push
+    uint8_t probe_state;
+    uint32_t probe_in_idx;
+    uint32_t probe_out_idx;
+    uint32_t probe_time_us;
+    uint32_t latency_us_last;
+    uint32_t latency_us_min;
+    uint32_t latency_us_max;
+    uint32_t latency_samples;
+    uint32_t latency_hist[AUDIO_LATENCY_BUCKETS];
+
+    // Processing cost counters (DWT cycles on the processing core)
+    uint64_t process_cycles;
+    uint64_t process_samples;
+    bool cycle_count_ready;
+
     bool initialized;
 } audio_pipeline_t;
 
@@ -92,11 +137,24 @@ void audio_pipeline_start(audio_pipeline_t *p);
 void audio_pipeline_stop(audio_pipeline_t *p);
 
 // Process audio: call this regularly from main loop
-// Reads from capture buffer, processes through stages, writes to output
+// Stages read the capture ring spans directly (fused in one pass when all are
+// active); only SRC output is copied
 // output_fn: callback to write samples to HSTX audio ring
 typedef void (*audio_output_fn)(const audio_sample_t *samples, uint32_t count, void *ctx);
 void audio_pipeline_process(audio_pipeline_t *p, audio_output_fn output_fn, void *ctx);
 
+// Same, but process at most max_samples input samples (for callers with a
+// cycle budget). Returns the input samples still waiting in the capture ring
+uint32_t audio_pipeline_process_slice(audio_pipeline_t *p, uint32_t max_samples, audio_output_fn output_fn,
+                                      void *ctx);
+
+// Report the output side after data island pushes (call from the output stage):
+// retired = output samples that have left the pipeline (pushed or dropped, same
+// count as samples handed to output_fn), collect_level / queue_level = current
+// occupancy, underrun = the queue was found empty while streaming
+void audio_pipeline_note_output(audio_pipeline_t *p, uint32_t retired, uint32_t collect_level, uint32_t queue_level,
+                                bool underrun);
+
 // Poll buttons and handle toggles (call from main loop)
 void audio_pipeline_poll_buttons(audio_pipeline_t *p);
 
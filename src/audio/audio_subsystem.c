@@ -2,23 +2,51 @@
 
 #include "pico_hdmi/hstx_data_island_queue.h"
 #include "pico_hdmi/hstx_packet.h"
-#include "pico_hdmi/video_output.h"
 
 #include "hardware/pio.h"
 
 #include <stdio.h>
 
+#include "audio_cadence.h"
+#include "audio_config.h"
 #include "audio_pipeline.h"
+#include "core1_sched.h"
+#include "cycle_count.h"
+#include "memory_layout.h"
 #include "mvs_pins.h"
+#include "rate_ctrl.h"
+#include "video_pipeline.h"
 
 // Audio pipeline instance
 static audio_pipeline_t audio_pipeline;
 
 // Audio state for HSTX encoding
 static int audio_frame_counter = 0;
-#define AUDIO_COLLECT_SIZE 128
-static audio_sample_t audio_collect_buffer[AUDIO_COLLECT_SIZE];
-static uint32_t audio_collect_count = 0;
+
+// Collect ring between SRC output and the packet encoder. Free-running indices;
+// the tail only moves in whole packets, so each packet's samples are contiguous.
+// Sized for the rate controller's backlog target plus Core 1 scheduling jitter.
+#define AUDIO_COLLECT_SIZE 256
+#define AUDIO_COLLECT_MASK (AUDIO_COLLECT_SIZE - 1)
+#define AUDIO_SAMPLES_PER_PACKET AUDIO_CADENCE_SAMPLES_PER_PACKET
+static audio_sample_t MEM_PLACE(MEM_LAYOUT_AUDIO_COLLECT, audio_collect) audio_collect_buffer[AUDIO_COLLECT_SIZE];
+static uint32_t audio_collect_head = 0;
+static uint32_t audio_collect_tail = 0;
+
+// Island that was encoded but not pushed yet (waiting for its cadence slot or
+// refused by a full queue), pushed before encoding more
+static hstx_data_island_t audio_pending_island;
+static bool audio_pending = false;
+
+// Frame-locked release of the islands (see audio_cadence.h)
+static audio_cadence_t audio_cadence;
+
+// Output samples that have left the pipeline (pushed in an island or dropped),
+// counted in the same units as the pipeline's samples_output for the latency probe
+static uint32_t audio_samples_retired = 0;
+
+static audio_encoder_stats_t encoder_stats;
+static bool encoder_cycle_count_ready = false;
 
 // When true, push silence to HDMI instead of captured samples (CPS2_DIGAV-style: no garbage on power-on/timeout)
 static volatile bool audio_output_muted = true;
@@ -30,84 +58,168 @@ void audio_subsystem_set_muted(bool muted)
     audio_output_muted = muted;
 }
 
+bool audio_subsystem_running(void)
+{
+    return audio_pipeline.capture.running;
+}
+
+uint32_t audio_subsystem_input_samples(void)
+{
+    return audio_pipeline.capture.samples_captured;
+}
+
+void audio_subsystem_resync_input(void)
+{
+    i2s_capture_resync(&audio_pipeline.capture);
+}
+
+void audio_subsystem_get_encoder_stats(audio_encoder_stats_t *stats)
+{
+    *stats = encoder_stats;
+}
+
+// Push the pending island, returns false while the queue is still full.
+// paced: released on the frame cadence, where an empty queue is the normal
+// state (a short frame shows up in cadence_short / cadence_missed instead)
+static bool audio_flush_pending(bool paced)
+{
+    if (!audio_pending)
+        return true;
+
+    // An empty queue once streaming means HDMI already ran out of audio
+    bool underrun = !paced && encoder_stats.islands_pushed > 0 && hstx_di_queue_get_level() == 0;
+    if (!hstx_di_queue_push(&audio_pending_island)) {
+        encoder_stats.queue_full++;
+        return false;
+    }
+    audio_pending = false;
+    if (paced)
+        audio_cadence_release(&audio_cadence);
+    encoder_stats.islands_pushed++;
+    audio_samples_retired += AUDIO_SAMPLES_PER_PACKET;
+    audio_pipeline_note_output(&audio_pipeline, audio_samples_retired, audio_collect_head - audio_collect_tail,
+                               hstx_di_queue_get_level(), underrun);
+    return true;
+}
+
+// Encode one packet from the collect ring (core 1 task). Once the output
+// frame timing is known, islands are pushed only as the cadence allows;
+// before that (and at queue backpressure) samples wait in the ring. Returns
+// true while another packet is ready to go.
+static bool audio_encode_task(void)
+{
+    if (!encoder_cycle_count_ready) {
+        cycle_count_init();
+        encoder_cycle_count_ready = true;
+    }
+
+    uint32_t frame, elapsed, period;
+    bool paced = video_pipeline_frame_position(&frame, &elapsed, &period);
+    if (paced) {
+        // A frame ending with islands still owed is counted by the cadence
+        // (cadence_short / cadence_missed), not as an output underrun
+        audio_cadence_frame(&audio_cadence, frame);
+        encoder_stats.cadence_frames = audio_cadence.frames;
+        encoder_stats.cadence_short = audio_cadence.frames_short;
+        encoder_stats.cadence_missed = audio_cadence.packets_missed;
+        if (audio_pending && audio_cadence_allowance(&audio_cadence, elapsed, period) == 0)
+            return false;
+    }
+
+    if (!audio_flush_pending(paced))
+        return false;
+    if (audio_collect_head - audio_collect_tail < AUDIO_SAMPLES_PER_PACKET)
+        return false;
+
+    uint32_t t0 = cycle_count_now();
+    const audio_sample_t *src =
+        audio_output_muted ? audio_silence : &audio_collect_buffer[audio_collect_tail & AUDIO_COLLECT_MASK];
+    hstx_packet_t packet;
+    audio_frame_counter = hstx_packet_set_audio_samples(&packet, src, AUDIO_SAMPLES_PER_PACKET, audio_frame_counter);
+    hstx_encode_data_island(&audio_pending_island, &packet, false, true);
+    audio_pending = true;
+    audio_collect_tail += AUDIO_SAMPLES_PER_PACKET;
+
+    uint32_t cycles = cycle_count_now() - t0;
+    encoder_stats.packets_encoded++;
+    encoder_stats.encode_cycles_total += cycles;
+    if (cycles > encoder_stats.encode_cycles_max)
+        encoder_stats.encode_cycles_max = cycles;
+
+    // The island just built still has to be pushed
+    return true;
+}
+
 static void audio_output_callback(const audio_sample_t *samples, uint32_t count, void *ctx)
 {
     (void)ctx;
 
-    for (uint32_t i = 0; i < count; i++) {
-        if (audio_collect_count < AUDIO_COLLECT_SIZE) {
-            audio_collect_buffer[audio_collect_count++] = samples[i];
-        }
-
-        if (audio_collect_count >= 4) {
-            hstx_packet_t packet;
-            const audio_sample_t *src = audio_output_muted ? audio_silence : audio_collect_buffer;
-            int new_frame_counter = hstx_packet_set_audio_samples(&packet, src, 4, audio_frame_counter);
-
-            hstx_data_island_t island;
-            hstx_encode_data_island(&island, &packet, false, true);
-
-            if (hstx_di_queue_push(&island)) {
-                audio_frame_counter = new_frame_counter;
-                audio_collect_count -= 4;
-                for (uint32_t j = 0; j < audio_collect_count; j++) {
-                    audio_collect_buffer[j] = audio_collect_buffer[j + 4];
-                }
-            } else {
-                break;
-            }
-        }
+    // Append to the collect ring; what does not fit is dropped and counted
+    uint32_t space = AUDIO_COLLECT_SIZE - (audio_collect_head - audio_collect_tail);
+    uint32_t n = count < space ? count : space;
+    for (uint32_t i = 0; i < n; i++) {
+        audio_collect_buffer[(audio_collect_head + i) & AUDIO_COLLECT_MASK] = samples[i];
     }
+    audio_collect_head += n;
+    encoder_stats.samples_dropped += count - n;
+    audio_samples_retired += count - n;
+    audio_pipeline_note_output(&audio_pipeline, audio_samples_retired, audio_collect_head - audio_collect_tail,
+                               hstx_di_queue_get_level(), false);
+}
+
+// Output backlog in packets: SRC output not yet released plus islands queued
+// for HSTX. With the frame cadence draining it at exactly the HDMI rate, this
+// is what the rate controller holds
+static uint32_t audio_output_backlog(void)
+{
+    return (audio_collect_head - audio_collect_tail) / AUDIO_SAMPLES_PER_PACKET + (audio_pending ? 1 : 0) +
+           hstx_di_queue_get_level();
 }
 
 // Global frame count from video_output.c
 extern volatile uint32_t video_frame_count;
 static uint32_t last_rate_update_frame = 0;
+static uint32_t last_measure_frame = 0;
+static uint32_t last_control_samples = 0;
 
-static void audio_background_task_control(void)
+// SRC ratio recovery (see rate_ctrl.h)
+static rate_ctrl_t rate_ctrl;
+
+// Rate control (core 1 task): one step per video frame
+static bool audio_control_task(void)
 {
-    if (video_frame_count - last_rate_update_frame >= 30) { // Every ~0.5s (at 60fps)
-        last_rate_update_frame = video_frame_count;
-
-        uint32_t level = hstx_di_queue_get_level();
-        uint32_t current_rate = audio_pipeline.src.input_rate;
-        uint32_t new_rate = current_rate;
-
-        // Target: 128 (half of 256)
-        // Deadband: +/- 32 (96 to 160)
-        if (level > 160) {
-            // Buffer filling up -> Produce LESS output relative to input
-            // SRC Drop Mode: out_count = (in_count * output_rate) / input_rate
-            // To reduce out_count, we need to INCREASE input_rate (denominator).
-            new_rate += 10;
-        } else if (level < 96) {
-            // Buffer emptying -> Produce MORE output relative to input
-            // To increase out_count, we need to DECREASE input_rate (denominator).
-            new_rate -= 10;
-        }
-
-        // Clamp to sane MVS limits (55.5kHz +/- 5%)
-        if (new_rate < 53000)
-            new_rate = 53000;
-        if (new_rate > 58000)
-            new_rate = 58000;
-
-        if (new_rate != current_rate) {
-            // We modify the rate "live".
-            // Accessing internal struct directly is atomic enough for uint32_t on ARM.
-            audio_pipeline.src.input_rate = new_rate;
-        }
+    uint32_t frame = video_frame_count;
+    if (frame == last_rate_update_frame)
+        return false;
+    last_rate_update_frame = frame;
+
+    // No I2S input this frame: the backlog only drains, and steering on it would
+    // wind the ratio to its limit. Hold the loop so it resumes from its lock.
+    uint32_t samples = audio_pipeline.capture.samples_captured;
+    if (samples == last_control_samples)
+        return false;
+    last_control_samples = samples;
+
+    // Feed-forward from the measured I2S rate (refreshed by the capture every 0.5 s)
+    if (frame - last_measure_frame >= 30) {
+        last_measure_frame = frame;
+        rate_ctrl_set_input_rate(&rate_ctrl, i2s_capture_get_sample_rate(&audio_pipeline.capture));
+    }
+
+    // One PI step per video frame on the output backlog
+    uint32_t step = rate_ctrl_update(&rate_ctrl, audio_output_backlog());
+    if (step != audio_pipeline.src.step) {
+        // Picked up by the next src_process() call (same core)
+        src_set_step(&audio_pipeline.src, step);
     }
+    return false;
 }
 
-static void audio_background_task(void)
+// DSP (core 1 task): one slice of the capture ring, SRC output goes to the
+// collect ring for the encode task
+static bool audio_dsp_task(void)
 {
-    audio_background_task_control();
-
-    audio_pipeline_process(&audio_pipeline, audio_output_callback, NULL);
-    while (ap_ring_available(&audio_pipeline.capture_ring) > 0) {
-        audio_pipeline_process(&audio_pipeline, audio_output_callback, NULL);
-    }
+    return audio_pipeline_process_slice(&audio_pipeline, AUDIO_DSP_SLICE_SAMPLES, audio_output_callback, NULL) > 0;
 }
 
 void audio_subsystem_init(void)
@@ -125,9 +237,14 @@ void audio_subsystem_init(void)
                                             .sm = 0};
 
     audio_pipeline_init(&audio_pipeline, &audio_config);
+    rate_ctrl_init(&rate_ctrl, SRC_INPUT_RATE_DEFAULT, SRC_OUTPUT_RATE_DEFAULT);
+    audio_cadence_init(&audio_cadence, SRC_OUTPUT_RATE_DEFAULT, AUDIO_CADENCE_FRAME_RATE_MHZ);
+    memory_layout_note("audio_collect", audio_collect_buffer, sizeof(audio_collect_buffer));
 
-    // Register with video output Core 1 loop
-    video_output_set_background_task(audio_background_task);
+    // Register with the Core 1 background scheduler
+    core1_sched_add("audio_ctl", audio_control_task, AUDIO_CONTROL_BUDGET_CYCLES);
+    core1_sched_add("audio_dsp", audio_dsp_task, AUDIO_DSP_BUDGET_CYCLES);
+    core1_sched_add("audio_enc", audio_encode_task, AUDIO_ENCODE_BUDGET_CYCLES);
 }
 
 void audio_subsystem_start(void)
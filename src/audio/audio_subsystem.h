@@ -4,6 +4,22 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+/**
+ * HDMI audio packet encoder counters (core 1 writes, readers may see a torn
+ * snapshot across fields).
+ */
+typedef struct {
+    uint32_t packets_encoded;     // Audio sample packets built (4 samples each)
+    uint32_t islands_pushed;      // Data islands accepted by the HSTX queue
+    uint32_t queue_full;          // Push attempts refused (island kept and retried)
+    uint32_t samples_dropped;     // SRC output lost because the collect ring was full
+    uint64_t encode_cycles_total; // Packet build + island encode, DWT cycles
+    uint32_t encode_cycles_max;   // Worst single packet
+    uint32_t cadence_frames;      // Output frames paced by the frame cadence
+    uint32_t cadence_short;       // Frames that ended with islands still owed
+    uint32_t cadence_missed;      // Owed islands written off (never sent)
+} audio_encoder_stats_t;
+
 /**
  * Initialize the audio subsystem (pipeline, buffers, etc.)
  */
@@ -21,8 +37,31 @@ void audio_subsystem_stop(void);
 
 /**
  * Mute/unmute HDMI audio output (push silence when muted).
- * Core 0 sets muted on timeout, unmuted when video is locked (CPS2_DIGAV-style).
+ * Driven by the signal lock manager (signal_lock.h): muted while video is
+ * not locked or I2S is silent, unmuted once both have settled
+ * (CPS2_DIGAV-style). Starts muted.
  */
 void audio_subsystem_set_muted(bool muted);
 
+/**
+ * True between audio_subsystem_start() and audio_subsystem_stop().
+ */
+bool audio_subsystem_running(void);
+
+/**
+ * I2S frames captured so far (free-running, for activity detection).
+ */
+uint32_t audio_subsystem_input_samples(void);
+
+/**
+ * Realign the I2S capture after the source went silent (Core 1, see
+ * i2s_capture_resync()).
+ */
+void audio_subsystem_resync_input(void);
+
+/**
+ * Get packet encoder counters.
+ */
+void audio_subsystem_get_encoder_stats(audio_encoder_stats_t *stats);
+
 #endif // AUDIO_SUBSYSTEM_H
@@ -11,20 +11,71 @@
 #define DC_FILTER_H
 
 #include "audio_common.h"
+#include "audio_dsp.h"
 
-// DC filter state (per channel)
+#if AUDIO_DC_FLOAT
+// DC filter state (float path), index 0 = left, 1 = right. The output is kept
+// unrounded for the feedback term
 typedef struct {
-    int32_t prev_in;
-    int32_t prev_out;
-} dc_filter_channel_t;
+    float prev_in[2];
+    float prev_out[2];
+} dc_filter_state_t;
+#else
+// DC filter state, samples packed (see audio_dsp.h)
+typedef struct {
+    dsp_pair_t prev_in;
+    dsp_pair_t prev_out; // Saturated to 16 bits, so it packs losslessly
+    int32_t frac[2];     // Q16 remainder of alpha * y carried to the next sample
+} dc_filter_state_t;
+#endif
 
 // DC filter instance (stereo)
 typedef struct {
-    dc_filter_channel_t left;
-    dc_filter_channel_t right;
+    dc_filter_state_t state;
     bool enabled;
 } dc_filter_t;
 
+// Alpha coefficient in fixed-point (Q16)
+// alpha = 0.9995 gives ~10Hz cutoff at 55kHz
+// 0.9995 * 65536 = 65503
+#define DC_ALPHA 65503
+
+// Process one stereo sample (shared by the buffer path and the fused SRC kernel)
+static inline dsp_pair_t dc_filter_step(dc_filter_state_t *st, dsp_pair_t in)
+{
+#if AUDIO_DC_FLOAT
+    // y[n] = x[n] - x[n-1] + alpha * y[n-1], same alpha as the fixed path
+    const float alpha = (float)DC_ALPHA / 65536.0f;
+    float x[2] = {(float)dsp_lo(in), (float)dsp_hi(in)};
+    for (int ch = 0; ch < 2; ch++) {
+        float y = x[ch] - st->prev_in[ch] + alpha * st->prev_out[ch];
+        st->prev_in[ch] = x[ch];
+        st->prev_out[ch] = y;
+    }
+    return dsp_pack(dsp_f32_sat16(st->prev_out[0]), dsp_f32_sat16(st->prev_out[1]));
+#else
+    // y[n] = x[n] - x[n-1] + alpha * y[n-1], alpha in Q16, written as
+    // y + (y * (alpha - 65536)) >> 16. The truncated fraction is fed back
+    // into the next product (error feedback): plain truncation biases every
+    // step by -0.5 LSB, which the 1 / (1 - alpha) loop gain turns into a
+    // ~-1000 LSB DC offset at the output
+    const int32_t k = DC_ALPHA - 65536;
+    int32_t acc_l = k * dsp_lo(st->prev_out) + st->frac[0];
+    int32_t acc_r = k * dsp_hi(st->prev_out) + st->frac[1];
+    st->frac[0] = acc_l & 0xFFFF;
+    st->frac[1] = acc_r & 0xFFFF;
+    int32_t l = dsp_lo(in) - dsp_lo(st->prev_in) + dsp_lo(st->prev_out) + (acc_l >> 16);
+    int32_t r = dsp_hi(in) - dsp_hi(st->prev_in) + dsp_hi(st->prev_out) + (acc_r >> 16);
+
+    // Clamp both channels to int16 range
+    dsp_pair_t out = dsp_pack_sat(l, r);
+
+    st->prev_in = in;
+    st->prev_out = out;
+    return out;
+#endif
+}
+
 // Initialize DC filter
 void dc_filter_init(dc_filter_t *f);
 
@@ -12,20 +12,51 @@
 #include "hardware/dma.h"
 #include "hardware/gpio.h"
 
+#include <assert.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "audio_config.h"
 #include "i2s_capture.pio.h"
-
+#include "memory_layout.h"
+
+#if I2S_CAPTURE_PACKED
+// One word per stereo frame, written by DMA straight into the capture ring
+// (2048 words = 8192 bytes, ring storage is aligned to its size)
+#define I2S_DMA_BUFFER_SIZE AP_RING_SIZE
+#define I2S_DMA_RING_BITS 13
+
+// PIO word is (right << 16) | left; audio_sample_t must match it on this little-endian core
+static_assert(sizeof(audio_sample_t) == sizeof(uint32_t), "audio_sample_t must be one word");
+static_assert(offsetof(audio_sample_t, left) == 0, "left must be bits 15:0 of the packed word");
+static_assert(offsetof(audio_sample_t, right) == 2, "right must be bits 31:16 of the packed word");
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "packed I2S layout assumes little-endian");
+#else
 // DMA buffer must be large enough to hold samples between polls
 // At 55.5 kHz and 60 fps: ~1850 words/frame. Use 4096 for ~2 frames of
 // headroom.
 #define I2S_DMA_BUFFER_SIZE 4096
-#define I2S_DMA_BUFFER_MASK (I2S_DMA_BUFFER_SIZE - 1)
+#define I2S_DMA_RING_BITS 14
 
 // Aligned buffer for DMA ring wrapping (4096 words = 16384 bytes)
 static uint32_t g_dma_buffer[I2S_DMA_BUFFER_SIZE] __attribute__((aligned(16384)));
+#endif
+#define I2S_DMA_BUFFER_MASK (I2S_DMA_BUFFER_SIZE - 1)
+
+#if I2S_CAPTURE_PACKED
+// The write address only shows the position within the ring, so a poll that
+// comes more than one ring late cannot see the laps from it. The channel
+// re-triggers itself instead of running in endless mode (which does not count
+// down), and the count's drop since the last poll gives the whole laps.
+#define I2S_DMA_TRANS_COUNT_RELOAD DMA_CH0_TRANS_COUNT_COUNT_BITS
+#define I2S_DMA_TRANS_COUNT                                                                                            \
+    ((DMA_CH0_TRANS_COUNT_MODE_VALUE_TRIGGER_SELF << DMA_CH0_TRANS_COUNT_MODE_LSB) | I2S_DMA_TRANS_COUNT_RELOAD)
+#else
+#define I2S_DMA_TRANS_COUNT 0xFFFFFFFF
+#endif
+static_assert((I2S_DMA_BUFFER_SIZE * 4) == (1u << I2S_DMA_RING_BITS), "DMA ring size mismatch");
 
 bool i2s_capture_init(i2s_capture_t *cap, const i2s_capture_config_t *config, ap_ring_t *ring)
 {
@@ -33,14 +64,24 @@ bool i2s_capture_init(i2s_capture_t *cap, const i2s_capture_config_t *config, ap
     cap->ring = ring;
     cap->samples_captured = 0;
     cap->overflows = 0;
+    cap->dma_backlog_max = 0;
+    cap->resyncs = 0;
     cap->running = false;
     cap->last_sample_count = 0;
     cap->last_measure_time = 0;
     cap->measured_rate = 0;
 
     // Initialize DMA state
+#if I2S_CAPTURE_PACKED
+    cap->dma_buffer = (uint32_t *)ring->samples;
+    if ((uintptr_t)cap->dma_buffer & (AP_RING_BYTES - 1))
+        return false;
+#else
     cap->dma_buffer = g_dma_buffer;
+    memory_layout_note("i2s_dma", g_dma_buffer, sizeof(g_dma_buffer));
+#endif
     cap->dma_buffer_idx = 0;
+    cap->dma_count = 0;
     cap->dma_chan = dma_claim_unused_channel(true);
 
     // Initialize GPIO pins as inputs BEFORE PIO takes over
@@ -63,12 +104,15 @@ bool i2s_capture_init(i2s_capture_t *cap, const i2s_capture_config_t *config, ap
     // GP0-2 are in Bank 0, use GPIOBASE=0
     pio_set_gpio_base(config->pio, 0);
 
-    // Add PIO program
+    // Add PIO program and initialize state machine
+#if I2S_CAPTURE_PACKED
+    uint offset = pio_add_program(config->pio, &i2s_capture_packed_program);
+    i2s_capture_packed_program_init(config->pio, config->sm, offset, config->pin_dat, config->pin_ws, config->pin_bck);
+#else
     uint offset = pio_add_program(config->pio, &i2s_capture_program);
-    cap->pio_offset = offset;
-
-    // Initialize PIO state machine
     i2s_capture_program_init(config->pio, config->sm, offset, config->pin_dat, config->pin_ws, config->pin_bck);
+#endif
+    cap->pio_offset = offset;
 
     // Configure DMA
     dma_channel_config c = dma_channel_get_default_config(cap->dma_chan);
@@ -77,14 +121,13 @@ bool i2s_capture_init(i2s_capture_t *cap, const i2s_capture_config_t *config, ap
     channel_config_set_dreq(&c, pio_get_dreq(config->pio, config->sm, false));
     channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
 
-    // Enable ring wrapping for destination (2^14 bytes = 16384 bytes = 4096
-    // words)
-    channel_config_set_ring(&c, true, 14);
+    // Enable ring wrapping for destination over the whole buffer
+    channel_config_set_ring(&c, true, I2S_DMA_RING_BITS);
 
     dma_channel_configure(cap->dma_chan, &c,
                           cap->dma_buffer,               // Destination
                           &config->pio->rxf[config->sm], // Source
-                          0xFFFFFFFF,                    // Count (run "forever")
+                          I2S_DMA_TRANS_COUNT,           // Count (run "forever")
                           false                          // Don't start yet
     );
 
@@ -102,6 +145,7 @@ void i2s_capture_start(i2s_capture_t *cap)
     cap->last_sample_count = 0;
     cap->last_measure_time = time_us_64();
     cap->dma_buffer_idx = 0;
+    cap->dma_count = I2S_DMA_TRANS_COUNT & DMA_CH0_TRANS_COUNT_COUNT_BITS;
 
     // 1. Force SM into a clean state
     pio_sm_set_enabled(cap->config.pio, cap->config.sm, false);
@@ -113,6 +157,11 @@ void i2s_capture_start(i2s_capture_t *cap)
 
     // Clear DMA buffer to be safe
     memset(cap->dma_buffer, 0, I2S_DMA_BUFFER_SIZE * sizeof(uint32_t));
+#if I2S_CAPTURE_PACKED
+    // DMA restarts at the top of the ring storage, so the ring indices do too
+    cap->ring->read_idx = 0;
+    cap->ring->write_idx = 0;
+#endif
 
     // Start DMA
     dma_channel_set_write_addr(cap->dma_chan, cap->dma_buffer, true);
@@ -138,6 +187,29 @@ void i2s_capture_stop(i2s_capture_t *cap)
     cap->running = false;
 }
 
+void i2s_capture_resync(i2s_capture_t *cap)
+{
+    if (!cap->running)
+        return;
+
+    pio_sm_set_enabled(cap->config.pio, cap->config.sm, false);
+    dma_channel_abort(cap->dma_chan);
+
+    // Back to the wait-for-WS instruction with empty FIFOs
+    pio_sm_restart(cap->config.pio, cap->config.sm);
+    pio_sm_clear_fifos(cap->config.pio, cap->config.sm);
+    pio_sm_exec(cap->config.pio, cap->config.sm, pio_encode_jmp(cap->pio_offset));
+
+    // Re-arm the DMA where the consumer is: everything before it was polled, so
+    // the rings and counters stay valid (an unpacked R/L pair restarts on an
+    // even word)
+    dma_channel_set_write_addr(cap->dma_chan, &cap->dma_buffer[cap->dma_buffer_idx], true);
+    cap->dma_count = I2S_DMA_TRANS_COUNT & DMA_CH0_TRANS_COUNT_COUNT_BITS;
+    pio_sm_set_enabled(cap->config.pio, cap->config.sm, true);
+
+    cap->resyncs++;
+}
+
 uint32_t i2s_capture_poll(i2s_capture_t *cap)
 {
     if (!cap->running)
@@ -146,44 +218,79 @@ uint32_t i2s_capture_poll(i2s_capture_t *cap)
     uint32_t count = 0;
     uint64_t now = time_us_64();
 
+#if I2S_CAPTURE_PACKED
+    // Transfers since the last poll (the count reloads when it reaches zero),
+    // read before the write address so it is never ahead of it
+    uint32_t dma_count = dma_hw->ch[cap->dma_chan].transfer_count & DMA_CH0_TRANS_COUNT_COUNT_BITS;
+    uint32_t transfers = cap->dma_count >= dma_count ? cap->dma_count - dma_count
+                                                     : cap->dma_count + I2S_DMA_TRANS_COUNT_RELOAD - dma_count;
+    cap->dma_count = dma_count;
+#endif
+
     // Get current DMA write position from the WRITE_ADDR register
     uint32_t write_ptr = dma_hw->ch[cap->dma_chan].write_addr;
     uint32_t write_idx = (write_ptr - (uint32_t)cap->dma_buffer) / sizeof(uint32_t);
 
-    // Read all samples written by DMA since last poll
-    if (cap->dma_buffer_idx != write_idx) {
+#if I2S_CAPTURE_PACKED
+    // DMA writes finished samples into the ring: publish them by advancing write_idx
+    uint32_t frames = (write_idx - cap->dma_buffer_idx) & I2S_DMA_BUFFER_MASK;
+    // Whole laps since the last poll: the transfers the write address does not
+    // show, rounded to rings (the two registers are read a few transfers apart)
+    if (transfers > frames + I2S_DMA_BUFFER_SIZE / 2)
+        frames += (transfers - frames + I2S_DMA_BUFFER_SIZE / 2) & ~I2S_DMA_BUFFER_MASK;
+    if (frames > cap->dma_backlog_max)
+        cap->dma_backlog_max = frames;
+    if (frames > 0) {
         cap->last_activity_time = now;
 
-        while (cap->dma_buffer_idx != write_idx) {
-            uint32_t next_idx = (cap->dma_buffer_idx + 1) & I2S_DMA_BUFFER_MASK;
-            if (next_idx == write_idx)
-                break;
-
-            uint32_t raw_r = cap->dma_buffer[cap->dma_buffer_idx];
-            uint32_t raw_l = cap->dma_buffer[next_idx];
-            cap->dma_buffer_idx = (next_idx + 1) & I2S_DMA_BUFFER_MASK;
-
-            audio_sample_t sample;
-            sample.left = (int16_t)(raw_l & 0xFFFF);
-            sample.right = (int16_t)(raw_r & 0xFFFF);
-
-            if (ap_ring_free(cap->ring) > 0) {
-                ap_ring_write(cap->ring, sample);
-                cap->samples_captured++;
-                count++;
-            } else {
-                cap->overflows++;
-            }
+        // DMA lapped the consumer: the oldest unread samples were overwritten
+        uint32_t space = ap_ring_free(cap->ring);
+        if (frames > space) {
+            ap_ring_read_advance(cap->ring, frames - space);
+            cap->overflows += frames - space;
         }
-    } else {
-        // No activity: only reset after sustained silence (avoids scratchiness from brief dropouts).
-        // 200 ms = ~11k samples at 55.5 kHz; IRQ-driven video doesn't rely on this for sync.
-        if (now - cap->last_activity_time > 200000) {
-            i2s_capture_stop(cap);
-            i2s_capture_start(cap);
-            cap->last_activity_time = now;
-            return 0;
+        ap_ring_write_advance(cap->ring, frames);
+
+        cap->dma_buffer_idx = write_idx;
+        cap->samples_captured += frames;
+        count = frames;
+#else
+    // Read all complete R/L frames written by DMA since last poll.
+    // Frames are word pairs starting at even indices, so they never straddle the wrap.
+    uint32_t words = (write_idx - cap->dma_buffer_idx) & I2S_DMA_BUFFER_MASK;
+    uint32_t frames = words / 2;
+    if (frames > cap->dma_backlog_max)
+        cap->dma_backlog_max = frames;
+    if (frames > 0) {
+        cap->last_activity_time = now;
+
+        ap_span_t spans[2];
+        uint32_t space = ap_ring_write_spans(cap->ring, spans);
+        uint32_t accepted = frames < space ? frames : space;
+        uint32_t idx = cap->dma_buffer_idx;
+
+        // Unpack straight into ring storage, one span at a time
+        uint32_t remaining = accepted;
+        for (int s = 0; s < 2 && remaining > 0; s++) {
+            uint32_t n = spans[s].count < remaining ? spans[s].count : remaining;
+            audio_sample_t *dst = spans[s].data;
+            for (uint32_t i = 0; i < n; i++) {
+                uint32_t raw_r = cap->dma_buffer[idx];
+                uint32_t raw_l = cap->dma_buffer[idx + 1];
+                idx = (idx + 2) & I2S_DMA_BUFFER_MASK;
+                dst[i].left = (int16_t)(raw_l & 0xFFFF);
+                dst[i].right = (int16_t)(raw_r & 0xFFFF);
+            }
+            remaining -= n;
         }
+        ap_ring_write_advance(cap->ring, accepted);
+
+        // Frames that did not fit are dropped
+        cap->dma_buffer_idx = (cap->dma_buffer_idx + frames * 2) & I2S_DMA_BUFFER_MASK;
+        cap->samples_captured += accepted;
+        cap->overflows += frames - accepted;
+        count = accepted;
+#endif
     }
 
     // Update sample rate measurement silently
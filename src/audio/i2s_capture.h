@@ -28,15 +28,18 @@ typedef struct {
     ap_ring_t *ring; // Output ring buffer
     volatile uint32_t samples_captured;
     volatile uint32_t overflows;
+    uint32_t dma_backlog_max; // Most frames found waiting in the DMA ring by one poll
+    uint32_t resyncs;         // i2s_capture_resync() calls while running
     bool running;
 
     // DMA state
     int dma_chan;
-    uint32_t *dma_buffer;    // Local buffer for DMA to write to (raw PIO words)
+    uint32_t *dma_buffer;    // DMA ring (raw PIO words, or the capture ring storage when packed)
     uint32_t dma_buffer_idx; // Current read position in dma_buffer
+    uint32_t dma_count;      // DMA transfer count at the last poll (packed: counts whole ring laps)
     uint pio_offset;         // Store program offset for resets
 
-    // For sample rate measurement and watchdog
+    // For sample rate measurement and activity
     uint32_t last_sample_count;
     uint64_t last_measure_time;
     uint64_t last_activity_time;
@@ -52,6 +55,12 @@ void i2s_capture_start(i2s_capture_t *cap);
 // Stop capturing
 void i2s_capture_stop(i2s_capture_t *cap);
 
+// Realign to the next WS edge after the I2S source went away and came back
+// (restarts the PIO program, re-arms the DMA at the current read position).
+// Unlike stop/start it keeps the ring contents and indices: no buffer clear,
+// no reset. Call from the core that polls.
+void i2s_capture_resync(i2s_capture_t *cap);
+
 // Poll for new samples - call this frequently from main loop
 // Returns number of samples captured this call
 uint32_t i2s_capture_poll(i2s_capture_t *cap);
@@ -1,86 +1,64 @@
 /**
  * Lowpass Filter Implementation
  *
- * 2-pole Butterworth lowpass (biquad) at ~20kHz cutoff for 49kHz sample rate.
- * Uses Q16 fixed-point arithmetic for efficiency on RP2350.
+ * Butterworth lowpass of order 2 * LOWPASS_SECTIONS as a biquad cascade.
+ * Each section is a bilinear-transformed analog Butterworth pair with
+ * frequency pre-warping; section k has Q = 1 / (2 cos((2k + 1) * pi / (4N))).
  *
- * Transfer function: H(z) = (b0 + b1*z^-1 + b2*z^-2) / (1 + a1*z^-1 + a2*z^-2)
- *
- * Coefficients calculated for:
- * - Sample rate: 49140 Hz
- * - Cutoff: 20000 Hz
- * - Type: Butterworth lowpass
+ * Fixed-point: Q4.28 coefficients, 64-bit accumulation, and signal/state
+ * carrying 8 fraction bits so no precision is lost between sections.
+ * AUDIO_LOWPASS_FLOAT: single-precision coefficients and transposed direct
+ * form II sections instead.
  */
 
 #include "lowpass.h"
 
-// Biquad coefficients in Q16 fixed-point
-// For Butterworth LPF at fc=20kHz, fs=49.14kHz:
-// Using bilinear transform with frequency pre-warping
-// These give gentle rolloff above 20kHz
-#define B0 18552   // ~0.283 * 65536
-#define B1 37104   // ~0.566 * 65536
-#define B2 18552   // ~0.283 * 65536
-#define A1 (-7864) // ~-0.120 * 65536
-#define A2 17520   // ~0.267 * 65536
+#include <math.h>
+#include <string.h>
+
+#define LOWPASS_PI 3.14159265358979
 
-void lowpass_init(lowpass_t *lp)
+#if AUDIO_LOWPASS_FLOAT
+static float lowpass_coef(double v)
 {
-    lp->left.x1 = 0;
-    lp->left.x2 = 0;
-    lp->left.y1 = 0;
-    lp->left.y2 = 0;
-    lp->right.x1 = 0;
-    lp->right.x2 = 0;
-    lp->right.y1 = 0;
-    lp->right.y2 = 0;
-    lp->enabled = true; // On by default for anti-aliasing
+    return (float)v;
 }
-
-void lowpass_set_enabled(lowpass_t *lp, bool enabled)
+#else
+static int32_t lowpass_coef(double v)
 {
-    lp->enabled = enabled;
-    if (!enabled) {
-        // Reset state
-        lp->left.x1 = lp->left.x2 = 0;
-        lp->left.y1 = lp->left.y2 = 0;
-        lp->right.x1 = lp->right.x2 = 0;
-        lp->right.y1 = lp->right.y2 = 0;
-    }
+    return (int32_t)lround(v * (double)(1 << LOWPASS_COEF_SHIFT));
 }
+#endif
 
-// Process single sample through biquad
-// y[n] = b0*x[n] + b1*x[n-1] + b2*x[n-2] - a1*y[n-1] - a2*y[n-2]
-static inline int16_t lowpass_process_sample(lowpass_channel_t *ch, int16_t in)
+void lowpass_init(lowpass_t *lp, uint32_t sample_rate, uint32_t cutoff_hz)
 {
-    // Scale input to Q16
-    int32_t x0 = (int32_t)in << 16;
-
-    // Compute output (all in Q16)
-    int64_t acc = 0;
-    acc += (int64_t)B0 * (x0 >> 16);
-    acc += (int64_t)B1 * (ch->x1 >> 16);
-    acc += (int64_t)B2 * (ch->x2 >> 16);
-    acc -= (int64_t)A1 * (ch->y1 >> 16);
-    acc -= (int64_t)A2 * (ch->y2 >> 16);
+    // Pre-warped analog cutoff
+    double k = tan(LOWPASS_PI * (double)cutoff_hz / (double)sample_rate);
+    double k2 = k * k;
 
-    // Result is in Q16
-    int32_t y0 = (int32_t)acc;
+    for (int s = 0; s < LOWPASS_SECTIONS; s++) {
+        double q = 1.0 / (2.0 * cos((2 * s + 1) * LOWPASS_PI / (4.0 * LOWPASS_SECTIONS)));
+        double norm = 1.0 / (1.0 + k / q + k2);
+        double b0 = k2 * norm;
 
-    // Update state
-    ch->x2 = ch->x1;
-    ch->x1 = x0;
-    ch->y2 = ch->y1;
-    ch->y1 = y0;
+        lp->coeffs[s].b0 = lowpass_coef(b0);
+        lp->coeffs[s].b1 = lowpass_coef(2.0 * b0);
+        lp->coeffs[s].b2 = lowpass_coef(b0);
+        lp->coeffs[s].a1 = lowpass_coef(2.0 * (k2 - 1.0) * norm);
+        lp->coeffs[s].a2 = lowpass_coef((1.0 - k / q + k2) * norm);
+    }
 
-    // Convert back to int16
-    int32_t out = y0 >> 16;
-    if (out > 32767)
-        out = 32767;
-    if (out < -32768)
-        out = -32768;
+    memset(lp->state, 0, sizeof(lp->state));
+    lp->enabled = true; // On by default for anti-aliasing
+}
 
-    return (int16_t)out;
+void lowpass_set_enabled(lowpass_t *lp, bool enabled)
+{
+    lp->enabled = enabled;
+    if (!enabled) {
+        // Reset state
+        memset(lp->state, 0, sizeof(lp->state));
+    }
 }
 
 void lowpass_process_buffer(lowpass_t *lp, audio_sample_t *samples, uint32_t count)
@@ -89,7 +67,6 @@ void lowpass_process_buffer(lowpass_t *lp, audio_sample_t *samples, uint32_t cou
         return;
 
     for (uint32_t i = 0; i < count; i++) {
-        samples[i].left = lowpass_process_sample(&lp->left, samples[i].left);
-        samples[i].right = lowpass_process_sample(&lp->right, samples[i].right);
+        dsp_pair_store(&samples[i], lowpass_step(lp, lp->state, dsp_pair_load(&samples[i])));
     }
 }
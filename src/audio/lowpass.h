@@ -1,29 +1,125 @@
 /**
  * Audio Pipeline - Lowpass Filter
  *
- * Simple 2-pole IIR (biquad) lowpass filter for anti-aliasing before SRC.
- * Cutoff ~20kHz at 49kHz sample rate.
+ * Butterworth lowpass built from a cascade of biquad sections, for
+ * anti-aliasing before SRC. Coefficients are designed at init for the
+ * actual input rate and a chosen cutoff.
  */
 
 #ifndef LOWPASS_H
 #define LOWPASS_H
 
 #include "audio_common.h"
+#include "audio_dsp.h"
 
-// Biquad filter state (per channel)
+// Number of biquad sections (filter order = 2 * sections)
+#ifndef LOWPASS_SECTIONS
+#define LOWPASS_SECTIONS 2
+#endif
+
+// -3 dB point, below the 24 kHz output Nyquist
+#ifndef LOWPASS_CUTOFF_HZ
+#define LOWPASS_CUTOFF_HZ 19000
+#endif
+
+#if AUDIO_LOWPASS_FLOAT
+// Section coefficients: y = b0*x + b1*x1 + b2*x2 - a1*y1 - a2*y2
+typedef struct {
+    float b0, b1, b2, a1, a2;
+} lowpass_coeffs_t;
+
+// Transposed direct form II section state (float path), index 0 = left, 1 = right
+typedef struct {
+    float z1[2], z2[2];
+} lowpass_section_t;
+#else
+// Coefficients are Q4.28 (|a1| approaches 2 for low cutoffs)
+#define LOWPASS_COEF_SHIFT 28
+// Samples carry 8 fraction bits through the cascade
+#define LOWPASS_STATE_SHIFT 8
+
+// Section coefficients: y = b0*x + b1*x1 + b2*x2 - a1*y1 - a2*y2
+typedef struct {
+    int32_t b0, b1, b2, a1, a2;
+} lowpass_coeffs_t;
+
+// Direct form I section state, index 0 = left, 1 = right
 typedef struct {
-    int32_t x1, x2; // Previous inputs (Q16 fixed-point)
-    int32_t y1, y2; // Previous outputs (Q16 fixed-point)
-} lowpass_channel_t;
+    int32_t x1[2], x2[2];
+    int32_t y1[2], y2[2];
+} lowpass_section_t;
+#endif
 
 typedef struct {
-    lowpass_channel_t left;
-    lowpass_channel_t right;
+    lowpass_coeffs_t coeffs[LOWPASS_SECTIONS];
+    lowpass_section_t state[LOWPASS_SECTIONS];
     bool enabled;
 } lowpass_t;
 
-// Initialize filter
-void lowpass_init(lowpass_t *lp);
+#if AUDIO_LOWPASS_FLOAT
+// Process one stereo sample through the cascade, both channels per section so
+// the coefficients are loaded once (shared by the buffer path and the fused
+// SRC kernel, which passes its own copy of the state)
+static inline dsp_pair_t lowpass_step(const lowpass_t *lp, lowpass_section_t *state, dsp_pair_t in)
+{
+    float v[2] = {(float)dsp_lo(in), (float)dsp_hi(in)};
+
+    for (int s = 0; s < LOWPASS_SECTIONS; s++) {
+        const lowpass_coeffs_t *c = &lp->coeffs[s];
+        lowpass_section_t *st = &state[s];
+        for (int ch = 0; ch < 2; ch++) {
+            float x = v[ch];
+            float y = c->b0 * x + st->z1[ch];
+            st->z1[ch] = c->b1 * x - c->a1 * y + st->z2[ch];
+            st->z2[ch] = c->b2 * x - c->a2 * y;
+            v[ch] = y;
+        }
+    }
+
+    return dsp_pack(dsp_f32_sat16(v[0]), dsp_f32_sat16(v[1]));
+}
+#else
+// Round cascade output back to a 16-bit sample (saturated by the caller)
+static inline int32_t lowpass_round(int32_t v)
+{
+    return (v + (1 << (LOWPASS_STATE_SHIFT - 1))) >> LOWPASS_STATE_SHIFT;
+}
+
+// Process one stereo sample through the cascade, both channels per section so
+// the coefficients are loaded once (shared by the buffer path and the fused
+// SRC kernel, which passes its own copy of the state).
+// The state needs more than 16 bits per channel, so the sections use 32x32
+// 64-bit MACs (SMLAL); only the packed input/output uses the pair helpers.
+static inline dsp_pair_t lowpass_step(const lowpass_t *lp, lowpass_section_t *state, dsp_pair_t in)
+{
+    int32_t v[2] = {dsp_lo(in) * (1 << LOWPASS_STATE_SHIFT), dsp_hi(in) * (1 << LOWPASS_STATE_SHIFT)};
+
+    for (int s = 0; s < LOWPASS_SECTIONS; s++) {
+        const lowpass_coeffs_t *c = &lp->coeffs[s];
+        lowpass_section_t *st = &state[s];
+        for (int ch = 0; ch < 2; ch++) {
+            int64_t acc = (int64_t)1 << (LOWPASS_COEF_SHIFT - 1);
+            acc += (int64_t)c->b0 * v[ch];
+            acc += (int64_t)c->b1 * st->x1[ch];
+            acc += (int64_t)c->b2 * st->x2[ch];
+            acc -= (int64_t)c->a1 * st->y1[ch];
+            acc -= (int64_t)c->a2 * st->y2[ch];
+            int32_t y = (int32_t)(acc >> LOWPASS_COEF_SHIFT);
+
+            st->x2[ch] = st->x1[ch];
+            st->x1[ch] = v[ch];
+            st->y2[ch] = st->y1[ch];
+            st->y1[ch] = y;
+            v[ch] = y;
+        }
+    }
+
+    return dsp_pack_sat(lowpass_round(v[0]), lowpass_round(v[1]));
+}
+#endif
+
+// Initialize filter: design the cascade for sample_rate / cutoff_hz
+void lowpass_init(lowpass_t *lp, uint32_t sample_rate, uint32_t cutoff_hz);
 
 // Enable/disable
 void lowpass_set_enabled(lowpass_t *lp, bool enabled);
@@ -0,0 +1,109 @@
+/**
+ * Rate Recovery Implementation
+ *
+ * step = nominal_step * (1 + kp * e + integ), e = filtered level - target.
+ * A backlog that is filling means too much output: a larger step consumes more
+ * input per output sample, so positive error raises the ratio.
+ */
+
+#include "rate_ctrl.h"
+
+#include "src.h"
+
+#define RATE_CTRL_RANGE ((int32_t)(((int64_t)RATE_CTRL_RANGE_PPM << SRC_STEP_SHIFT) / 1000000))
+
+static uint32_t rate_to_step(uint32_t input_rate, uint32_t output_rate)
+{
+    return (uint32_t)(((uint64_t)input_rate << SRC_STEP_SHIFT) / output_rate);
+}
+
+static int32_t clamp_range(int64_t v)
+{
+    if (v > RATE_CTRL_RANGE)
+        return RATE_CTRL_RANGE;
+    if (v < -RATE_CTRL_RANGE)
+        return -RATE_CTRL_RANGE;
+    return (int32_t)v;
+}
+
+void rate_ctrl_init(rate_ctrl_t *rc, uint32_t input_rate, uint32_t output_rate)
+{
+    rc->output_rate = output_rate;
+    rc->nominal_step = rate_to_step(input_rate, output_rate);
+    rc->integ = 0;
+    rc->level_avg = 0;
+    rc->step = rc->nominal_step;
+    rc->in_window = 0;
+    rc->primed = false;
+    rc->have_measurement = false;
+    rc->locked = false;
+}
+
+void rate_ctrl_set_input_rate(rate_ctrl_t *rc, uint32_t measured_rate)
+{
+    if (measured_rate == 0)
+        return;
+
+    uint32_t step = rate_to_step(measured_rate, rc->output_rate);
+    uint32_t nominal = rate_to_step(SRC_INPUT_RATE_DEFAULT, rc->output_rate);
+    int64_t offset = ((int64_t)step - nominal) * SRC_STEP_ONE / nominal;
+    if (offset > RATE_CTRL_RANGE || offset < -RATE_CTRL_RANGE)
+        return;
+
+    // The measurement is a 0.5 s sample count (+/- 1 sample = +/- 36 ppm):
+    // smooth it so its quantisation does not show up as pitch jitter.
+    // The first one is taken as is.
+    uint32_t old_nominal = rc->nominal_step;
+    if (rc->have_measurement) {
+        rc->nominal_step += ((int32_t)(step - rc->nominal_step)) / 8;
+    } else {
+        rc->nominal_step = step;
+        rc->have_measurement = true;
+    }
+
+    // Bumpless: move the integrator so the current ratio is unchanged; the loop
+    // only has to trim what the feed-forward does not explain
+    int64_t ratio = (int64_t)old_nominal * (SRC_STEP_ONE + rc->integ);
+    rc->integ = clamp_range(ratio / rc->nominal_step - SRC_STEP_ONE);
+}
+
+uint32_t rate_ctrl_update(rate_ctrl_t *rc, uint32_t level_packets)
+{
+    // Level is sampled at an arbitrary point of a bursty fill/drain cycle:
+    // filter it before it drives the loop
+    int32_t level = (int32_t)level_packets << 8;
+    if (!rc->primed) {
+        rc->level_avg = level;
+        rc->primed = true;
+    }
+    int filter_shift = rc->locked ? RATE_CTRL_TRACK_FILTER_SHIFT : RATE_CTRL_ACQUIRE_FILTER_SHIFT;
+    rc->level_avg += (level - rc->level_avg) / (1 << filter_shift);
+
+    int32_t err = rc->level_avg - (RATE_CTRL_TARGET_LEVEL << 8); // Q8 islands
+    int64_t p_term = ((int64_t)err * RATE_CTRL_KP) >> 8;
+    int64_t i_term = ((int64_t)err * RATE_CTRL_KI) >> 8;
+    if (rc->locked) {
+        p_term >>= RATE_CTRL_TRACK_KP_SHIFT;
+        i_term >>= RATE_CTRL_TRACK_KI_SHIFT;
+    }
+
+    rc->integ = clamp_range((int64_t)rc->integ + i_term);
+    int32_t offset = clamp_range((int64_t)rc->integ + p_term);
+
+    rc->step = (uint32_t)((int64_t)rc->nominal_step + (((int64_t)rc->nominal_step * offset) >> SRC_STEP_SHIFT));
+
+    int32_t mag = err < 0 ? -err : err;
+    if (rc->locked) {
+        if (mag > (2 * RATE_CTRL_LOCK_WINDOW << 8)) {
+            rc->locked = false;
+            rc->in_window = 0;
+        }
+    } else if (mag < (RATE_CTRL_LOCK_WINDOW << 8)) {
+        if (++rc->in_window >= RATE_CTRL_LOCK_FRAMES)
+            rc->locked = true;
+    } else {
+        rc->in_window = 0;
+    }
+
+    return rc->step;
+}
@@ -0,0 +1,68 @@
+/**
+ * Audio Pipeline - Rate Recovery
+ *
+ * PI controller that locks the SRC ratio to the HDMI audio clock.
+ * Feed-forward from the measured I2S input rate, corrected once per video
+ * frame from the output backlog (packets of SRC output not yet sent: the
+ * collect ring plus the HSTX data island queue, drained at exactly the HDMI
+ * rate by the frame cadence). The ratio is 8.24 fixed point
+ * (about 0.06 ppm resolution), so corrections are smooth instead of 10 Hz steps.
+ *
+ * SDK-free so it can be driven by a host simulation.
+ */
+
+#ifndef RATE_CTRL_H
+#define RATE_CTRL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Backlog to hold (packets of 4 samples: 32 = 2.7 ms at 48 kHz)
+#ifndef RATE_CTRL_TARGET_LEVEL
+#define RATE_CTRL_TARGET_LEVEL 32
+#endif
+
+// Acquisition loop gains per island of error, in 8.24 ratio units.
+// Plant: 1 ppm of ratio error drains 48000 / 4 * 1e-6 islands/s; with updates
+// at 60 Hz these give a ~0.3 Hz loop with damping ~0.8 (no overshoot to speak of).
+#define RATE_CTRL_KP 4474 // ~267 ppm per island
+#define RATE_CTRL_KI 93   // ~5.5 ppm per island per frame
+
+// Once locked the loop shifts to a 4x narrower bandwidth (same damping) and
+// heavier level filtering, so backlog noise stops modulating the pitch
+#define RATE_CTRL_TRACK_KP_SHIFT 2
+#define RATE_CTRL_TRACK_KI_SHIFT 4
+#define RATE_CTRL_ACQUIRE_FILTER_SHIFT 2
+#define RATE_CTRL_TRACK_FILTER_SHIFT 4
+
+// Integrator and ratio limits: MVS input within +/- 5% of nominal
+#define RATE_CTRL_RANGE_PPM 50000
+
+// Locked when the filtered level stays within this many islands of the target;
+// drops back to acquisition when it leaves twice that window
+#define RATE_CTRL_LOCK_WINDOW 8
+#define RATE_CTRL_LOCK_FRAMES 60
+
+typedef struct {
+    uint32_t output_rate;
+    uint32_t nominal_step; // Feed-forward ratio from the measured input rate (8.24)
+    int32_t integ;         // Integrator (8.24 ratio offset)
+    int32_t level_avg;     // Filtered backlog (Q8 packets)
+    uint32_t step;         // Current ratio (8.24), what the SRC should use
+    uint32_t in_window;    // Consecutive frames within the lock window
+    bool primed;           // Level filter initialised
+    bool have_measurement; // Feed-forward has seen a measured rate
+    bool locked;
+} rate_ctrl_t;
+
+// Initialise for the nominal input rate (e.g. SRC_INPUT_RATE_DEFAULT)
+void rate_ctrl_init(rate_ctrl_t *rc, uint32_t input_rate, uint32_t output_rate);
+
+// Update the feed-forward from a measured input rate in Hz (0 = no measurement).
+// Values outside the allowed range are ignored.
+void rate_ctrl_set_input_rate(rate_ctrl_t *rc, uint32_t measured_rate);
+
+// Run one control step (call once per video frame), returns the new ratio (8.24)
+uint32_t rate_ctrl_update(rate_ctrl_t *rc, uint32_t level);
+
+#endif // RATE_CTRL_H
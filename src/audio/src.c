@@ -1,24 +1,106 @@
 /**
  * Sample Rate Conversion Implementation
  *
- * Three modes:
+ * Four modes:
  * - NONE: Passthrough (plays fast, ~15% at 55.5kHz->48kHz)
  * - DROP: Bresenham-style sample dropping (minimal CPU)
  * - LINEAR: Linear interpolation (better quality)
+ * - POLYPHASE: Kaiser-windowed sinc FIR bank (band-limited, no audible aliasing)
+ *
+ * LINEAR/POLYPHASE arithmetic is Q15 fixed point, or single-precision float
+ * with AUDIO_SRC_FLOAT; the 8.24 phase accumulator is the same for both.
  */
 
 #include "src.h"
 
+#include <math.h>
+#include <string.h>
+
+#include "audio_dsp.h"
+
+// POLYPHASE filter design (for the nominal 55556 -> 48000 ratio)
+// Cutoff sits between the 20 kHz audio band and the 24 kHz output Nyquist;
+// everything that still aliases folds back above ~20 kHz.
+#define SRC_POLY_CUTOFF_HZ 21000.0f
+#define SRC_POLY_KAISER_BETA 6.0f // ~60 dB stopband
+#define SRC_POLY_PI 3.14159265f
+
+// Coefficients in Q15 (float with AUDIO_SRC_FLOAT), one row per phase. Row
+// SRC_POLY_PHASES is phase 0 shifted by one sample, so rounding the
+// fractional position up never needs the next input.
+static src_poly_t g_poly_coeffs[SRC_POLY_PHASES + 1][SRC_POLY_TAPS] __attribute__((aligned(4)));
+static bool g_poly_ready = false;
+
+// Zeroth-order modified Bessel function (Kaiser window), power series
+static float bessel_i0(float x)
+{
+    float sum = 1.0f;
+    float term = 1.0f;
+    float q = x * x * 0.25f;
+    for (int k = 1; k < 32 && term > sum * 1e-9f; k++) {
+        term *= q / (float)(k * k);
+        sum += term;
+    }
+    return sum;
+}
+
+// Build the filter bank once. Tap k of phase p weights x[n-k] for an output
+// at fractional position p/PHASES between x[n-1] and x[n] (delayed by
+// TAPS/2 - 1 samples), i.e. at sinc offset t = TAPS/2 - k - p/PHASES.
+static void src_poly_build(void)
+{
+    const float fc = SRC_POLY_CUTOFF_HZ / (float)SRC_INPUT_RATE_DEFAULT;
+    const float half = SRC_POLY_TAPS / 2;
+    const float i0_beta = bessel_i0(SRC_POLY_KAISER_BETA);
+    float h[SRC_POLY_TAPS];
+
+    for (int p = 0; p <= SRC_POLY_PHASES; p++) {
+        float sum = 0.0f;
+        for (int k = 0; k < SRC_POLY_TAPS; k++) {
+            float t = half - (float)k - (float)p / SRC_POLY_PHASES;
+            float x = 2.0f * fc * t;
+            float sinc = (fabsf(x) < 1e-6f) ? 1.0f : sinf(SRC_POLY_PI * x) / (SRC_POLY_PI * x);
+            float r = t / half;
+            float w = (r * r < 1.0f) ? bessel_i0(SRC_POLY_KAISER_BETA * sqrtf(1.0f - r * r)) / i0_beta : 0.0f;
+            h[k] = 2.0f * fc * sinc * w;
+            sum += h[k];
+        }
+        // Unity DC gain for every phase, otherwise the phase pattern modulates the level
+        for (int k = 0; k < SRC_POLY_TAPS; k++) {
+#if AUDIO_SRC_FLOAT
+            g_poly_coeffs[p][k] = h[k] / sum;
+#else
+            g_poly_coeffs[p][k] = (int16_t)lrintf(h[k] / sum * 32768.0f);
+#endif
+        }
+    }
+    g_poly_ready = true;
+}
+
+static void src_poly_reset(src_t *s)
+{
+    memset(s->poly_hist_l, 0, sizeof(s->poly_hist_l));
+    memset(s->poly_hist_r, 0, sizeof(s->poly_hist_r));
+    s->poly_pos = 0;
+}
+
 void src_init(src_t *s, uint32_t input_rate, uint32_t output_rate)
 {
     s->mode = SRC_MODE_DROP; // Default to DROP (good balance)
     s->input_rate = input_rate;
     s->output_rate = output_rate;
+    s->step = (uint32_t)(((uint64_t)input_rate << SRC_STEP_SHIFT) / output_rate);
     s->accumulator = 0;
     s->phase = 0;
     s->prev_sample.left = 0;
     s->prev_sample.right = 0;
-    s->have_prev = false;
+    s->cur_sample.left = 0;
+    s->cur_sample.right = 0;
+
+    src_poly_reset(s);
+    if (!g_poly_ready) {
+        src_poly_build();
+    }
 }
 
 void src_set_mode(src_t *s, src_mode_t mode)
@@ -31,7 +113,16 @@ void src_set_mode(src_t *s, src_mode_t mode)
     // Reset state on mode change
     s->accumulator = 0;
     s->phase = 0;
-    s->have_prev = false;
+    s->prev_sample.left = s->prev_sample.right = 0;
+    s->cur_sample.left = s->cur_sample.right = 0;
+    src_poly_reset(s);
+}
+
+void src_set_step(src_t *s, uint32_t step)
+{
+    s->step = step;
+    // Nearest whole rate for DROP mode and status
+    s->input_rate = (uint32_t)(((uint64_t)step * s->output_rate + (SRC_STEP_ONE / 2)) >> SRC_STEP_SHIFT);
 }
 
 src_mode_t src_cycle_mode(src_t *s)
@@ -76,74 +167,156 @@ static uint32_t src_process_drop(src_t *s, const audio_sample_t *in, uint32_t in
     return out_count;
 }
 
-// LINEAR mode: Linear interpolation between samples
-// Uses fixed-point phase accumulator (16.16 format)
-static uint32_t src_process_linear(src_t *s, const audio_sample_t *in, uint32_t in_count, audio_sample_t *out,
-                                   uint32_t out_max, uint32_t *in_consumed)
+#if AUDIO_SRC_FLOAT
+// Dot product of SRC_POLY_TAPS coefficients with a delay line window, rounded
+// and saturated to a sample
+static inline int32_t src_poly_dot(const float *coeffs, const float *hist)
 {
-    if (in_count == 0) {
-        *in_consumed = 0;
-        return 0;
+    float acc = 0.0f;
+    for (int k = 0; k < SRC_POLY_TAPS; k++) {
+        acc += coeffs[k] * hist[k];
     }
+    return dsp_f32_sat16(acc);
+}
+
+// LINEAR interpolation at phase (8.24, below 1.0) from a to b
+static inline int32_t src_lerp(int32_t a, int32_t b, uint32_t phase)
+{
+    const float frac = (float)phase * (1.0f / (float)SRC_STEP_ONE);
+    return dsp_f32_sat16((float)a + (float)(b - a) * frac);
+}
+#else
+// Q15 dot product of SRC_POLY_TAPS coefficients with a delay line window
+// (the window start may be odd, see dsp_dot_q15())
+static inline int32_t src_poly_dot(const int16_t *coeffs, const int16_t *hist)
+{
+    // Rounding for the final >> 15
+    return dsp_dot_q15(coeffs, hist, SRC_POLY_TAPS, 1 << 14) >> 15;
+}
 
-    // Phase increment per output sample (16.16 fixed-point)
-    // ratio = input_rate / output_rate
-    // For 55555/48000 = 1.157, phase_inc = 0x12828 (~1.157 in 16.16)
-    uint32_t phase_inc = ((uint64_t)s->input_rate << 16) / s->output_rate;
+// LINEAR interpolation at phase (8.24, below 1.0) from a to b:
+// out = a + (b - a) * frac, frac in Q15 so the product fits
+static inline int32_t src_lerp(int32_t a, int32_t b, uint32_t phase)
+{
+    int32_t frac = (int32_t)(phase >> (SRC_STEP_SHIFT - 15));
+    return a + (((b - a) * frac) >> 15);
+}
+#endif
 
+// Shared LINEAR / POLYPHASE loop.
+// An 8.24 phase accumulator holds the next output position relative to the
+// two newest input samples: while it is below 1.0 an output is due, otherwise
+// the next input is shifted in. s->step is read on every call, so live ratio
+// changes from the rate controller apply from the next block.
+//
+// dc/lp are NULL for the staged path; the fused kernel passes them and each
+// input is filtered as it is shifted in, with the filter state held in locals
+// for the whole block. Both paths run the same per-sample steps, so their
+// output is bit-identical.
+static inline __attribute__((always_inline)) uint32_t src_run(src_t *s, src_mode_t mode, dc_filter_t *dc,
+                                                              lowpass_t *lp, const audio_sample_t *in,
+                                                              uint32_t in_count, audio_sample_t *out,
+                                                              uint32_t out_max, uint32_t *in_consumed)
+{
+    const uint32_t phase_inc = s->step;
+    const uint32_t round = 1u << (SRC_STEP_SHIFT - 1 - SRC_POLY_PHASE_BITS);
+    uint32_t phase = s->phase;
+    uint32_t pos = s->poly_pos;
+    dsp_pair_t prev = dsp_pair_load(&s->prev_sample);
+    dsp_pair_t cur = dsp_pair_load(&s->cur_sample);
     uint32_t out_count = 0;
     uint32_t in_idx = 0;
 
-    // Initialize with first sample if we don't have previous
-    if (!s->have_prev && in_count > 0) {
-        s->prev_sample = in[0];
-        s->have_prev = true;
-        in_idx = 1;
+    dc_filter_state_t dc_state;
+    lowpass_section_t lp_state[LOWPASS_SECTIONS];
+    if (dc) {
+        dc_state = dc->state;
+    }
+    if (lp) {
+        memcpy(lp_state, lp->state, sizeof(lp_state));
     }
 
-    while (out_count < out_max && in_idx <= in_count) {
-        // Get integer and fractional parts of phase
-        uint32_t int_phase = s->phase >> 16;
-        uint32_t frac = s->phase & 0xFFFF;
-
-        // Advance input index based on integer phase
-        while (int_phase > 0 && in_idx < in_count) {
-            s->prev_sample = in[in_idx++];
-            int_phase--;
-            s->phase -= 0x10000;
+    while (in_idx < in_count) {
+        // Output due between the two newest samples
+        if (phase < SRC_STEP_ONE) {
+            if (out_count >= out_max)
+                break;
+            dsp_pair_t y;
+            if (mode == SRC_MODE_LINEAR) {
+                y = dsp_pack(src_lerp(dsp_lo(prev), dsp_lo(cur), phase), src_lerp(dsp_hi(prev), dsp_hi(cur), phase));
+            } else {
+                const src_poly_t *c = g_poly_coeffs[(phase + round) >> (SRC_STEP_SHIFT - SRC_POLY_PHASE_BITS)];
+                y = dsp_pack_sat(src_poly_dot(c, &s->poly_hist_l[pos]), src_poly_dot(c, &s->poly_hist_r[pos]));
+            }
+            dsp_pair_store(&out[out_count++], y);
+            phase += phase_inc;
+            continue;
         }
 
-        // If we've run out of input, stop
-        if (in_idx >= in_count && int_phase > 0) {
-            break;
+        dsp_pair_t x = dsp_pair_load(&in[in_idx++]);
+        if (dc) {
+            x = dc_filter_step(&dc_state, x);
+        }
+        if (lp) {
+            x = lowpass_step(lp, lp_state, x);
         }
 
-        // Get next sample for interpolation
-        audio_sample_t next;
-        if (in_idx < in_count) {
-            next = in[in_idx];
+        // Shift in the next sample
+        phase -= SRC_STEP_ONE;
+        if (mode == SRC_MODE_LINEAR) {
+            prev = cur;
+            cur = x;
         } else {
-            // Use previous sample if at end
-            next = s->prev_sample;
+            // Newest at the lowest index of the window, written twice
+            pos = (pos - 1) & (SRC_POLY_TAPS - 1);
+            s->poly_hist_l[pos] = s->poly_hist_l[pos + SRC_POLY_TAPS] = (src_poly_t)dsp_lo(x);
+            s->poly_hist_r[pos] = s->poly_hist_r[pos + SRC_POLY_TAPS] = (src_poly_t)dsp_hi(x);
         }
-
-        // Linear interpolation
-        // out = prev + (next - prev) * frac / 65536
-        int32_t diff_l = next.left - s->prev_sample.left;
-        int32_t diff_r = next.right - s->prev_sample.right;
-
-        out[out_count].left = s->prev_sample.left + ((diff_l * (int32_t)frac) >> 16);
-        out[out_count].right = s->prev_sample.right + ((diff_r * (int32_t)frac) >> 16);
-        out_count++;
-
-        // Advance phase
-        s->phase += phase_inc;
     }
 
+    if (dc) {
+        dc->state = dc_state;
+    }
+    if (lp) {
+        memcpy(lp->state, lp_state, sizeof(lp_state));
+    }
+    s->phase = phase;
+    s->poly_pos = pos;
+    dsp_pair_store(&s->prev_sample, prev);
+    dsp_pair_store(&s->cur_sample, cur);
     *in_consumed = in_idx;
     return out_count;
 }
 
+// LINEAR mode: Linear interpolation between samples
+static uint32_t src_process_linear(src_t *s, const audio_sample_t *in, uint32_t in_count, audio_sample_t *out,
+                                   uint32_t out_max, uint32_t *in_consumed)
+{
+    return src_run(s, SRC_MODE_LINEAR, NULL, NULL, in, in_count, out, out_max, in_consumed);
+}
+
+// POLYPHASE mode: FIR interpolation at the fractional output position,
+// rounded to the nearest of SRC_POLY_PHASES filter phases
+static uint32_t src_process_polyphase(src_t *s, const audio_sample_t *in, uint32_t in_count, audio_sample_t *out,
+                                      uint32_t out_max, uint32_t *in_consumed)
+{
+    return src_run(s, SRC_MODE_POLYPHASE, NULL, NULL, in, in_count, out, out_max, in_consumed);
+}
+
+bool src_fused_supported(const src_t *s, const dc_filter_t *dc, const lowpass_t *lp)
+{
+    return dc->enabled && lp->enabled && (s->mode == SRC_MODE_LINEAR || s->mode == SRC_MODE_POLYPHASE);
+}
+
+uint32_t src_process_fused(src_t *s, dc_filter_t *dc, lowpass_t *lp, const audio_sample_t *in, uint32_t in_count,
+                           audio_sample_t *out, uint32_t out_max, uint32_t *in_consumed)
+{
+    if (s->mode == SRC_MODE_LINEAR) {
+        return src_run(s, SRC_MODE_LINEAR, dc, lp, in, in_count, out, out_max, in_consumed);
+    }
+    return src_run(s, SRC_MODE_POLYPHASE, dc, lp, in, in_count, out, out_max, in_consumed);
+}
+
 uint32_t src_process(src_t *s, const audio_sample_t *in, uint32_t in_count, audio_sample_t *out, uint32_t out_max,
                      uint32_t *in_consumed)
 {
@@ -154,6 +327,8 @@ uint32_t src_process(src_t *s, const audio_sample_t *in, uint32_t in_count, audi
             return src_process_drop(s, in, in_count, out, out_max, in_consumed);
         case SRC_MODE_LINEAR:
             return src_process_linear(s, in, in_count, out, out_max, in_consumed);
+        case SRC_MODE_POLYPHASE:
+            return src_process_polyphase(s, in, in_count, out, out_max, in_consumed);
         default:
             *in_consumed = 0;
             return 0;
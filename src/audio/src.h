@@ -9,6 +9,9 @@
 #define SRC_H
 
 #include "audio_common.h"
+#include "audio_config.h"
+#include "dc_filter.h"
+#include "lowpass.h"
 
 // Default rates
 // Neo Geo MVS (MV1C) outputs at 8MHz / 144 = 55,555.555... Hz
@@ -16,17 +19,42 @@
 #define SRC_INPUT_RATE_DEFAULT 55556
 #define SRC_OUTPUT_RATE_DEFAULT 48000
 
+// Resampling ratio (input samples per output sample) in 8.24 fixed point
+#define SRC_STEP_SHIFT 24
+#define SRC_STEP_ONE (1u << SRC_STEP_SHIFT)
+
+// POLYPHASE mode filter bank: SRC_POLY_TAPS taps per phase, SRC_POLY_PHASES
+// fractional positions per input sample
+#define SRC_POLY_TAPS 32
+#define SRC_POLY_PHASE_BITS 6
+#define SRC_POLY_PHASES (1 << SRC_POLY_PHASE_BITS)
+
+// POLYPHASE coefficient / delay line element: Q15 samples, or float with
+// AUDIO_SRC_FLOAT
+#if AUDIO_SRC_FLOAT
+typedef float src_poly_t;
+#else
+typedef int16_t src_poly_t;
+#endif
+
 // SRC instance
 typedef struct {
     src_mode_t mode;
-    uint32_t input_rate;
+    uint32_t input_rate;  // Nearest whole Hz of the current ratio (DROP mode, status)
     uint32_t output_rate;
+    uint32_t step;        // input_rate / output_rate, 8.24 (LINEAR, POLYPHASE)
 
     // Internal state for algorithms
     uint32_t accumulator;       // For DROP mode (bresenham)
-    uint32_t phase;             // For LINEAR mode (fixed-point position)
-    audio_sample_t prev_sample; // For LINEAR mode (interpolation)
-    bool have_prev;             // LINEAR mode: do we have a previous sample?
+    uint32_t phase;             // LINEAR/POLYPHASE output position (8.24)
+    audio_sample_t prev_sample; // For LINEAR mode (interpolation from)
+    audio_sample_t cur_sample;  // For LINEAR mode (interpolation to, newest input)
+
+    // POLYPHASE mode delay lines (per channel, written twice so the newest
+    // SRC_POLY_TAPS samples are always contiguous from poly_pos)
+    src_poly_t poly_hist_l[SRC_POLY_TAPS * 2];
+    src_poly_t poly_hist_r[SRC_POLY_TAPS * 2];
+    uint32_t poly_pos;
 } src_t;
 
 // Initialize SRC
@@ -35,6 +63,10 @@ void src_init(src_t *s, uint32_t input_rate, uint32_t output_rate);
 // Set mode
 void src_set_mode(src_t *s, src_mode_t mode);
 
+// Set the resampling ratio (8.24 input samples per output sample).
+// Takes effect from the next src_process() call; input_rate follows it.
+void src_set_step(src_t *s, uint32_t step);
+
 // Cycle to next mode, returns new mode
 src_mode_t src_cycle_mode(src_t *s);
 
@@ -52,4 +84,14 @@ static inline src_mode_t src_get_mode(src_t *s)
 uint32_t src_process(src_t *s, const audio_sample_t *in, uint32_t in_count, audio_sample_t *out, uint32_t out_max,
                      uint32_t *in_consumed);
 
+// Fused DC block + lowpass + SRC: filters each input as the resampler shifts
+// it in, in one pass with the filter state kept in registers, and writes only
+// output-rate samples. Input is left untouched. Output is bit-identical to
+// dc_filter_process_buffer() + lowpass_process_buffer() + src_process().
+// Only valid when src_fused_supported() (both filters enabled and a LINEAR or
+// POLYPHASE mode); otherwise use the separate stages.
+bool src_fused_supported(const src_t *s, const dc_filter_t *dc, const lowpass_t *lp);
+uint32_t src_process_fused(src_t *s, dc_filter_t *dc, lowpass_t *lp, const audio_sample_t *in, uint32_t in_count,
+                           audio_sample_t *out, uint32_t out_max, uint32_t *in_consumed);
+
 #endif // SRC_H
@@ -0,0 +1,125 @@
+#include "bus_perf.h"
+
+#include "pico/time.h"
+
+#include "hardware/structs/busctrl.h"
+#include "hardware/sync.h"
+
+#include <stdio.h>
+
+#include "memory_layout.h"
+
+#define BUS_PERF_COUNTERS 4
+#define BUS_PERF_GROUPS ((BUS_PERF_ARBITER_COUNT + BUS_PERF_COUNTERS - 1) / BUS_PERF_COUNTERS)
+
+// 每个仲裁器对应的 "访问冲突" 事件
+static const bus_ctrl_perf_counter_t g_events[BUS_PERF_ARBITER_COUNT] = {
+    arbiter_sram0_perf_event_access_contested,    arbiter_sram1_perf_event_access_contested,
+    arbiter_sram2_perf_event_access_contested,    arbiter_sram3_perf_event_access_contested,
+    arbiter_sram4_perf_event_access_contested,    arbiter_sram5_perf_event_access_contested,
+    arbiter_sram6_perf_event_access_contested,    arbiter_sram7_perf_event_access_contested,
+    arbiter_sram8_perf_event_access_contested,    arbiter_sram9_perf_event_access_contested,
+    arbiter_fastperi_perf_event_access_contested, arbiter_xip_main_perf_event_access_contested,
+};
+
+static const char *const g_names[BUS_PERF_ARBITER_COUNT] = {
+    "sram0", "sram1", "sram2", "sram3", "sram4", "sram5", "sram6", "sram7", "scratch_x", "scratch_y", "fastperi", "xip",
+};
+
+static repeating_timer_t g_timer;
+static uint32_t g_window_us = 0;
+static int g_group = 0;
+static uint32_t g_window_start_us = 0;
+
+// 正在累计的一轮，以及最近完成的一轮 (定时器中断写，线程读)
+static bus_perf_report_t g_pending;
+static bus_perf_report_t g_report;
+static volatile uint32_t g_report_seq = 0;
+static uint32_t g_printed_seq = 0;
+
+static void select_group(int group)
+{
+    for (int i = 0; i < BUS_PERF_COUNTERS; i++) {
+        int arbiter = group * BUS_PERF_COUNTERS + i;
+        if (arbiter < BUS_PERF_ARBITER_COUNT) {
+            busctrl_hw->counter[i].sel = g_events[arbiter];
+        }
+        busctrl_hw->counter[i].value = 0; // 任意写入清零
+    }
+}
+
+static bool sample_timer_callback(repeating_timer_t *rt)
+{
+    (void)rt;
+
+    uint32_t now = time_us_32();
+    uint32_t elapsed_us = now - g_window_start_us;
+
+    for (int i = 0; i < BUS_PERF_COUNTERS; i++) {
+        int arbiter = g_group * BUS_PERF_COUNTERS + i;
+        if (arbiter < BUS_PERF_ARBITER_COUNT) {
+            uint32_t count = busctrl_hw->counter[i].value;
+            g_pending.contested[arbiter] = count;
+            g_pending.contested_per_ms[arbiter] = elapsed_us ? (uint32_t)(((uint64_t)count * 1000u) / elapsed_us) : 0;
+        }
+    }
+
+    if (++g_group == BUS_PERF_GROUPS) {
+        // 一轮完成: 发布结果
+        g_group = 0;
+        g_pending.rotations++;
+        g_pending.window_us = g_window_us;
+        g_report_seq++;
+        __dmb();
+        g_report = g_pending;
+        __dmb();
+        g_report_seq++;
+    }
+
+    select_group(g_group);
+    g_window_start_us = time_us_32();
+    return true;
+}
+
+bool bus_perf_start(uint32_t window_ms)
+{
+    g_window_us = window_ms * 1000u;
+    g_group = 0;
+    busctrl_hw->perfctr_en = 1;
+    select_group(0);
+    g_window_start_us = time_us_32();
+    return add_repeating_timer_ms(-(int32_t)window_ms, sample_timer_callback, NULL, &g_timer);
+}
+
+bool bus_perf_get_report(bus_perf_report_t *report)
+{
+    uint32_t seq;
+    do {
+        do {
+            seq = g_report_seq;
+        } while (seq & 1);
+        __dmb();
+        *report = g_report;
+        __dmb();
+    } while (seq != g_report_seq);
+    return report->rotations != 0;
+}
+
+void bus_perf_service(void)
+{
+    if (g_report_seq == g_printed_seq || (g_report_seq & 1)) {
+        return;
+    }
+    g_printed_seq = g_report_seq;
+
+    bus_perf_report_t r;
+    if (!bus_perf_get_report(&r)) {
+        return;
+    }
+
+    printf("[bus] %s | contested/ms:", memory_layout_name());
+    for (int i = 0; i < BUS_PERF_ARBITER_COUNT; i++) {
+        printf(" %s=%lu", g_names[i], (unsigned long)r.contested_per_ms[i]);
+    }
+    printf("\n");
+}
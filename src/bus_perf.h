@@ -0,0 +1,59 @@
+/**
+ * Bus fabric contention counters
+ *
+ * The RP2350 bus fabric has four performance counters, each selectable to
+ * one arbiter event. The sampler rotates them over the SRAM bank arbiters
+ * (plus the fast peripheral and XIP arbiters) in groups of four, one group
+ * per window, from a repeating timer on Core 0. A report holds the
+ * contested-access rate of every arbiter from the latest full rotation.
+ */
+
+#ifndef BUS_PERF_H
+#define BUS_PERF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    BUS_PERF_SRAM0 = 0,
+    BUS_PERF_SRAM1,
+    BUS_PERF_SRAM2,
+    BUS_PERF_SRAM3,
+    BUS_PERF_SRAM4,
+    BUS_PERF_SRAM5,
+    BUS_PERF_SRAM6,
+    BUS_PERF_SRAM7,
+    BUS_PERF_SRAM8, // scratch_x
+    BUS_PERF_SRAM9, // scratch_y
+    BUS_PERF_FASTPERI,
+    BUS_PERF_XIP,
+    BUS_PERF_ARBITER_COUNT
+} bus_perf_arbiter_t;
+
+typedef struct {
+    uint32_t rotations;                              // Completed rotations since start
+    uint32_t window_us;                              // Sample window per group
+    uint32_t contested[BUS_PERF_ARBITER_COUNT];      // Contested accesses in the arbiter's window
+    uint32_t contested_per_ms[BUS_PERF_ARBITER_COUNT];
+} bus_perf_report_t;
+
+/**
+ * Start sampling (one group of four arbiters per window).
+ */
+bool bus_perf_start(uint32_t window_ms);
+
+/**
+ * Copy the report from the latest full rotation.
+ *
+ * @return false if no rotation has completed yet
+ */
+bool bus_perf_get_report(bus_perf_report_t *report);
+
+/**
+ * Print the latest report, labelled with the memory layout name, if a new
+ * rotation completed since the last call. Call from thread context (for
+ * example the capture loop), never from an interrupt.
+ */
+void bus_perf_service(void);
+
+#endif // BUS_PERF_H
@@ -0,0 +1,118 @@
+#include "core1_sched.h"
+
+#include "pico_hdmi/video_output.h"
+
+#include <stddef.h>
+
+#include "cycle_count.h"
+#include "video_pipeline.h"
+
+typedef struct {
+    const char *name;
+    core1_task_fn fn;
+    uint32_t budget_cycles;
+    core1_task_stats_t stats;
+} core1_task_t;
+
+static core1_task_t g_tasks[CORE1_SCHED_MAX_TASKS];
+static int g_task_count = 0;
+
+// 轮转起点: 每次调度后移一位，预算大的任务不会总排在最后拿不到余量
+static int g_next = 0;
+static bool g_cycle_count_ready = false;
+
+// 输出循环的后台任务: 在下一次扫描线回调之前的空闲时间内运行各任务
+static void core1_sched_run(void)
+{
+    if (g_task_count == 0) {
+        return;
+    }
+    if (!g_cycle_count_ready) {
+        cycle_count_init();
+        g_cycle_count_ready = true;
+    }
+
+    // 视频输出还没开始 (没有行周期) 时不限时间
+    uint32_t due = 0;
+    bool bounded = video_pipeline_next_line_due(&due);
+
+    // 本次调用中还要运行的任务: 开始时全部检查一遍，之后只重复报告还有工作的任务
+    bool want[CORE1_SCHED_MAX_TASKS];
+    for (int i = 0; i < g_task_count; i++) {
+        want[i] = true;
+    }
+
+    bool more = true;
+    while (more) {
+        more = false;
+        for (int i = 0; i < g_task_count; i++) {
+            int id = (g_next + i) % g_task_count;
+            if (!want[id]) {
+                continue;
+            }
+            core1_task_t *task = &g_tasks[id];
+
+            uint32_t t0 = cycle_count_now();
+            if (bounded) {
+                int32_t slack = (int32_t)(due - t0) - CORE1_SCHED_GUARD_CYCLES;
+                if (slack < (int32_t)task->budget_cycles) {
+                    // 放不下: 本次不再尝试，留给下一个空闲窗口
+                    task->stats.deferred++;
+                    want[id] = false;
+                    continue;
+                }
+            }
+
+            want[id] = task->fn();
+
+            uint32_t t1 = cycle_count_now();
+            uint32_t cycles = t1 - t0;
+            task->stats.runs++;
+            task->stats.cycles_total += cycles;
+            if (cycles > task->stats.cycles_max) {
+                task->stats.cycles_max = cycles;
+            }
+            if (cycles > task->budget_cycles) {
+                task->stats.overruns++;
+            }
+            if (bounded && (int32_t)(due - t1) < 0) {
+                task->stats.late++;
+            }
+            more |= want[id];
+        }
+    }
+
+    g_next = (g_next + 1) % g_task_count;
+}
+
+int core1_sched_add(const char *name, core1_task_fn fn, uint32_t budget_cycles)
+{
+    if (g_task_count >= CORE1_SCHED_MAX_TASKS || fn == NULL) {
+        return -1;
+    }
+    if (g_task_count == 0) {
+        video_output_set_background_task(core1_sched_run);
+    }
+
+    int id = g_task_count;
+    g_tasks[id] = (core1_task_t){.name = name, .fn = fn, .budget_cycles = budget_cycles};
+    g_task_count++;
+    return id;
+}
+
+int core1_sched_task_count(void)
+{
+    return g_task_count;
+}
+
+const char *core1_sched_task_name(int id)
+{
+    return (id >= 0 && id < g_task_count) ? g_tasks[id].name : NULL;
+}
+
+void core1_sched_get_stats(int id, core1_task_stats_t *stats)
+{
+    if (id >= 0 && id < g_task_count) {
+        *stats = g_tasks[id].stats;
+    }
+}
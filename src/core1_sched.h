@@ -0,0 +1,58 @@
+/**
+ * Core 1 background scheduler
+ *
+ * The HDMI output loop on Core 1 calls one background task between scanline
+ * callbacks. The scheduler is that task: it runs the registered tasks
+ * round-robin, but only starts a task when its cycle budget fits before the
+ * next scanline callback is due (video_pipeline_next_line_due(), from the
+ * scanline position and the measured line period). Tasks do a bounded slice
+ * of work per call and report whether more is pending, so long jobs spread
+ * over several slack windows instead of delaying a scanline.
+ */
+
+#ifndef CORE1_SCHED_H
+#define CORE1_SCHED_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef CORE1_SCHED_MAX_TASKS
+#define CORE1_SCHED_MAX_TASKS 8
+#endif
+
+// Cycles kept free before the deadline for the scheduler itself and the
+// return to the output loop
+#ifndef CORE1_SCHED_GUARD_CYCLES
+#define CORE1_SCHED_GUARD_CYCLES 256
+#endif
+
+// Do one bounded slice of work; return true if more work is pending now
+typedef bool (*core1_task_fn)(void);
+
+typedef struct {
+    uint32_t runs;          // Calls made
+    uint32_t deferred;      // Invocations where the budget did not fit the slack
+    uint32_t overruns;      // Calls that took longer than the budget
+    uint32_t late;          // Calls that ended after the scanline deadline
+    uint32_t cycles_max;    // Worst single call, DWT cycles
+    uint64_t cycles_total;
+} core1_task_stats_t;
+
+/**
+ * Register a task (Core 0, before Core 1 starts). The first call installs the
+ * scheduler as the output loop's background task.
+ *
+ * @param budget_cycles worst-case cycles of one call
+ * @return task id, or -1 if the table is full
+ */
+int core1_sched_add(const char *name, core1_task_fn fn, uint32_t budget_cycles);
+
+int core1_sched_task_count(void);
+const char *core1_sched_task_name(int id);
+
+/**
+ * Copy a task's counters (written by Core 1, fields may be torn).
+ */
+void core1_sched_get_stats(int id, core1_task_stats_t *stats);
+
+#endif // CORE1_SCHED_H
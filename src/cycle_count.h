@@ -0,0 +1,26 @@
+/**
+ * Cortex-M33 DWT cycle counter helpers, for measuring per-line and per-block
+ * costs on target. Each core has its own counter; call cycle_count_init()
+ * on the core that does the measuring.
+ */
+
+#ifndef CYCLE_COUNT_H
+#define CYCLE_COUNT_H
+
+#include "hardware/structs/m33.h"
+
+#include <stdint.h>
+
+static inline void cycle_count_init(void)
+{
+    m33_hw->demcr |= M33_DEMCR_TRCENA_BITS;
+    m33_hw->dwt_cyccnt = 0;
+    m33_hw->dwt_ctrl |= M33_DWT_CTRL_CYCCNTENA_BITS;
+}
+
+static inline uint32_t cycle_count_now(void)
+{
+    return m33_hw->dwt_cyccnt;
+}
+
+#endif // CYCLE_COUNT_H
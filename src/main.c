@@ -3,18 +3,75 @@
 #include "pico/multicore.h"
 #include "pico/stdlib.h"
 #include "hardware/clocks.h"
+#include <assert.h>
 #include <stdio.h>
 #include <string.h>
 
 #include "video/video_config.h"
 #include "video/video_pipeline.h"
 #include "video_capture.h"
-#include "video/video_buffers.h" 
+#include "video/video_buffers.h"
+#include "memory_layout.h"
+#include "bus_perf.h"
+#include "core1_sched.h"
+#include "signal_lock.h"
+#include "osd.h"
+#include "audio/audio_subsystem.h"
 
 // --- 全局变量定义 ---
+#if VIDEO_LINE_RACING
+// 追线模式: 行环形缓冲 (采集逐行提交，输出紧跟其后)
+line_ring_t g_line_ring;
+#else
 // 分配在 RAM 中的帧缓冲区 (RP2350 专用)
-uint16_t g_frame_buf[2][FRAME_WIDTH * FRAME_HEIGHT];
-volatile int g_display_idx = 0;
+uint16_t g_frame_buf[FRAME_BUFFER_COUNT][FRAME_WIDTH * FRAME_HEIGHT];
+#endif
+
+// 输入信号锁定管理 (Core 1 后台任务，每个输出帧更新一次)
+signal_lock_t g_signal_lock;
+static uint32_t g_signal_lock_frame = 0;
+
+static bool signal_lock_task(void)
+{
+    video_pipeline_stats_t out_stats;
+    video_pipeline_get_stats(&out_stats);
+    if (out_stats.frames == g_signal_lock_frame) {
+        return false;
+    }
+    g_signal_lock_frame = out_stats.frames;
+
+    video_capture_stats_t cap;
+    video_capture_get_stats(&cap);
+    signal_lock_input_t in = {
+        .now_us = time_us_32(),
+        .vsyncs = cap.vsyncs,
+        .frame_period_us = cap.frame_period_us,
+        .audio_samples = audio_subsystem_input_samples(),
+        .audio_running = audio_subsystem_running(),
+    };
+    const signal_lock_output_t *out = signal_lock_update(&g_signal_lock, &in);
+
+    // 画面: 锁定时正常显示，丢失后先保持最后一帧，超过保持时间蓝屏
+    // 按枚举值指定下标，两个枚举的顺序不必一致；新增输出时数组大小检查会报错
+    static const video_fallback_t fallback[] = {
+        [SIGNAL_VIDEO_LIVE] = VIDEO_FALLBACK_NONE,
+        [SIGNAL_VIDEO_HOLD] = VIDEO_FALLBACK_HOLD,
+        [SIGNAL_VIDEO_BLUE] = VIDEO_FALLBACK_BLUE,
+    };
+    static_assert(sizeof(fallback) / sizeof(fallback[0]) == SIGNAL_VIDEO_COUNT,
+                  "fallback table must cover every output");
+    video_pipeline_set_fallback(fallback[out->video]);
+    audio_subsystem_set_muted(out->audio_muted);
+
+    // 重新对齐只重启状态机，不重新初始化
+    if (out->video_resync) {
+        video_capture_request_resync();
+    }
+    if (out->audio_resync) {
+        audio_subsystem_resync_input();
+    }
+    return false;
+}
 
 int main(void)
 {
@@ -27,7 +84,21 @@ int main(void)
     sleep_ms(1000);
 
     // 清空缓冲区
+#if VIDEO_LINE_RACING
+    memset(&g_line_ring, 0, sizeof(g_line_ring));
+#else
     memset(g_frame_buf, 0, sizeof(g_frame_buf));
+    frame_manager_init();
+#endif
+
+    // 总线优先级等布局设置，并记录大缓冲区的位置
+    memory_layout_init();
+#if VIDEO_LINE_RACING
+    memory_layout_note("line_ring", &g_line_ring, sizeof(g_line_ring));
+#else
+    memory_layout_note("frame_buf", g_frame_buf, sizeof(g_frame_buf));
+#endif
+    memory_layout_note("osd_framebuffer", osd_framebuffer, sizeof(osd_framebuffer));
 
     // 初始化 HDMI 队列与管道
     hstx_di_queue_init();
@@ -38,11 +109,22 @@ int main(void)
     // 初始化采集 (GPIO, PIO, DMA)
     video_capture_init(MVS_HEIGHT);
 
+    // 信号锁定管理: 锁定之前输出蓝屏
+    signal_lock_init(&g_signal_lock);
+    video_pipeline_set_fallback(VIDEO_FALLBACK_BLUE);
+    core1_sched_add("signal_lock", signal_lock_task, SIGNAL_LOCK_BUDGET_CYCLES);
+
     // 启动 Core 1 运行 HDMI 输出线程
     multicore_launch_core1(video_output_core1_run);
     
     sleep_ms(100);
 
+    memory_layout_print();
+#if MEM_BUS_PERF_REPORT
+    // 每组仲裁器采样 250ms，一轮 (3 组) 约 0.75 秒打印一次
+    bus_perf_start(250);
+#endif
+
     // Core 0 运行视频采集
     video_capture_run();
 
@@ -0,0 +1,90 @@
+#include "memory_layout.h"
+
+#include "hardware/structs/busctrl.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SRAM_BASE_ADDR 0x20000000u
+#define SRAM_UPPER_ADDR 0x20040000u
+#define SCRATCH_X_ADDR 0x20080000u
+#define SCRATCH_Y_ADDR 0x20081000u
+#define SCRATCH_END_ADDR 0x20082000u
+
+#define MAX_NOTES 16
+
+#define LAYOUT_STR_(x) #x
+#define LAYOUT_STR(x) LAYOUT_STR_(x)
+
+typedef struct {
+    const char *name;
+    uintptr_t addr;
+    size_t size;
+} layout_note_t;
+
+static layout_note_t g_notes[MAX_NOTES];
+static int g_note_count = 0;
+
+void memory_layout_note(const char *name, const void *addr, size_t size)
+{
+    for (int i = 0; i < g_note_count; i++) {
+        if (strcmp(g_notes[i].name, name) == 0) {
+            g_notes[i].addr = (uintptr_t)addr;
+            g_notes[i].size = size;
+            return;
+        }
+    }
+    if (g_note_count < MAX_NOTES) {
+        g_notes[g_note_count++] = (layout_note_t){.name = name, .addr = (uintptr_t)addr, .size = size};
+    }
+}
+
+void memory_layout_init(void)
+{
+#if MEM_LAYOUT_DMA_PRIORITY
+    busctrl_hw->priority = BUSCTRL_BUS_PRIORITY_DMA_R_BITS | BUSCTRL_BUS_PRIORITY_DMA_W_BITS;
+#endif
+}
+
+// 用于标记报告: 同一份代码不同布局的测量结果可以直接对比
+static const char g_layout_name[] = "audio_process=" LAYOUT_STR(MEM_LAYOUT_AUDIO_PROCESS)
+    " audio_collect=" LAYOUT_STR(MEM_LAYOUT_AUDIO_COLLECT)
+    " scanline_cache=" LAYOUT_STR(MEM_LAYOUT_SCANLINE_CACHE)
+    " dma_priority=" LAYOUT_STR(MEM_LAYOUT_DMA_PRIORITY);
+
+const char *memory_layout_name(void)
+{
+    return g_layout_name;
+}
+
+static const char *region_name(uintptr_t start, uintptr_t end)
+{
+    if (start >= SCRATCH_Y_ADDR && end <= SCRATCH_END_ADDR) {
+        return "SRAM9 scratch_y";
+    }
+    if (start >= SCRATCH_X_ADDR && end <= SCRATCH_Y_ADDR) {
+        return "SRAM8 scratch_x";
+    }
+    if (start >= SRAM_BASE_ADDR && end <= SRAM_UPPER_ADDR) {
+        return "SRAM0-3 striped";
+    }
+    if (start >= SRAM_UPPER_ADDR && end <= SCRATCH_X_ADDR) {
+        return "SRAM4-7 striped";
+    }
+    if (start >= SRAM_BASE_ADDR && end <= SCRATCH_X_ADDR) {
+        return "SRAM0-7 striped";
+    }
+    return "other";
+}
+
+void memory_layout_print(void)
+{
+    printf("[mem] layout: %s\n", memory_layout_name());
+    for (int i = 0; i < g_note_count; i++) {
+        const layout_note_t *n = &g_notes[i];
+        uintptr_t end = n->addr + n->size;
+        printf("[mem]   %-16s 0x%08lx-0x%08lx %6lu B  %s\n", n->name, (unsigned long)n->addr, (unsigned long)end,
+               (unsigned long)n->size, region_name(n->addr, end));
+    }
+}
@@ -0,0 +1,94 @@
+/**
+ * NeoPico-HD Memory Layout
+ *
+ * RP2350 SRAM as seen by the bus fabric:
+ *   0x20000000-0x2003FFFF  SRAM0-3, word-striped (consecutive words rotate banks)
+ *   0x20040000-0x2007FFFF  SRAM4-7, word-striped
+ *   0x20080000-0x20080FFF  SRAM8 = scratch_x (Core 1 stack lives here)
+ *   0x20081000-0x20081FFF  SRAM9 = scratch_y (Core 0 stack lives here)
+ * Unlike the RP2040 there is no non-striped alias of main SRAM, so the only
+ * bank choices are "striped main SRAM" (whichever half the linker picks) or
+ * one of the two scratch banks, which have their own arbiters.
+ *
+ * Each hot buffer that is small enough for a scratch bank gets a placement
+ * knob below; override with -D<knob>=SCRATCH_X etc. and compare the bus
+ * contention report (bus_perf.h) between builds. The stacks take 2 KB of
+ * each scratch bank, so at most ~2 KB of buffers fit per bank; the linker
+ * reports an overflow otherwise.
+ */
+
+#ifndef MEMORY_LAYOUT_H
+#define MEMORY_LAYOUT_H
+
+#include "pico.h"
+
+#include <stddef.h>
+
+// =============================================================================
+// Placement knobs: SRAM, SCRATCH_X or SCRATCH_Y
+// =============================================================================
+
+// Audio pipeline SRC output buffer (256 B, CPU read/write)
+#ifndef MEM_LAYOUT_AUDIO_PROCESS
+#define MEM_LAYOUT_AUDIO_PROCESS SRAM
+#endif
+
+// HDMI audio collect buffer (512 B, CPU read/write)
+#ifndef MEM_LAYOUT_AUDIO_COLLECT
+#define MEM_LAYOUT_AUDIO_COLLECT SRAM
+#endif
+
+// Core 1 doubled scanline cache (1280 B, CPU write + DMA read, Core 1 only)
+#ifndef MEM_LAYOUT_SCANLINE_CACHE
+#define MEM_LAYOUT_SCANLINE_CACHE SCRATCH_X
+#endif
+
+// Give DMA read/write priority over the processors on the bus fabric
+// (HSTX and capture DMA win ties against CPU accesses)
+#ifndef MEM_LAYOUT_DMA_PRIORITY
+#define MEM_LAYOUT_DMA_PRIORITY 0
+#endif
+
+// Periodically print the bus contention report (bus_perf.h)
+#ifndef MEM_BUS_PERF_REPORT
+#define MEM_BUS_PERF_REPORT 0
+#endif
+
+// =============================================================================
+// Placement macro
+// =============================================================================
+// Usage: static uint32_t MEM_PLACE(MEM_LAYOUT_SCANLINE_CACHE, scanline_cache) buf[N];
+
+#define MEM_PLACE(region, name) MEM_PLACE_(region, name)
+#define MEM_PLACE_(region, name) MEM_PLACE_##region(name)
+#define MEM_PLACE_SRAM(name)
+#define MEM_PLACE_SCRATCH_X(name) __scratch_x(#name)
+#define MEM_PLACE_SCRATCH_Y(name) __scratch_y(#name)
+
+// =============================================================================
+// Buffer registry
+// =============================================================================
+
+/**
+ * Record a hot buffer so memory_layout_print() can report where it landed.
+ * Call from the owning module's init; later calls with the same name update
+ * the entry.
+ */
+void memory_layout_note(const char *name, const void *addr, size_t size);
+
+/**
+ * Apply bus-level settings (DMA priority). Call once at boot.
+ */
+void memory_layout_init(void);
+
+/**
+ * Short description of the build's layout knobs, used to label reports.
+ */
+const char *memory_layout_name(void);
+
+/**
+ * Print every registered buffer with its address range and SRAM region.
+ */
+void memory_layout_print(void);
+
+#endif // MEMORY_LAYOUT_H
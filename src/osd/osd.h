@@ -18,7 +18,7 @@
 extern volatile bool osd_visible;
 
 // Pre-rendered RGB565 buffer for the OSD box
-// Placed in scratch_y to avoid bus contention with Core 0
+// 20 KB, too large for a scratch bank: lives in striped main SRAM
 extern uint16_t osd_framebuffer[OSD_BOX_H][OSD_BOX_W];
 
 // Initialize OSD system
@@ -0,0 +1,204 @@
+#include "signal_lock.h"
+
+#include <string.h>
+
+static const char *const g_state_names[] = {"no_signal", "acquiring", "locked", "holdover"};
+
+static void record_recovery(uint32_t *last, uint32_t *max, uint32_t us)
+{
+    *last = us;
+    if (us > *max) {
+        *max = us;
+    }
+}
+
+void signal_lock_init(signal_lock_t *lk)
+{
+    memset(lk, 0, sizeof(*lk));
+    lk->state = SIGNAL_LOCK_NO_SIGNAL;
+    lk->out.video = SIGNAL_VIDEO_BLUE;
+    lk->out.audio_muted = true;
+}
+
+// 同步恢复 (或周期变化): 从头计稳定帧
+// relock: 短暂丢失后参考周期仍然有效，只需少量稳定帧
+static void start_acquire(signal_lock_t *lk, uint32_t now, bool relock)
+{
+    lk->state = SIGNAL_LOCK_ACQUIRING;
+    lk->return_us = now;
+    lk->stable_frames = 0;
+    lk->bad_frames = 0;
+    lk->relock = relock;
+}
+
+// 同步超时: 有画面可保持且未超过保持时间时进入 HOLDOVER，否则蓝屏
+// 采集端重新对齐到下一个 VSYNC，信号回来时从干净的帧开始
+static void video_lost(signal_lock_t *lk, uint32_t now)
+{
+    if (lk->state == SIGNAL_LOCK_LOCKED) {
+        lk->stats.video_losses++;
+        lk->lost_us = lk->last_vsync_us;
+    }
+    if (lk->have_frame && now - lk->lost_us < SIGNAL_LOCK_HOLD_US) {
+        lk->state = SIGNAL_LOCK_HOLDOVER;
+    } else {
+        lk->state = SIGNAL_LOCK_NO_SIGNAL;
+    }
+    lk->out.video_resync = true;
+    lk->stats.video_resyncs++;
+}
+
+// 新的帧周期与参考周期比较
+static void check_period(signal_lock_t *lk, uint32_t period, uint32_t frames)
+{
+    if (lk->ref_period_us == 0) {
+        lk->ref_period_us = period;
+        return;
+    }
+
+    uint32_t diff = period > lk->ref_period_us ? period - lk->ref_period_us : lk->ref_period_us - period;
+    if (diff <= SIGNAL_LOCK_PERIOD_TOLERANCE_US) {
+        lk->stable_frames += frames;
+        lk->bad_frames = 0;
+        // 参考周期缓慢跟随输入 (1/8)
+        lk->ref_period_us += (int32_t)(period - lk->ref_period_us) / 8;
+        return;
+    }
+
+    lk->bad_frames++;
+    lk->stable_frames = 0;
+    if (lk->state != SIGNAL_LOCK_LOCKED) {
+        // 还没锁定: 以新周期为参考重新开始
+        lk->ref_period_us = period;
+        lk->relock = false;
+    }
+}
+
+static void update_video(signal_lock_t *lk, const signal_lock_input_t *in)
+{
+    const uint32_t now = in->now_us;
+    uint32_t frames = in->vsyncs - lk->vsyncs;
+    lk->vsyncs = in->vsyncs;
+
+    if (frames == 0) {
+        if ((lk->state == SIGNAL_LOCK_LOCKED || lk->state == SIGNAL_LOCK_ACQUIRING) &&
+            now - lk->last_vsync_us > SIGNAL_LOCK_VIDEO_TIMEOUT_US) {
+            video_lost(lk, now);
+        } else if (lk->state == SIGNAL_LOCK_HOLDOVER && now - lk->lost_us >= SIGNAL_LOCK_HOLD_US) {
+            // 保持时间已过: 蓝屏，之前的周期不再作为快速重锁的参考
+            lk->state = SIGNAL_LOCK_NO_SIGNAL;
+            lk->ref_period_us = 0;
+            lk->have_frame = false;
+        }
+        return;
+    }
+    lk->last_vsync_us = now;
+
+    // 信号回来: 本次的周期跨过了中断的间隔，不参与判断
+    if (lk->state == SIGNAL_LOCK_NO_SIGNAL || lk->state == SIGNAL_LOCK_HOLDOVER) {
+        start_acquire(lk, now, lk->state == SIGNAL_LOCK_HOLDOVER && lk->ref_period_us != 0);
+        return;
+    }
+
+    check_period(lk, in->frame_period_us, frames);
+
+    if (lk->state == SIGNAL_LOCK_ACQUIRING) {
+        uint32_t needed = lk->relock ? SIGNAL_LOCK_RELOCK_FRAMES : SIGNAL_LOCK_STABLE_FRAMES;
+        if (lk->stable_frames >= needed) {
+            lk->state = SIGNAL_LOCK_LOCKED;
+            lk->have_frame = true;
+            lk->stats.locks++;
+            record_recovery(&lk->stats.video_recovery_us_last, &lk->stats.video_recovery_us_max, now - lk->return_us);
+        }
+    } else if (lk->bad_frames >= SIGNAL_LOCK_UNSTABLE_FRAMES) {
+        // 锁定中周期持续偏离 (输入切换模式或同步受干扰): 保持画面并重新识别
+        lk->stats.unstable++;
+        lk->lost_us = now;
+        lk->ref_period_us = in->frame_period_us;
+        start_acquire(lk, now, false);
+        lk->out.video_resync = true;
+        lk->stats.video_resyncs++;
+    }
+}
+
+static void update_audio(signal_lock_t *lk, const signal_lock_input_t *in)
+{
+    const uint32_t now = in->now_us;
+
+    // 音频采集未启动: 保持静音，不计丢失也不请求重新对齐
+    if (!in->audio_running) {
+        lk->audio_samples = in->audio_samples;
+        lk->audio_active = false;
+        lk->audio_resync_us = now;
+        lk->out.audio_muted = true;
+        return;
+    }
+
+    if (in->audio_samples != lk->audio_samples) {
+        lk->audio_samples = in->audio_samples;
+        if (!lk->audio_active) {
+            lk->audio_active = true;
+            lk->audio_since_us = now;
+        }
+        lk->audio_last_us = now;
+    } else if (lk->audio_active && now - lk->audio_last_us > SIGNAL_LOCK_AUDIO_TIMEOUT_US) {
+        lk->audio_active = false;
+        lk->audio_resync_us = lk->audio_last_us;
+        lk->stats.audio_losses++;
+    }
+
+    // 没有 I2S 数据时定期重新对齐 PIO (WS 边沿)，不清空缓冲区
+    if (!lk->audio_active && now - lk->audio_resync_us >= SIGNAL_LOCK_AUDIO_RESYNC_US) {
+        lk->audio_resync_us = now;
+        lk->out.audio_resync = true;
+        lk->stats.audio_resyncs++;
+    }
+
+    // 视频锁定且音频已稳定运行一段时间才取消静音，其他情况一律静音
+    bool unmute = lk->state == SIGNAL_LOCK_LOCKED && lk->audio_active &&
+                  now - lk->audio_since_us >= SIGNAL_LOCK_AUDIO_SETTLE_US;
+    if (unmute && lk->out.audio_muted) {
+        // 恢复时间从视频和音频中较晚恢复的一个算起
+        uint32_t from = (int32_t)(lk->return_us - lk->audio_since_us) > 0 ? lk->return_us : lk->audio_since_us;
+        record_recovery(&lk->stats.audio_recovery_us_last, &lk->stats.audio_recovery_us_max, now - from);
+    }
+    lk->out.audio_muted = !unmute;
+}
+
+const signal_lock_output_t *signal_lock_update(signal_lock_t *lk, const signal_lock_input_t *in)
+{
+    lk->out.video_resync = false;
+    lk->out.audio_resync = false;
+
+    // 第一次调用只记录计数器的起点
+    if (!lk->started) {
+        lk->started = true;
+        lk->vsyncs = in->vsyncs;
+        lk->audio_samples = in->audio_samples;
+        lk->last_vsync_us = in->now_us;
+        lk->audio_resync_us = in->now_us;
+        return &lk->out;
+    }
+
+    update_video(lk, in);
+    update_audio(lk, in);
+
+    switch (lk->state) {
+        case SIGNAL_LOCK_LOCKED:
+            lk->out.video = SIGNAL_VIDEO_LIVE;
+            break;
+        case SIGNAL_LOCK_ACQUIRING:
+        case SIGNAL_LOCK_HOLDOVER:
+            lk->out.video = lk->have_frame ? SIGNAL_VIDEO_HOLD : SIGNAL_VIDEO_BLUE;
+            break;
+        default:
+            lk->out.video = SIGNAL_VIDEO_BLUE;
+            break;
+    }
+    return &lk->out;
+}
+
+const char *signal_lock_state_name(signal_lock_state_t state)
+{
+    return (unsigned)state < sizeof(g_state_names) / sizeof(g_state_names[0]) ? g_state_names[state] : "?";
+}
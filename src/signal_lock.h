@@ -0,0 +1,161 @@
+/**
+ * Input signal lock manager
+ *
+ * One state machine for the input as a whole: video sync presence, frame
+ * period stability and I2S activity. It is fed free-running counters once per
+ * output frame and decides what the output shows (live video, the last frame
+ * held, or a blue screen), whether HDMI audio is muted, and when a capture
+ * path should be realigned. Realigning is a resync request to the capture
+ * engine, not a teardown: buffers, DMA channels and the detected timing stay.
+ *
+ *   NO_SIGNAL --VSYNC--> ACQUIRING --stable periods--> LOCKED
+ *       ^                   |  ^                         |
+ *       |                   |  +----unstable period------+
+ *       |                   v                            |
+ *       +--hold expired-- HOLDOVER <----VSYNC timeout----+
+ *
+ * A signal that returns during HOLDOVER with the frame period it had before
+ * relocks after SIGNAL_LOCK_RELOCK_FRAMES instead of a full acquisition.
+ * Recovery times (signal return to lock / to unmute) are kept as stats.
+ *
+ * SDK-free so loss/return traces can be replayed on a host.
+ */
+
+#ifndef SIGNAL_LOCK_H
+#define SIGNAL_LOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// No VSYNC for this long = video lost (3 input frames)
+#ifndef SIGNAL_LOCK_VIDEO_TIMEOUT_US
+#define SIGNAL_LOCK_VIDEO_TIMEOUT_US 50000
+#endif
+
+// Frame periods within this of the reference count as stable (about 1.5 input
+// lines: a change in line count or a 59.2 <-> 60 Hz switch falls outside it)
+#ifndef SIGNAL_LOCK_PERIOD_TOLERANCE_US
+#define SIGNAL_LOCK_PERIOD_TOLERANCE_US 100
+#endif
+
+// Stable periods needed to lock: full acquisition, and relock after a short
+// loss with an unchanged period
+#ifndef SIGNAL_LOCK_STABLE_FRAMES
+#define SIGNAL_LOCK_STABLE_FRAMES 8
+#endif
+#ifndef SIGNAL_LOCK_RELOCK_FRAMES
+#define SIGNAL_LOCK_RELOCK_FRAMES 2
+#endif
+
+// Consecutive out-of-tolerance periods that drop a lock
+#ifndef SIGNAL_LOCK_UNSTABLE_FRAMES
+#define SIGNAL_LOCK_UNSTABLE_FRAMES 3
+#endif
+
+// How long the last frame is held after a loss before the blue screen
+#ifndef SIGNAL_LOCK_HOLD_US
+#define SIGNAL_LOCK_HOLD_US 1000000
+#endif
+
+// No I2S samples for this long = audio lost; audio has to run this long
+// before it is unmuted; while lost, the I2S capture is realigned this often
+#ifndef SIGNAL_LOCK_AUDIO_TIMEOUT_US
+#define SIGNAL_LOCK_AUDIO_TIMEOUT_US 20000
+#endif
+#ifndef SIGNAL_LOCK_AUDIO_SETTLE_US
+#define SIGNAL_LOCK_AUDIO_SETTLE_US 50000
+#endif
+#ifndef SIGNAL_LOCK_AUDIO_RESYNC_US
+#define SIGNAL_LOCK_AUDIO_RESYNC_US 200000
+#endif
+
+// Worst-case cycles of one update as a Core 1 background task (core1_sched.h)
+#ifndef SIGNAL_LOCK_BUDGET_CYCLES
+#define SIGNAL_LOCK_BUDGET_CYCLES 600
+#endif
+
+typedef enum {
+    SIGNAL_LOCK_NO_SIGNAL = 0, // No input sync: blue screen
+    SIGNAL_LOCK_ACQUIRING,     // Sync present, frame period not stable yet
+    SIGNAL_LOCK_LOCKED,        // Live video
+    SIGNAL_LOCK_HOLDOVER,      // Sync lost recently: last frame held
+} signal_lock_state_t;
+
+typedef enum {
+    SIGNAL_VIDEO_LIVE = 0,
+    SIGNAL_VIDEO_HOLD, // Keep showing the last complete frame
+    SIGNAL_VIDEO_BLUE, // No-signal screen
+    SIGNAL_VIDEO_COUNT // Number of outputs (for lookup tables)
+} signal_video_out_t;
+
+// Counters sampled by the caller (free-running, only changes are looked at)
+typedef struct {
+    uint32_t now_us;
+    uint32_t vsyncs;          // Input VSYNCs seen
+    uint32_t frame_period_us; // Latest VSYNC to VSYNC period
+    uint32_t audio_samples;   // I2S frames captured
+    bool audio_running;       // I2S capture started (audio half idle and muted until then)
+} signal_lock_input_t;
+
+// What the caller applies after an update
+typedef struct {
+    signal_video_out_t video;
+    bool audio_muted;
+    bool video_resync; // Realign the video capture to the next VSYNC (this update only)
+    bool audio_resync; // Realign the I2S capture (this update only)
+} signal_lock_output_t;
+
+typedef struct {
+    uint32_t locks;         // Entries into LOCKED
+    uint32_t video_losses;  // VSYNC timeouts while locked
+    uint32_t unstable;      // Locks dropped for an unstable frame period
+    uint32_t audio_losses;  // I2S timeouts after audio was running
+    uint32_t video_resyncs; // Requests made
+    uint32_t audio_resyncs;
+
+    // Video: first VSYNC after a loss (or at start) to LOCKED
+    uint32_t video_recovery_us_last;
+    uint32_t video_recovery_us_max;
+    // Audio: video and I2S both back to unmute
+    uint32_t audio_recovery_us_last;
+    uint32_t audio_recovery_us_max;
+} signal_lock_stats_t;
+
+typedef struct {
+    signal_lock_state_t state;
+    bool started;
+
+    // Video
+    uint32_t vsyncs;         // Last sampled counter
+    uint32_t last_vsync_us;  // When the counter last moved
+    uint32_t ref_period_us;  // Reference frame period (0 = none yet)
+    uint32_t stable_frames;  // Consecutive periods within tolerance
+    uint32_t bad_frames;     // Consecutive periods outside it
+    uint32_t return_us;      // Signal came back (start of this acquisition)
+    uint32_t lost_us;        // Last VSYNC before the lock was lost
+    bool relock;             // Short loss, same period: fast relock
+    bool have_frame;         // A live frame was shown (something to hold)
+
+    // Audio
+    uint32_t audio_samples;  // Last sampled counter
+    uint32_t audio_last_us;  // When the counter last moved
+    uint32_t audio_since_us; // Start of the current run of activity
+    uint32_t audio_resync_us;
+    bool audio_active;
+
+    signal_lock_output_t out;
+    signal_lock_stats_t stats;
+} signal_lock_t;
+
+// Lock manager instance driven from Core 1 (defined in main.c)
+extern signal_lock_t g_signal_lock;
+
+void signal_lock_init(signal_lock_t *lk);
+
+// Feed one sample of the counters (once per output frame); returns the
+// actions to apply, valid until the next update
+const signal_lock_output_t *signal_lock_update(signal_lock_t *lk, const signal_lock_input_t *in);
+
+const char *signal_lock_state_name(signal_lock_state_t state);
+
+#endif // SIGNAL_LOCK_H
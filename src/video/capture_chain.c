@@ -0,0 +1,17 @@
+#include "capture_chain.h"
+
+#include <stddef.h>
+
+uint32_t capture_chain_build(uintptr_t *blocks, uint16_t *frame, uint32_t active_lines, uint32_t line_stride)
+{
+    uint32_t n = 0;
+
+    // 有效行依次写入帧缓冲区
+    for (uint32_t line = 0; line < active_lines; line++) {
+        blocks[n++] = (uintptr_t)(frame + line * line_stride);
+    }
+
+    // NULL 触发: 停止控制链并产生完成中断
+    blocks[n++] = (uintptr_t)NULL;
+    return n;
+}
@@ -0,0 +1,30 @@
+#ifndef CAPTURE_CHAIN_H
+#define CAPTURE_CHAIN_H
+
+#include <stdint.h>
+
+#include "video_config.h"
+
+// One control block per active line plus the NULL terminator (vertical
+// blanking is skipped by the PIO, so no lines are captured to be discarded)
+#define CAPTURE_CHAIN_MAX_BLOCKS (FRAME_HEIGHT + 1)
+
+/**
+ * Build the control block list for one captured frame.
+ *
+ * Each entry is the destination address of one line. The control DMA channel
+ * writes them one by one into the data channel's WRITE_ADDR_TRIG alias; the
+ * trailing NULL is a null trigger that stops the chain and raises the
+ * (IRQ_QUIET) completion interrupt.
+ *
+ * Kept free of SDK dependencies so the sequencing can be checked on a host.
+ *
+ * @param blocks        Output list, at least active_lines + 1 entries
+ * @param frame         First line of the destination frame buffer
+ * @param active_lines  Lines to store into the frame buffer (at most FRAME_HEIGHT)
+ * @param line_stride   Distance between frame buffer lines, in pixels
+ * @return Number of entries written, including the terminator
+ */
+uint32_t capture_chain_build(uintptr_t *blocks, uint16_t *frame, uint32_t active_lines, uint32_t line_stride);
+
+#endif // CAPTURE_CHAIN_H
@@ -0,0 +1,60 @@
+#ifndef CAPTURE_STATS_H
+#define CAPTURE_STATS_H
+
+#include "hardware/sync.h"
+
+#include <stdint.h>
+
+#include "video_capture.h"
+
+// Shared by the capture engines: video_capture_stats_t is written only from
+// Core 0 and published with a sequence counter (odd while an update is in
+// progress) so Core 1 can take snapshots without locking.
+
+static inline void capture_stats_begin(volatile uint32_t *seq)
+{
+    (*seq)++;
+    __dmb();
+}
+
+static inline void capture_stats_end(volatile uint32_t *seq)
+{
+    __dmb();
+    (*seq)++;
+}
+
+// Update a cur/min/max/avg group (avg is a 1/16 exponential average)
+static inline void capture_stats_record(uint32_t *cur, uint32_t *min, uint32_t *max, uint32_t *avg, uint32_t sample)
+{
+    *cur = sample;
+    if (*avg == 0) {
+        *min = sample;
+        *max = sample;
+        *avg = sample;
+        return;
+    }
+    if (sample < *min) {
+        *min = sample;
+    }
+    if (sample > *max) {
+        *max = sample;
+    }
+    *avg = (uint32_t)((int32_t)*avg + (((int32_t)sample - (int32_t)*avg) >> 4));
+}
+
+// Copy a consistent snapshot, retrying if the writer was active
+static inline void capture_stats_read(const video_capture_stats_t *src, const volatile uint32_t *seq,
+                                      video_capture_stats_t *dst)
+{
+    uint32_t s;
+    do {
+        do {
+            s = *seq;
+        } while (s & 1);
+        __dmb();
+        *dst = *src;
+        __dmb();
+    } while (s != *seq);
+}
+
+#endif // CAPTURE_STATS_H
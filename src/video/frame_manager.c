@@ -0,0 +1,88 @@
+#include "frame_manager.h"
+#include "pico.h"
+#include "hardware/sync.h"
+#include "video_buffers.h"
+
+// 追线模式不使用整帧缓冲
+#if !VIDEO_LINE_RACING
+
+#define NO_FRAME (-1)
+
+// 空闲缓冲区由 0 + 1 + 2 减去另外两个得到
+static_assert(FRAME_BUFFER_COUNT == 3, "frame manager assumes triple buffering");
+
+// 缓冲区归属: 三者互不相同 (g_ready 可以为空)
+static int g_write = 1;          // Core 0 正在写入
+static int g_ready = NO_FRAME;   // 已完成、等待输出 VSYNC
+static int g_display = 0;        // Core 1 正在扫描输出
+
+static frame_manager_stats_t g_stats;
+
+// 两个核之间共享，使用硬件自旋锁 (同时屏蔽本核中断)
+static spin_lock_t *g_lock = NULL;
+
+void frame_manager_init(void)
+{
+    if (g_lock == NULL) {
+        g_lock = spin_lock_instance(spin_lock_claim_unused(true));
+    }
+
+    uint32_t save = spin_lock_blocking(g_lock);
+    g_display = 0;
+    g_write = 1;
+    g_ready = NO_FRAME;
+    g_stats = (frame_manager_stats_t){0};
+    spin_unlock(g_lock, save);
+}
+
+int frame_manager_write_index(void)
+{
+    return g_write;
+}
+
+int frame_manager_capture_done(void)
+{
+    uint32_t save = spin_lock_blocking(g_lock);
+
+    int next;
+    if (g_ready != NO_FRAME) {
+        // 上一帧还没被显示就被新帧取代: 丢弃，复用它的缓冲区
+        next = g_ready;
+        g_stats.frames_dropped++;
+    } else {
+        // 剩下的那个缓冲区 (既不在写入也不在显示)
+        next = (0 + 1 + 2) - g_write - g_display;
+    }
+    g_ready = g_write;
+    g_write = next;
+
+    spin_unlock(g_lock, save);
+    return next;
+}
+
+const uint16_t *frame_manager_output_vsync(void)
+{
+    uint32_t save = spin_lock_blocking(g_lock);
+
+    if (g_ready != NO_FRAME) {
+        g_display = g_ready;
+        g_ready = NO_FRAME;
+        g_stats.frames_presented++;
+    } else {
+        // 输入比输出慢 (或没有信号): 重复显示当前帧
+        g_stats.frames_repeated++;
+    }
+    int display = g_display;
+
+    spin_unlock(g_lock, save);
+    return g_frame_buf[display];
+}
+
+void frame_manager_get_stats(frame_manager_stats_t *stats)
+{
+    uint32_t save = spin_lock_blocking(g_lock);
+    *stats = g_stats;
+    spin_unlock(g_lock, save);
+}
+
+#endif // !VIDEO_LINE_RACING
@@ -0,0 +1,55 @@
+#ifndef FRAME_MANAGER_H
+#define FRAME_MANAGER_H
+
+#include <stdint.h>
+
+// Capture writes one buffer, output scans out another, the third holds the
+// newest completed frame until the next output VSYNC picks it up.
+#define FRAME_BUFFER_COUNT 3
+
+/**
+ * Frame pacing counters. The input (~59.x Hz) and HDMI output (60 Hz) run
+ * from unrelated clocks, so the output regularly shows a frame twice or
+ * skips one; these count how often.
+ */
+typedef struct {
+    uint32_t frames_presented; // Output VSYNCs that switched to a new frame
+    uint32_t frames_repeated;  // Output VSYNCs with no new frame (previous one shown again)
+    uint32_t frames_dropped;   // Completed frames replaced by a newer one before being shown
+} frame_manager_stats_t;
+
+/**
+ * Reset buffer ownership. Call before capture or output start.
+ */
+void frame_manager_init(void);
+
+/**
+ * Index of the buffer capture should write next (Core 0).
+ */
+int frame_manager_write_index(void);
+
+/**
+ * Publish the buffer capture just finished (Core 0, IRQ safe).
+ *
+ * Pacing policy is "newest wins": if the previous completed frame has not
+ * been shown yet it is dropped and its buffer is reused, so latency never
+ * grows beyond one frame. Never hands out the buffer being scanned out.
+ *
+ * @return Index of the buffer to capture the next frame into
+ */
+int frame_manager_capture_done(void);
+
+/**
+ * Switch to the newest completed frame, if any (Core 1, at output line 0).
+ * Swaps only happen here, so a frame is never shown partially.
+ *
+ * @return Buffer to scan out for this whole output frame
+ */
+const uint16_t *frame_manager_output_vsync(void);
+
+/**
+ * Snapshot the pacing counters.
+ */
+void frame_manager_get_stats(frame_manager_stats_t *stats);
+
+#endif // FRAME_MANAGER_H
@@ -78,23 +78,35 @@ static inline void line_ring_output_vsync(void)
     __dmb();
 }
 
-// Check if line is ready and still in buffer
-static inline bool line_ring_ready(uint16_t line)
+typedef enum {
+    LINE_RING_READY = 0, // Line written and still in buffer
+    LINE_RING_LATE,      // Output is ahead of capture, line not written yet
+    LINE_RING_OVERRUN,   // Capture lapped the reader, line was overwritten
+} line_ring_state_t;
+
+// Classify line N of the current display frame
+static inline line_ring_state_t line_ring_state(uint16_t line)
 {
     uint32_t target_idx = g_line_ring.read_frame_start + line;
     uint32_t write_pos = g_line_ring.write_idx;
 
     // Line must have been written
-    if (target_idx >= write_pos) {
-        return false; // Not written yet
+    if ((int32_t)(write_pos - target_idx) <= 0) {
+        return LINE_RING_LATE;
     }
 
     // Line must still be in buffer (not overwritten)
     if (write_pos - target_idx > LINE_RING_SIZE) {
-        return false; // Buffer overrun - data was overwritten
+        return LINE_RING_OVERRUN;
     }
 
-    return true;
+    return LINE_RING_READY;
+}
+
+// Check if line is ready and still in buffer
+static inline bool line_ring_ready(uint16_t line)
+{
+    return line_ring_state(line) == LINE_RING_READY;
 }
 
 // Get read pointer for line N in current display frame
@@ -0,0 +1,334 @@
+#include "video_capture.h"
+#include "pico/stdlib.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "video_buffers.h"
+#include "mvs_capture.pio.h"
+#include "mvs_pins.h"
+#include "mvs_pixel.h"
+#include "capture_stats.h"
+#include "cycle_count.h"
+#include "memory_layout.h"
+#include "bus_perf.h"
+#include <stdio.h>
+#include <string.h>
+
+// MVS 采集引擎: CSYNC 复合同步 + RGB555 + SHADOW (GP27-44)
+// 与 LCD 引擎 (video_capture.c) 实现同一组 video_capture.h 接口，由 CMake 选择其一
+
+#define MVS_CAPTURE_PINS 18
+#define MVS_GPIO_BASE 16
+
+static PIO g_pio = pio1;
+static uint g_sm = 0;
+static uint g_offset = 0;
+static int g_dma_chan = -1; // PIO RX FIFO -> 原始行缓冲区
+
+// 原始采集行 (每像素一个 18 位字)，乒乓使用: DMA 写一行的同时 CPU 转换另一行
+static uint32_t g_raw_line[2][FRAME_WIDTH];
+
+// 当前采集时序，以及对应的 PIO 配置字
+static video_timing_t g_timing;
+static uint32_t g_pio_config = 0;
+
+// PIO 检测到场同步脉冲 (一次场同步会有多个脉冲，每个都会置位)
+static volatile bool g_vsync = false;
+
+// Core 1 (信号锁定管理) 请求重新对齐，由采集循环执行
+static volatile bool g_resync_pending = false;
+
+// 当前正在写入的缓冲区
+static int g_write_idx = 0;
+
+// 采集统计: 只在 Core 0 写，g_stats_seq 为奇数时表示正在更新
+static video_capture_stats_t g_stats;
+static volatile uint32_t g_stats_seq = 0;
+static uint32_t g_last_frame_us = 0;
+
+// PIO IRQ 0: CSYNC 宽脉冲 (场同步)
+static void mvs_vsync_irq_handler(void)
+{
+    pio_interrupt_clear(g_pio, 0);
+    g_vsync = true;
+}
+
+static void start_line_dma(uint32_t *dst)
+{
+    dma_channel_set_write_addr(g_dma_chan, dst, true);
+}
+
+// 场同步期间 PIO 不推送像素: 丢弃 FIFO 中的残留数据，行计数从下一行重新开始
+static void reset_line_dma(void)
+{
+    dma_channel_abort(g_dma_chan);
+    while (!pio_sm_is_rx_fifo_empty(g_pio, g_sm)) {
+        (void)pio_sm_get(g_pio, g_sm);
+    }
+}
+
+// 目标行: 追线模式写入环形缓冲并逐行提交，否则写入当前帧缓冲区
+static uint16_t *frame_row(uint row)
+{
+#if VIDEO_LINE_RACING
+    return line_ring_write_ptr((uint16_t)row);
+#else
+    return &g_frame_buf[g_write_idx][row * FRAME_WIDTH];
+#endif
+}
+
+static void commit_row(uint row)
+{
+#if VIDEO_LINE_RACING
+    line_ring_commit((uint16_t)(row + 1));
+#else
+    (void)row;
+#endif
+}
+
+#if VIDEO_LINE_RACING
+// 追线模式: 有效区域之外的行 (V_OFFSET 上下) 填黑，避免显示环形缓冲中的旧数据
+static void fill_black_rows(uint first, uint count)
+{
+    for (uint row = first; row < first + count; row++) {
+        memset(line_ring_write_ptr((uint16_t)row), 0, FRAME_WIDTH * sizeof(uint16_t));
+        commit_row(row);
+    }
+}
+#endif
+
+// 采集一帧 (从场同步后的第一行开始)
+// 中途又出现场同步时放弃本帧并返回 false，调用者立即从新的场同步重新开始
+static bool capture_frame(void)
+{
+    const uint total = g_timing.v_back_porch + g_timing.v_active;
+    uint32_t frame_start_us = 0;
+    uint cur = 0;
+
+#if VIDEO_LINE_RACING
+    line_ring_vsync();
+    fill_black_rows(0, V_OFFSET);
+#endif
+
+    start_line_dma(g_raw_line[cur]);
+    for (uint line = 0; line < total; line++) {
+        while (dma_channel_is_busy(g_dma_chan)) {
+            // 第 0 行之前的标志来自同一次场同步的后续脉冲，忽略
+            // 信号在帧中间消失时 DMA 不会完成，由重新对齐请求放弃本帧
+            if ((g_vsync && line > 0) || g_resync_pending) {
+                dma_channel_abort(g_dma_chan);
+                return false;
+            }
+        }
+
+        // 立即启动下一行，转换在 DMA 写下一行的同时进行
+        if (line + 1 < total) {
+            start_line_dma(g_raw_line[cur ^ 1]);
+        }
+
+        if (line == 0) {
+            // 已收到像素 => 场同步结束，此后的标志属于下一帧
+            g_vsync = false;
+            frame_start_us = time_us_32();
+        }
+
+        if (line >= g_timing.v_back_porch) {
+            uint row = V_OFFSET + line - g_timing.v_back_porch;
+            uint32_t t0 = cycle_count_now();
+            mvs_pixel_convert_line(frame_row(row), g_raw_line[cur], g_timing.h_active);
+            uint32_t cycles = cycle_count_now() - t0;
+            commit_row(row);
+
+            capture_stats_begin(&g_stats_seq);
+            capture_stats_record(&g_stats.convert_cycles, &g_stats.convert_cycles_min, &g_stats.convert_cycles_max,
+                                 &g_stats.convert_cycles_avg, cycles);
+            capture_stats_end(&g_stats_seq);
+        }
+        cur ^= 1;
+    }
+
+#if VIDEO_LINE_RACING
+    fill_black_rows(V_OFFSET + g_timing.v_active, FRAME_HEIGHT - V_OFFSET - g_timing.v_active);
+#endif
+
+    // 行周期 = 第 0 行结束到最后一行结束的时间 / 行数
+    uint32_t line_ns = 0;
+    if (total > 1) {
+        line_ns = ((time_us_32() - frame_start_us) * 1000u) / (total - 1);
+    }
+    uint32_t stall_bit = 1u << (PIO_FDEBUG_RXSTALL_LSB + g_sm);
+
+    capture_stats_begin(&g_stats_seq);
+    g_stats.frames_captured++;
+    capture_stats_record(&g_stats.line_period_ns, &g_stats.line_period_min_ns, &g_stats.line_period_max_ns,
+                         &g_stats.line_period_avg_ns, line_ns);
+    // RX FIFO 满导致 PIO 停顿 => 本帧丢失了像素
+    if (g_pio->fdebug & stall_bit) {
+        g_pio->fdebug = stall_bit;
+        g_stats.rx_overflows++;
+    }
+    capture_stats_end(&g_stats_seq);
+    return true;
+}
+
+// 重新对齐到下一个场同步: 重启状态机并清空行 DMA，GPIO、程序、DMA 通道和时序都不变
+static void resync_capture(void)
+{
+    g_resync_pending = false;
+    pio_sm_set_enabled(g_pio, g_sm, false);
+    reset_line_dma();
+    pio_sm_restart(g_pio, g_sm);
+    pio_sm_clear_fifos(g_pio, g_sm);
+    pio_sm_exec(g_pio, g_sm, pio_encode_jmp(g_offset));
+    pio_sm_put(g_pio, g_sm, g_pio_config);
+    pio_interrupt_clear(g_pio, 0);
+    g_vsync = false;
+
+    // 中断前后的间隔不计入帧周期
+    g_last_frame_us = 0;
+    capture_stats_begin(&g_stats_seq);
+    g_stats.resyncs++;
+    capture_stats_end(&g_stats_seq);
+
+    pio_sm_set_enabled(g_pio, g_sm, true);
+}
+
+void video_capture_request_resync(void)
+{
+    g_resync_pending = true;
+}
+
+bool video_capture_detect_timing(void)
+{
+    // MVS 时序由主机固定，只有 CSYNC 可用；采集窗口使用 video_config.h 中的值
+    printf("[capture] MVS timing fixed: h_bp=%u h_active=%u v_bp=%u v_active=%u\n", g_timing.h_back_porch,
+           g_timing.h_active, g_timing.v_back_porch, g_timing.v_active);
+    return false;
+}
+
+void video_capture_get_timing(video_timing_t *timing)
+{
+    *timing = g_timing;
+}
+
+void video_capture_init(uint active_height)
+{
+    // 初始化 GPIO 27-44 (CSYNC, PCLK, RGB555, SHADOW)
+    for (uint pin = PIN_MVS_BASE; pin < PIN_MVS_BASE + MVS_CAPTURE_PINS; pin++) {
+        gpio_init(pin);
+        gpio_set_dir(pin, GPIO_IN);
+        gpio_disable_pulls(pin);
+        gpio_set_input_hysteresis_enabled(pin, true);
+    }
+
+    mvs_pixel_init();
+    cycle_count_init();
+#if !VIDEO_LINE_RACING
+    g_write_idx = frame_manager_write_index();
+#endif
+
+    uint v_active = active_height < FRAME_HEIGHT - V_OFFSET ? active_height : FRAME_HEIGHT - V_OFFSET;
+    g_timing = (video_timing_t){
+        .h_back_porch = MVS_H_BACK_PORCH,
+        .h_active = FRAME_WIDTH,
+        .v_back_porch = MVS_V_BACK_PORCH,
+        .v_active = (uint16_t)v_active,
+    };
+    g_pio_config = ((uint32_t)(g_timing.h_active - 1) << 16) | ((uint32_t)(g_timing.h_back_porch - 1) << 8) |
+                   (uint32_t)(MVS_VSYNC_THRESHOLD - 1);
+
+    // 初始化 PIO: GP27-44 只能通过 GPIO BASE 16 访问，必须在加载程序之前设置
+    pio_set_gpio_base(g_pio, MVS_GPIO_BASE);
+    g_offset = pio_add_program(g_pio, &mvs_capture_program);
+    g_sm = pio_claim_unused_sm(g_pio, true);
+
+    pio_sm_config c = mvs_capture_program_get_default_config(g_offset);
+    sm_config_set_in_pins(&c, PIN_MVS_BASE);
+    sm_config_set_jmp_pin(&c, PIN_MVS_CSYNC);
+    sm_config_set_in_shift(&c, false, true, MVS_CAPTURE_PINS);
+    sm_config_set_out_shift(&c, true, false, 32);
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_RX);
+    pio_sm_init(g_pio, g_sm, g_offset, &c);
+    pio_sm_put(g_pio, g_sm, g_pio_config);
+
+    // 初始化 DMA: 每次触发传输一行原始数据
+    g_dma_chan = dma_claim_unused_channel(true);
+    dma_channel_config dc = dma_channel_get_default_config(g_dma_chan);
+    channel_config_set_transfer_data_size(&dc, DMA_SIZE_32);
+    channel_config_set_read_increment(&dc, false);
+    channel_config_set_write_increment(&dc, true);
+    channel_config_set_dreq(&dc, pio_get_dreq(g_pio, g_sm, false));
+    dma_channel_configure(g_dma_chan, &dc, g_raw_line[0], &g_pio->rxf[g_sm], g_timing.h_active, false);
+
+    memory_layout_note("mvs_raw_lines", g_raw_line, sizeof(g_raw_line));
+
+    // 场同步由 PIO IRQ 0 通知
+    pio_set_irq0_source_enabled(g_pio, pis_interrupt0, true);
+    irq_set_exclusive_handler(PIO1_IRQ_0, mvs_vsync_irq_handler);
+
+    printf("[capture] MVS engine: %u active lines, h_bp=%u v_bp=%u\n", g_timing.v_active, g_timing.h_back_porch,
+           g_timing.v_back_porch);
+}
+
+void video_capture_run(void)
+{
+    pio_interrupt_clear(g_pio, 0);
+    irq_set_enabled(PIO1_IRQ_0, true);
+    pio_sm_set_enabled(g_pio, g_sm, true);
+
+    while (1) {
+        // 等待场同步 (中途中断的帧已经看到了新的场同步，无需再等)
+        // 无信号时一直停在这里，但仍处理重新对齐请求 (重新对齐会清掉旧的场同步标志)
+        while (!g_vsync || g_resync_pending) {
+            if (g_resync_pending) {
+                resync_capture();
+            }
+#if MEM_BUS_PERF_REPORT
+            bus_perf_service();
+#endif
+            tight_loop_contents();
+        }
+
+        uint32_t now = time_us_32();
+        capture_stats_begin(&g_stats_seq);
+        g_stats.vsyncs++;
+        if (g_last_frame_us != 0) {
+            capture_stats_record(&g_stats.frame_period_us, &g_stats.frame_period_min_us, &g_stats.frame_period_max_us,
+                                 &g_stats.frame_period_avg_us, now - g_last_frame_us);
+        }
+        capture_stats_end(&g_stats_seq);
+        g_last_frame_us = now;
+
+#if MEM_BUS_PERF_REPORT
+        bus_perf_service();
+#endif
+
+        reset_line_dma();
+        if (capture_frame()) {
+#if !VIDEO_LINE_RACING
+            // 提交给显示端 (下一个输出 VSYNC 生效)，下一帧写入空闲缓冲区
+            g_write_idx = frame_manager_capture_done();
+#endif
+        } else if (g_resync_pending) {
+            // 帧中间信号消失: 丢弃半帧，回到循环开头重新对齐
+            capture_stats_begin(&g_stats_seq);
+            g_stats.frames_dropped++;
+            capture_stats_end(&g_stats_seq);
+        } else {
+            capture_stats_begin(&g_stats_seq);
+            g_stats.vsync_mid_capture++;
+            g_stats.frames_dropped++;
+            capture_stats_end(&g_stats_seq);
+        }
+    }
+}
+
+uint32_t video_capture_get_frame_count(void)
+{
+    return g_stats.frames_captured;
+}
+
+void video_capture_get_stats(video_capture_stats_t *stats)
+{
+    capture_stats_read(&g_stats, &g_stats_seq, stats);
+}
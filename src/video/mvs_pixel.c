@@ -0,0 +1,96 @@
+#include "mvs_pixel.h"
+
+// 每个颜色通道的最高位接在最低的 GPIO 上 (B4 在 bit 2)，需要反转位序
+#define MVS_CHANNEL_MSB_FIRST 1
+
+// SHADOW 高电平有效: 三个通道亮度减半
+#define MVS_SHADOW_ACTIVE_HIGH 1
+
+// 查找表索引: 蓝 (bit 0-4) + 绿 (bit 5-9) + SHADOW (bit 10)
+#define LUT_BG_SIZE 2048
+// 查找表索引: 红 (bit 0-4) + SHADOW (bit 5)
+#define LUT_R_SIZE 64
+
+static uint16_t g_lut_bg[LUT_BG_SIZE];
+static uint16_t g_lut_r[LUT_R_SIZE];
+
+static uint32_t channel_value(uint32_t bits)
+{
+#if MVS_CHANNEL_MSB_FIRST
+    uint32_t v = 0;
+    for (int i = 0; i < 5; i++) {
+        v = (v << 1) | ((bits >> i) & 1);
+    }
+    return v;
+#else
+    return bits & 0x1F;
+#endif
+}
+
+static int shadow_active(uint32_t bit)
+{
+#if MVS_SHADOW_ACTIVE_HIGH
+    return bit != 0;
+#else
+    return bit == 0;
+#endif
+}
+
+void mvs_pixel_init(void)
+{
+    for (uint32_t i = 0; i < LUT_BG_SIZE; i++) {
+        uint32_t b5 = channel_value(i & 0x1F);
+        uint32_t g5 = channel_value((i >> 5) & 0x1F);
+        // 5 位扩展到 6 位: 高位复制到最低位，保证 31 -> 63
+        uint32_t g6 = (g5 << 1) | (g5 >> 4);
+        if (shadow_active(i >> 10)) {
+            b5 >>= 1;
+            g6 >>= 1;
+        }
+        g_lut_bg[i] = (uint16_t)((g6 << 5) | b5);
+    }
+
+    for (uint32_t i = 0; i < LUT_R_SIZE; i++) {
+        uint32_t r5 = channel_value(i & 0x1F);
+        if (shadow_active(i >> 5)) {
+            r5 >>= 1;
+        }
+        g_lut_r[i] = (uint16_t)(r5 << 11);
+    }
+}
+
+// 从原始采集字取出两个查找表索引
+// 蓝+绿正好是 bit 2-11，SHADOW (bit 17) 右移 7 位落在索引 bit 10
+// 红+SHADOW 是连续的 bit 12-17
+static inline uint32_t lut_bg_index(uint32_t raw)
+{
+    return ((raw >> MVS_RAW_BLUE_SHIFT) & 0x3FF) | ((raw >> (MVS_RAW_SHADOW_BIT - 10)) & 0x400);
+}
+
+static inline uint32_t lut_r_index(uint32_t raw)
+{
+    return (raw >> MVS_RAW_RED_SHIFT) & 0x3F;
+}
+
+uint16_t mvs_pixel_convert(uint32_t raw)
+{
+    return g_lut_bg[lut_bg_index(raw)] | g_lut_r[lut_r_index(raw)];
+}
+
+void mvs_pixel_convert_line(uint16_t *dst, const uint32_t *raw, uint32_t count)
+{
+    const uint16_t *lut_bg = g_lut_bg;
+    const uint16_t *lut_r = g_lut_r;
+
+    // 每次处理两个像素，减少循环开销并让加载可以重叠
+    uint32_t i = 0;
+    for (; i + 1 < count; i += 2) {
+        uint32_t p0 = raw[i];
+        uint32_t p1 = raw[i + 1];
+        dst[i] = lut_bg[lut_bg_index(p0)] | lut_r[lut_r_index(p0)];
+        dst[i + 1] = lut_bg[lut_bg_index(p1)] | lut_r[lut_r_index(p1)];
+    }
+    if (i < count) {
+        dst[i] = lut_bg[lut_bg_index(raw[i])] | lut_r[lut_r_index(raw[i])];
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef MVS_PIXEL_H
+#define MVS_PIXEL_H
+
+#include <stdint.h>
+
+// Field positions in the 18-bit word captured from GP27-44 (see mvs_pins.h)
+#define MVS_RAW_CSYNC_BIT 0
+#define MVS_RAW_PCLK_BIT 1
+#define MVS_RAW_BLUE_SHIFT 2
+#define MVS_RAW_GREEN_SHIFT 7
+#define MVS_RAW_RED_SHIFT 12
+#define MVS_RAW_SHADOW_BIT 17
+
+/**
+ * Build the conversion tables. Must be called once before converting.
+ *
+ * Two tables cover every input combination so the per-pixel work is two
+ * loads and an OR, with no branches:
+ *  - blue + green + SHADOW (11 bits, 2048 entries) -> RGB565 G and B fields
+ *  - red + SHADOW (6 bits, 64 entries)             -> RGB565 R field
+ * Channel bit reversal (the MSB of each channel is wired to the lowest GPIO),
+ * green 5 -> 6 bit expansion and SHADOW dimming are all folded in here.
+ *
+ * Kept free of SDK dependencies so the kernel can be checked on a host.
+ */
+void mvs_pixel_init(void);
+
+/**
+ * Convert one raw capture word to RGB565 (reference path, uses the tables).
+ */
+uint16_t mvs_pixel_convert(uint32_t raw);
+
+/**
+ * Convert a line of raw capture words (one 18-bit sample per word) to RGB565.
+ */
+void mvs_pixel_convert_line(uint16_t *dst, const uint32_t *raw, uint32_t count);
+
+#endif // MVS_PIXEL_H
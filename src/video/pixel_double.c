@@ -0,0 +1,70 @@
+#include "pixel_double.h"
+#include "hardware/dma.h"
+#include "hardware/pio.h"
+#include "video_config.h"
+#include "pixel_double.pio.h"
+
+// 选择采集引擎不使用的 PIO
+#if VIDEO_INPUT_MVS
+#define PIXEL_DOUBLE_PIO pio0
+#else
+#define PIXEL_DOUBLE_PIO pio1
+#endif
+
+static PIO g_pio = PIXEL_DOUBLE_PIO;
+static uint g_sm = 0;
+static int g_feed_chan = -1;  // 源行 (16 位) -> PIO TX FIFO
+static int g_drain_chan = -1; // PIO RX FIFO -> 扫描线 (32 位)
+
+bool pixel_double_init(void)
+{
+    if (!pio_can_add_program(g_pio, &pixel_double_program)) {
+        return false;
+    }
+    int sm = pio_claim_unused_sm(g_pio, false);
+    if (sm < 0) {
+        return false;
+    }
+    g_sm = (uint)sm;
+    uint offset = pio_add_program(g_pio, &pixel_double_program);
+
+    pio_sm_config c = pixel_double_program_get_default_config(offset);
+    sm_config_set_out_shift(&c, true, true, 32);
+    sm_config_set_in_shift(&c, false, false, 32);
+    pio_sm_init(g_pio, g_sm, offset, &c);
+    pio_sm_set_enabled(g_pio, g_sm, true);
+
+    g_feed_chan = dma_claim_unused_channel(true);
+    g_drain_chan = dma_claim_unused_channel(true);
+
+    // 16 位写入 TX FIFO: 半字被复制到 32 位的高低两半
+    dma_channel_config feed = dma_channel_get_default_config(g_feed_chan);
+    channel_config_set_transfer_data_size(&feed, DMA_SIZE_16);
+    channel_config_set_read_increment(&feed, true);
+    channel_config_set_write_increment(&feed, false);
+    channel_config_set_dreq(&feed, pio_get_dreq(g_pio, g_sm, true));
+    dma_channel_configure(g_feed_chan, &feed, &g_pio->txf[g_sm], NULL, FRAME_WIDTH, false);
+
+    dma_channel_config drain = dma_channel_get_default_config(g_drain_chan);
+    channel_config_set_transfer_data_size(&drain, DMA_SIZE_32);
+    channel_config_set_read_increment(&drain, false);
+    channel_config_set_write_increment(&drain, true);
+    channel_config_set_dreq(&drain, pio_get_dreq(g_pio, g_sm, false));
+    // 扫描线输出有时限，优先于采集等其他 DMA
+    channel_config_set_high_priority(&drain, true);
+    dma_channel_configure(g_drain_chan, &drain, NULL, &g_pio->rxf[g_sm], FRAME_WIDTH, false);
+
+    return true;
+}
+
+void pixel_double_start(uint32_t *dst, const uint16_t *src, uint32_t width)
+{
+    // 先启动输出通道，再喂数据
+    dma_channel_transfer_to_buffer_now(g_drain_chan, dst, width);
+    dma_channel_transfer_from_buffer_now(g_feed_chan, src, width);
+}
+
+void pixel_double_wait(void)
+{
+    dma_channel_wait_for_finish_blocking(g_drain_chan);
+}
@@ -0,0 +1,33 @@
+#ifndef PIXEL_DOUBLE_H
+#define PIXEL_DOUBLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Hardware horizontal pixel doubling (VIDEO_HW_PIXEL_DOUBLE).
+ *
+ * A DMA channel reads the RGB565 source row as halfwords and writes them to
+ * the TX FIFO of a spare PIO state machine. Narrow DMA writes are replicated
+ * across the 32-bit bus, so each FIFO word is already P | P << 16. The state
+ * machine moves the words to its RX FIFO, and a second DMA channel writes
+ * them into the scanline buffer. No CPU pixel loop is involved.
+ *
+ * Uses a PIO block the capture engine does not use (pio0 for MVS, pio1 for
+ * LCD), so it survives the LCD engine clearing pio0 and does not block the
+ * MVS engine from setting pio1's GPIO base.
+ */
+bool pixel_double_init(void);
+
+/**
+ * Start doubling width source pixels into width 32-bit words at dst.
+ * Returns immediately; the previous transfer must have finished.
+ */
+void pixel_double_start(uint32_t *dst, const uint16_t *src, uint32_t width);
+
+/**
+ * Wait for the current transfer to land in dst.
+ */
+void pixel_double_wait(void);
+
+#endif // PIXEL_DOUBLE_H
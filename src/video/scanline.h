@@ -0,0 +1,47 @@
+#ifndef SCANLINE_H
+#define SCANLINE_H
+
+#include <stdint.h>
+
+// Scanline kernels for the HSTX output path (Core 1).
+//
+// Output lines are written as 32-bit words, each holding one source RGB565
+// pixel twice (low half = left output pixel, high half = right). Header-only
+// so they inline into the RAM-resident scanline callback, and free of SDK
+// dependencies so they can also be compiled on a host.
+
+/**
+ * Horizontally double a line of RGB565 pixels: dst[i] = src[i] | src[i] << 16.
+ */
+static inline __attribute__((always_inline)) void scanline_double(uint32_t *dst, const uint16_t *src, uint32_t width)
+{
+    // Two source pixels per 32-bit load when src is word aligned
+    uint32_t i = 0;
+    if (((uintptr_t)src & 3) == 0) {
+        const uint32_t *src32 = (const uint32_t *)src;
+        for (; i + 1 < width; i += 2) {
+            uint32_t pair = src32[i >> 1];
+            uint32_t p0 = pair & 0xFFFF;
+            uint32_t p1 = pair >> 16;
+            dst[i] = p0 | (p0 << 16);
+            dst[i + 1] = p1 | (p1 << 16);
+        }
+    }
+    for (; i < width; i++) {
+        uint32_t p = src[i];
+        dst[i] = p | (p << 16);
+    }
+}
+
+/**
+ * Fill a line with one RGB565 colour (words = output pixels / 2).
+ */
+static inline __attribute__((always_inline)) void scanline_fill(uint32_t *dst, uint16_t color, uint32_t words)
+{
+    uint32_t c = (uint32_t)color | ((uint32_t)color << 16);
+    for (uint32_t i = 0; i < words; i++) {
+        dst[i] = c;
+    }
+}
+
+#endif // SCANLINE_H
@@ -4,11 +4,14 @@
 #include <stdint.h>
 #include "video_config.h"
 
-// 定义双缓冲：2帧 * 320像素 * 240行 * 2字节(RGB565) = 约300KB RAM
-// RP2350B 有 520KB RAM，完全够用
-extern uint16_t g_frame_buf[2][FRAME_WIDTH * FRAME_HEIGHT];
-
-// 指向当前主要用于显示的缓冲区索引 (0 或 1)
-extern volatile int g_display_idx;
+#if VIDEO_LINE_RACING
+// 追线模式: 采集逐行提交到 256 行环形缓冲 (约 160KB)，不分配整帧缓冲
+#include "line_ring.h"
+#else
+// 三缓冲：3帧 * 320像素 * 240行 * 2字节(RGB565) = 450KB RAM
+// 归属 (写入 / 待显示 / 显示) 由 frame_manager 管理，只在输出 VSYNC 切换
+#include "frame_manager.h"
+extern uint16_t g_frame_buf[FRAME_BUFFER_COUNT][FRAME_WIDTH * FRAME_HEIGHT];
+#endif
 
 #endif
@@ -3,23 +3,314 @@
 #include "hardware/dma.h"
 #include "hardware/irq.h"
 #include "hardware/pio.h"
+#include "hardware/sync.h"
 #include "video_buffers.h"
 #include "video_capture.pio.h"
+#include "video_timing.pio.h"
 #include "hardware_config.h"
+#include "capture_chain.h"
+#include "capture_stats.h"
+#include "video_timing.h"
+#include "memory_layout.h"
+#include "bus_perf.h"
+#include <stdio.h>
+
+// 采集完成中断使用 DMA_IRQ_1 (DMA_IRQ_0 留给 HSTX 输出)
+#define CAPTURE_DMA_IRQ_INDEX 1
 
 static PIO g_pio = pio0;
-static uint g_sm = 0;
+static uint g_sm = 0;       // 像素状态机
+static uint g_frame_sm = 0; // 帧状态机 (跳过场消隐，放行有效行)
 static uint g_offset = 0;
-static int  g_dma_chan = -1;
-// 将 DMA 配置保存为全局变量
-static dma_channel_config g_dma_config; 
+static uint g_frame_offset = 0;
+
+// 两个采集程序占用了 pio0 的大部分指令空间，时序测量借用 pio1
+static PIO g_timing_pio = pio1;
+static int  g_dma_chan = -1;  // 数据通道: PIO RX FIFO -> 行缓冲区
+static int  g_ctrl_chan = -1; // 控制通道: 控制块列表 -> 数据通道 WRITE_ADDR_TRIG
+
+// 每个帧缓冲区一份控制块列表 (有效行 + NULL，消隐行由 PIO 跳过)
+// 追线模式只用 g_chain[0]，有效行地址每帧随环形缓冲位置重建
+#if VIDEO_LINE_RACING
+#define CAPTURE_CHAIN_COUNT 1
+#else
+#define CAPTURE_CHAIN_COUNT FRAME_BUFFER_COUNT
+#endif
+static uintptr_t g_chain[CAPTURE_CHAIN_COUNT][CAPTURE_CHAIN_MAX_BLOCKS];
+
+// 当前采集时序，以及对应的 PIO 配置字 (启动时装入各状态机的 X)
+// 像素: (像素对数 - 1) << 16 | (行消隐 - 1)
+// 帧:   (有效行数 - 1) << 16 | (场消隐 - 1)
+static video_timing_t g_timing;
+static uint32_t g_pio_config = 0;
+static uint32_t g_frame_config = 0;
+static uint16_t g_max_active_lines = FRAME_HEIGHT;
+
+// 上次识别到的时序，放在不初始化的 RAM 中，热复位后无信号时仍可沿用
+#define TIMING_CACHE_MAGIC 0x54494D31u // "TIM1"
+typedef struct {
+    uint32_t magic;
+    video_timing_t timing;
+    uint32_t check;
+} timing_cache_t;
+static timing_cache_t __uninitialized_ram(g_timing_cache);
+
+// 时序测量参数
+#define TIMING_H_SAMPLES 16
+#define TIMING_V_SAMPLES 4
+#define TIMING_H_TIMEOUT_US 100000
+#define TIMING_V_TIMEOUT_US 150000
+
+// 当前正在写入的缓冲区, 以及控制链是否在运行
+static volatile int g_write_idx = 0;
+static volatile bool g_capture_busy = false;
+
+// Core 1 (信号锁定管理) 请求重新对齐，由 Core 0 采集循环执行
+static volatile bool g_resync_pending = false;
+
+// 采集统计: 只在 Core 0 中断里写，g_stats_seq 为奇数时表示正在更新
+static video_capture_stats_t g_stats;
+static volatile uint32_t g_stats_seq = 0;
+static uint32_t g_last_vsync_us = 0;
+static uint32_t g_capture_start_us = 0;
+
+// 停止正在运行的控制链 (不产生完成中断)
+static void abort_capture_chain(void)
+{
+    dma_irqn_set_channel_enabled(CAPTURE_DMA_IRQ_INDEX, g_dma_chan, false);
+    dma_channel_abort(g_ctrl_chan);
+    dma_channel_abort(g_dma_chan);
+    dma_irqn_acknowledge_channel(CAPTURE_DMA_IRQ_INDEX, g_dma_chan);
+    dma_irqn_set_channel_enabled(CAPTURE_DMA_IRQ_INDEX, g_dma_chan, true);
+}
+
+// 帧开始中断 (帧状态机 IRQ 0): 装好本帧的控制链
+// 状态机一直运行，此时处于场消隐期间，像素状态机不会推送数据
+static void frame_start_irq_handler(void)
+{
+    pio_interrupt_clear(g_pio, 0);
+
+    uint32_t now = time_us_32();
+
+    capture_stats_begin(&g_stats_seq);
+    g_stats.vsyncs++;
+    if (g_last_vsync_us != 0) {
+        capture_stats_record(&g_stats.frame_period_us, &g_stats.frame_period_min_us, &g_stats.frame_period_max_us,
+                             &g_stats.frame_period_avg_us, now - g_last_vsync_us);
+    }
+    g_last_vsync_us = now;
+
+    // 上一帧还在采集中: 输入时序异常，丢弃这半帧并从本次 VSYNC 重新开始
+    if (g_capture_busy) {
+        abort_capture_chain();
+        // 丢掉残留的半行，让下一帧从行头对齐
+        while (!pio_sm_is_rx_fifo_empty(g_pio, g_sm)) {
+            (void)pio_sm_get(g_pio, g_sm);
+        }
+        g_stats.vsync_mid_capture++;
+        g_stats.frames_dropped++;
+    }
+    capture_stats_end(&g_stats_seq);
+
+    g_capture_busy = true;
+    g_capture_start_us = now;
+
+#if VIDEO_LINE_RACING
+    // 新的一帧从环形缓冲当前写位置开始
+    line_ring_vsync();
+    for (uint line = 0; line < g_timing.v_active; line++) {
+        g_chain[0][line] = (uintptr_t)line_ring_write_ptr(line);
+    }
+    dma_channel_set_read_addr(g_ctrl_chan, g_chain[0], true);
+#else
+    // 控制通道读入第一个控制块后，剩余的行全部由 DMA 自行完成
+    dma_channel_set_read_addr(g_ctrl_chan, g_chain[g_write_idx], true);
+#endif
+}
+
+// 整帧完成中断: 由控制链末尾的 NULL 触发，每帧只进入一次
+static void capture_dma_irq_handler(void)
+{
+    if (!dma_irqn_get_channel_status(CAPTURE_DMA_IRQ_INDEX, g_dma_chan)) {
+        return;
+    }
+    dma_irqn_acknowledge_channel(CAPTURE_DMA_IRQ_INDEX, g_dma_chan);
+
+    // 行周期 = 本帧采集耗时 / 采集行数 (含消隐行)
+    uint32_t elapsed_us = time_us_32() - g_capture_start_us;
+    uint32_t line_ns = (elapsed_us * 1000u) / (g_timing.v_back_porch + g_timing.v_active);
+    uint32_t stall_bit = 1u << (PIO_FDEBUG_RXSTALL_LSB + g_sm);
+
+    capture_stats_begin(&g_stats_seq);
+    g_stats.frames_captured++;
+    capture_stats_record(&g_stats.line_period_ns, &g_stats.line_period_min_ns, &g_stats.line_period_max_ns,
+                         &g_stats.line_period_avg_ns, line_ns);
+    // RX FIFO 满导致 PIO 停顿 => 本帧丢失了像素
+    if (g_pio->fdebug & stall_bit) {
+        g_pio->fdebug = stall_bit;
+        g_stats.rx_overflows++;
+    }
+    capture_stats_end(&g_stats_seq);
+
+#if VIDEO_LINE_RACING
+    line_ring_commit(g_timing.v_active);
+#else
+    // 提交给显示端 (下一个输出 VSYNC 生效)，下一帧写入空闲缓冲区
+    g_write_idx = frame_manager_capture_done();
+#endif
+    g_capture_busy = false;
+}
+
+#if VIDEO_LINE_RACING
+// 追线模式: 根据控制通道的读指针推算已完成的有效行，并逐行提交给 Core 1
+static void commit_completed_lines(void)
+{
+    // 关中断，避免与 VSYNC / 完成中断交错导致提交到错误的帧
+    uint32_t irq_state = save_and_disable_interrupts();
+    if (!g_capture_busy) {
+        restore_interrupts(irq_state);
+        return;
+    }
+
+    // 控制通道已写出第 n 个控制块 => 第 n 行正在传输，之前的行已完成
+    uint32_t read_addr = dma_hw->ch[g_ctrl_chan].read_addr;
+    uint32_t issued = (read_addr - (uint32_t)(uintptr_t)g_chain[0]) / sizeof(uintptr_t);
+    if (issued > 1u) {
+        uint32_t done = issued - 1;
+        if (done > g_timing.v_active) {
+            done = g_timing.v_active;
+        }
+        if (g_line_ring.frame_base_idx + done > g_line_ring.write_idx) {
+            line_ring_commit((uint16_t)done);
+        }
+    }
+    restore_interrupts(irq_state);
+}
+#endif
+
+// 按时序重建控制块列表、DMA 行长度和 PIO 配置字 (仅在采集停止时调用)
+static void apply_timing(const video_timing_t *t)
+{
+    g_timing = *t;
+    // 每个 FIFO 字两个像素: 有效宽度取偶数
+    g_timing.h_active &= ~1u;
+    g_pio_config = ((uint32_t)(g_timing.h_active / 2 - 1) << 16) | (uint32_t)(t->h_back_porch - 1);
+    g_frame_config = ((uint32_t)(t->v_active - 1) << 16) | (uint32_t)(t->v_back_porch - 1);
+
+    // 场消隐行由帧状态机跳过，控制链只包含有效行
+#if VIDEO_LINE_RACING
+    // 有效行地址在每帧开始时按环形缓冲位置填写
+    capture_chain_build(g_chain[0], g_line_ring.lines[0], t->v_active, LINE_WIDTH);
+#else
+    // 每个缓冲区各一份，运行时不再修改
+    for (int i = 0; i < FRAME_BUFFER_COUNT; i++) {
+        capture_chain_build(g_chain[i], g_frame_buf[i], t->v_active, FRAME_WIDTH);
+    }
+#endif
+
+    // TRANS_COUNT 在每次触发时重新装载为每行像素数
+    dma_channel_set_trans_count(g_dma_chan, g_timing.h_active / 2, false);
+}
+
+static uint32_t timing_cache_checksum(const video_timing_t *t)
+{
+    const uint16_t *w = (const uint16_t *)t;
+    uint32_t sum = TIMING_CACHE_MAGIC;
+    for (uint i = 0; i < sizeof(*t) / sizeof(uint16_t); i++) {
+        sum = (sum << 5) + sum + w[i];
+    }
+    return sum;
+}
+
+static bool timing_cache_valid(void)
+{
+    return g_timing_cache.magic == TIMING_CACHE_MAGIC &&
+           g_timing_cache.check == timing_cache_checksum(&g_timing_cache.timing);
+}
+
+// 用测量状态机记录若干个同步周期 (脉冲宽度, 周期)，返回实际记录的个数
+static uint measure_sync(uint sm, uint offset, uint sync_pin, uint clk_pin, video_timing_sample_t *samples,
+                         uint count, uint32_t timeout_us)
+{
+    pio_sm_config c = video_timing_program_get_default_config(offset);
+    sm_config_set_in_pins(&c, clk_pin);
+    sm_config_set_jmp_pin(&c, sync_pin);
+    sm_config_set_in_shift(&c, false, true, 32);
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_RX);
+    pio_sm_init(g_timing_pio, sm, offset, &c);
+    pio_sm_set_enabled(g_timing_pio, sm, true);
 
-// 帧同步标志
-static volatile bool g_vsync_detected = false;
+    uint64_t deadline = time_us_64() + timeout_us;
+    uint n = 0;
+    uint32_t pulse = 0;
+    bool have_pulse = false;
 
-// VSYNC 中断
-static void vsync_irq_handler(uint gpio, uint32_t events) {
-    g_vsync_detected = true;
+    while (n < count && time_us_64() < deadline) {
+        if (pio_sm_is_rx_fifo_empty(g_timing_pio, sm)) {
+            continue;
+        }
+        // 计数器从 0xFFFFFFFF 递减，取反即为时钟数
+        uint32_t clocks = ~pio_sm_get(g_timing_pio, sm);
+        if (!have_pulse) {
+            pulse = clocks;
+            have_pulse = true;
+        } else {
+            samples[n].pulse = pulse;
+            samples[n].period = clocks;
+            n++;
+            have_pulse = false;
+        }
+    }
+
+    pio_sm_set_enabled(g_timing_pio, sm, false);
+    return n;
+}
+
+bool video_capture_detect_timing(void)
+{
+    video_timing_t defaults = {
+        .h_back_porch = H_BACK_PORCH,
+        .h_active = FRAME_WIDTH,
+        .v_back_porch = V_BACK_PORCH,
+        .v_active = g_max_active_lines,
+    };
+
+    video_timing_sample_t h[TIMING_H_SAMPLES];
+    video_timing_sample_t v[TIMING_V_SAMPLES];
+
+    // 借用一个空闲状态机，测量完成后释放
+    uint sm = (uint)pio_claim_unused_sm(g_timing_pio, true);
+    uint offset = pio_add_program(g_timing_pio, &video_timing_program);
+    uint h_count = measure_sync(sm, offset, PIN_HSYNC, PIN_PCLK, h, TIMING_H_SAMPLES, TIMING_H_TIMEOUT_US);
+    uint v_count = measure_sync(sm, offset, PIN_VSYNC, PIN_HSYNC, v, TIMING_V_SAMPLES, TIMING_V_TIMEOUT_US);
+    pio_remove_program(g_timing_pio, &video_timing_program, offset);
+    pio_sm_unclaim(g_timing_pio, sm);
+
+    // 帧状态机按 "行数 - 1" 计数，场消隐至少一行
+    video_timing_t detected;
+    if (video_timing_detect(h, h_count, v, v_count, &defaults, &detected) && detected.v_back_porch >= 1) {
+        g_timing_cache.magic = TIMING_CACHE_MAGIC;
+        g_timing_cache.timing = detected;
+        g_timing_cache.check = timing_cache_checksum(&detected);
+        printf("[capture] timing detected: H %u (sync %u, bp %u, active %u) V %u (sync %u, bp %u, active %u)\n",
+               detected.h_total, detected.h_sync, detected.h_back_porch, detected.h_active, detected.v_total,
+               detected.v_sync, detected.v_back_porch, detected.v_active);
+        apply_timing(&detected);
+        return true;
+    }
+
+    if (timing_cache_valid()) {
+        printf("[capture] timing detection failed (%u/%u samples), using cached timing\n", h_count, v_count);
+        apply_timing(&g_timing_cache.timing);
+    } else {
+        printf("[capture] timing detection failed (%u/%u samples), using defaults\n", h_count, v_count);
+    }
+    return false;
+}
+
+void video_capture_get_timing(video_timing_t *timing)
+{
+    *timing = g_timing;
 }
 
 void video_capture_init(uint active_height)
@@ -28,7 +319,7 @@ void video_capture_init(uint active_height)
     gpio_init(PIN_HSYNC); gpio_set_dir(PIN_HSYNC, GPIO_IN);
     gpio_init(PIN_VSYNC); gpio_set_dir(PIN_VSYNC, GPIO_IN);
     gpio_init(PIN_PCLK);  gpio_set_dir(PIN_PCLK, GPIO_IN);
-    
+
     for(int i=0; i<PIN_RGB_COUNT; i++) {
         gpio_init(PIN_RGB_BASE + i);
         gpio_set_dir(PIN_RGB_BASE + i, GPIO_IN);
@@ -36,90 +327,181 @@ void video_capture_init(uint active_height)
         gpio_set_input_hysteresis_enabled(PIN_RGB_BASE + i, true);
     }
 
-    gpio_set_irq_enabled_with_callback(PIN_VSYNC, GPIO_IRQ_EDGE_FALL, true, &vsync_irq_handler);
-
     // 2. PIO 初始化
     pio_clear_instruction_memory(g_pio);
     g_offset = pio_add_program(g_pio, &video_capture_program);
     g_sm = pio_claim_unused_sm(g_pio, true);
     pio_sm_config c = video_capture_program_get_default_config(g_offset);
     sm_config_set_in_pins(&c, PIN_RGB_BASE);
-    sm_config_set_in_shift(&c, false, true, 16); 
+    sm_config_set_in_shift(&c, true, true, 32); // 两个像素一个字，先采的在低位
+    sm_config_set_out_shift(&c, true, false, 32); // 配置字从低位开始取
     pio_sm_init(g_pio, g_sm, g_offset, &c);
-    pio_sm_set_enabled(g_pio, g_sm, true);
 
-    // 3. DMA 初始化
+    // 帧状态机: 只读 VSYNC / HSYNC (wait gpio)，不推送数据
+    g_frame_offset = pio_add_program(g_pio, &video_frame_program);
+    g_frame_sm = pio_claim_unused_sm(g_pio, true);
+    pio_sm_config fc = video_frame_program_get_default_config(g_frame_offset);
+    sm_config_set_out_shift(&fc, true, false, 32);
+    pio_sm_init(g_pio, g_frame_sm, g_frame_offset, &fc);
+
+    // 3. 数据通道: 每次触发搬运一行，完成后链接到控制通道
     g_dma_chan = dma_claim_unused_channel(true);
-    g_dma_config = dma_channel_get_default_config(g_dma_chan);
-    channel_config_set_transfer_data_size(&g_dma_config, DMA_SIZE_16);
-    channel_config_set_read_increment(&g_dma_config, false); // 读 PIO 不自增
-    channel_config_set_write_increment(&g_dma_config, true); // 写内存自增
-    channel_config_set_dreq(&g_dma_config, pio_get_dreq(g_pio, g_sm, false));
-    
-    // 预先配置一次（但不启动），确保状态正确
+    g_ctrl_chan = dma_claim_unused_channel(true);
+
+    dma_channel_config data_cfg = dma_channel_get_default_config(g_dma_chan);
+    channel_config_set_transfer_data_size(&data_cfg, DMA_SIZE_32); // 每次两个像素
+    channel_config_set_read_increment(&data_cfg, false); // 读 PIO 不自增
+    channel_config_set_write_increment(&data_cfg, true); // 写内存自增
+    channel_config_set_dreq(&data_cfg, pio_get_dreq(g_pio, g_sm, false));
+    channel_config_set_chain_to(&data_cfg, g_ctrl_chan);
+    // 只在 NULL 触发时产生中断，而不是每行一次
+    channel_config_set_irq_quiet(&data_cfg, true);
+
+    // 预先配置（但不启动）: TRANS_COUNT 每次触发时重新装载为每行的字数 (像素数 / 2)
     dma_channel_configure(
-        g_dma_chan, 
-        &g_dma_config, 
-        NULL, 
-        &g_pio->rxf[g_sm], 
-        FRAME_WIDTH, 
+        g_dma_chan,
+        &data_cfg,
+        NULL,
+        &g_pio->rxf[g_sm],
+        FRAME_WIDTH / 2,
         false
     );
+
+    // 4. 控制通道: 每次把一个控制块写入数据通道的 WRITE_ADDR_TRIG
+    dma_channel_config ctrl_cfg = dma_channel_get_default_config(g_ctrl_chan);
+    channel_config_set_transfer_data_size(&ctrl_cfg, DMA_SIZE_32);
+    channel_config_set_read_increment(&ctrl_cfg, true);
+    channel_config_set_write_increment(&ctrl_cfg, false);
+
+    dma_channel_configure(
+        g_ctrl_chan,
+        &ctrl_cfg,
+        &dma_hw->ch[g_dma_chan].al2_write_addr_trig,
+        g_chain[0],
+        1,
+        false
+    );
+
+#if !VIDEO_LINE_RACING
+    g_write_idx = frame_manager_write_index();
+#endif
+
+    // 5. 整帧完成中断 + 帧开始中断 (帧状态机 IRQ 0)
+    dma_irqn_set_channel_enabled(CAPTURE_DMA_IRQ_INDEX, g_dma_chan, true);
+    irq_add_shared_handler(DMA_IRQ_1, capture_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
+    pio_set_irq0_source_enabled(g_pio, pis_interrupt0, true);
+    irq_set_exclusive_handler(PIO0_IRQ_0, frame_start_irq_handler);
+
+    // 6. 采集时序: 先用默认值，再尝试自动识别 (失败时沿用缓存)
+    g_max_active_lines = (uint16_t)(active_height < FRAME_HEIGHT ? active_height : FRAME_HEIGHT);
+    video_timing_t defaults = {
+        .h_back_porch = H_BACK_PORCH,
+        .h_active = FRAME_WIDTH,
+        .v_back_porch = V_BACK_PORCH,
+        .v_active = g_max_active_lines,
+    };
+    apply_timing(&defaults);
+#if VIDEO_TIMING_AUTODETECT
+    video_capture_detect_timing();
+#endif
+}
+
+// 把配置字装入状态机的 X (状态机停止时执行 pull + mov)
+static void load_sm_config(uint sm, uint32_t config)
+{
+    pio_sm_put(g_pio, sm, config);
+    pio_sm_exec(g_pio, sm, pio_encode_pull(false, false));
+    pio_sm_exec(g_pio, sm, pio_encode_mov(pio_x, pio_osr));
+}
+
+// 两个状态机同时启动 (状态机停止时调用)
+static void start_state_machines(void)
+{
+    load_sm_config(g_sm, g_pio_config);
+    load_sm_config(g_frame_sm, g_frame_config);
+    pio_interrupt_clear(g_pio, 0);
+    pio_interrupt_clear(g_pio, 4);
+    g_pio->fdebug = 1u << (PIO_FDEBUG_RXSTALL_LSB + g_sm);
+    irq_set_enabled(PIO0_IRQ_0, true);
+    pio_enable_sm_mask_in_sync(g_pio, (1u << g_sm) | (1u << g_frame_sm));
+}
+
+// 重新对齐到下一个 VSYNC: 停下状态机和控制链，从程序开头重新启动
+// 时序、控制块列表和 DMA 配置都不变
+static void resync_capture(void)
+{
+    uint32_t irq_state = save_and_disable_interrupts();
+    g_resync_pending = false;
+
+    irq_set_enabled(PIO0_IRQ_0, false);
+    pio_set_sm_mask_enabled(g_pio, (1u << g_sm) | (1u << g_frame_sm), false);
+    if (g_capture_busy) {
+        abort_capture_chain();
+        g_capture_busy = false;
+    }
+    pio_sm_restart(g_pio, g_sm);
+    pio_sm_restart(g_pio, g_frame_sm);
+    pio_sm_clear_fifos(g_pio, g_sm);
+    pio_sm_clear_fifos(g_pio, g_frame_sm);
+    pio_sm_exec(g_pio, g_sm, pio_encode_jmp(g_offset));
+    pio_sm_exec(g_pio, g_frame_sm, pio_encode_jmp(g_frame_offset));
+
+    // 中断前后的 VSYNC 间隔不计入帧周期
+    capture_stats_begin(&g_stats_seq);
+    g_stats.resyncs++;
+    capture_stats_end(&g_stats_seq);
+    g_last_vsync_us = 0;
+
+    start_state_machines();
+    restore_interrupts(irq_state);
+}
+
+void video_capture_request_resync(void)
+{
+    g_resync_pending = true;
+    // 唤醒在 __wfe() 中等待的 Core 0
+    __sev();
 }
 
 void video_capture_run(void)
 {
-    int write_idx = 0;
-    // 定义一个丢弃缓冲区，用于消耗掉 Back Porch 的数据
-    uint16_t discard_buffer[FRAME_WIDTH]; 
+    // 两个状态机同时启动并一直运行，只在重新对齐时重启
+    start_state_machines();
+
+    // 之后采集完全由帧开始中断 + DMA 控制链驱动
 
+#if VIDEO_LINE_RACING
+    // Core 0 只需把 DMA 进度逐行提交给输出端
     while (1) {
-        // 1. 等待 VSYNC
-        while (!g_vsync_detected) { tight_loop_contents(); }
-        g_vsync_detected = false;
-
-        write_idx = !write_idx; 
-
-        // 2. 重置 PIO (确保从行头开始)
-        pio_sm_set_enabled(g_pio, g_sm, false);
-        pio_sm_clear_fifos(g_pio, g_sm);
-        pio_sm_restart(g_pio, g_sm);
-        pio_sm_exec(g_pio, g_sm, pio_encode_jmp(g_offset));
-        pio_sm_set_enabled(g_pio, g_sm, true);
-
-        // 3. 跳过前 18 行 (Back Porch)
-        // 使用 DMA 快速读取并丢弃，防止 PIO FIFO 溢出
-        for (int i = 0; i < 18; i++) {
-             dma_channel_configure(
-                g_dma_chan, 
-                &g_dma_config, 
-                discard_buffer,    // 写入丢弃区
-                &g_pio->rxf[g_sm], // 读 PIO
-                FRAME_WIDTH,       // 长度
-                true               // 立即启动
-             );
-             dma_channel_wait_for_finish_blocking(g_dma_chan);
+        if (g_resync_pending) {
+            resync_capture();
         }
-
-        // 4. 采集有效画面 (240行)
-        // 直接写入当前帧缓冲区
-        uint16_t *base_ptr = g_frame_buf[write_idx];
-        
-        for (int line = 0; line < FRAME_HEIGHT; line++) {
-            dma_channel_configure(
-                g_dma_chan,
-                &g_dma_config,
-                base_ptr + (line * FRAME_WIDTH), // 写入显存位置
-                &g_pio->rxf[g_sm],
-                FRAME_WIDTH,
-                true // 立即启动
-            );
-            dma_channel_wait_for_finish_blocking(g_dma_chan);
+        commit_completed_lines();
+#if MEM_BUS_PERF_REPORT
+        bus_perf_service();
+#endif
+    }
+#else
+    // Core 0 不再参与逐行搬运，空闲时等待中断或 Core 1 的重新对齐请求
+    while (1) {
+        __wfe();
+        if (g_resync_pending) {
+            resync_capture();
         }
-
-        // 5. 提交给显示端
-        g_display_idx = write_idx;
+#if MEM_BUS_PERF_REPORT
+        bus_perf_service();
+#endif
     }
+#endif
+}
+
+uint32_t video_capture_get_frame_count(void)
+{
+    return g_stats.frames_captured;
 }
 
-uint32_t video_capture_get_frame_count(void) { return 0; }
+void video_capture_get_stats(video_capture_stats_t *stats)
+{
+    capture_stats_read(&g_stats, &g_stats_seq, stats);
+}
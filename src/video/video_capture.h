@@ -6,6 +6,39 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "video_timing.h"
+
+/**
+ * Capture statistics, updated from the VSYNC and frame-complete interrupts.
+ * Periods are measured with time_us_32(); averages are exponential (1/16).
+ */
+typedef struct {
+    uint32_t frames_captured;   // Frames fully written to a buffer
+    uint32_t frames_dropped;    // Partial frames abandoned because a new VSYNC arrived
+    uint32_t vsync_mid_capture; // VSYNCs that arrived while a frame was still being captured
+    uint32_t rx_overflows;      // Frames during which the PIO RX FIFO stalled (FDEBUG.RXSTALL)
+    uint32_t vsyncs;            // Input VSYNCs seen (signal presence)
+    uint32_t resyncs;           // Realignments done for video_capture_request_resync()
+
+    // Input frame period (VSYNC to VSYNC), microseconds
+    uint32_t frame_period_us;
+    uint32_t frame_period_min_us;
+    uint32_t frame_period_max_us;
+    uint32_t frame_period_avg_us;
+
+    // Input line period (capture time / captured lines), nanoseconds
+    uint32_t line_period_ns;
+    uint32_t line_period_min_ns;
+    uint32_t line_period_max_ns;
+    uint32_t line_period_avg_ns;
+
+    // CPU cycles spent converting one line to RGB565 (MVS engine only, 0 otherwise)
+    uint32_t convert_cycles;
+    uint32_t convert_cycles_min;
+    uint32_t convert_cycles_max;
+    uint32_t convert_cycles_avg;
+} video_capture_stats_t;
+
 /**
  * Initialize MVS video capture
  *
@@ -13,16 +46,55 @@
  */
 void video_capture_init(uint mvs_height);
 
+/**
+ * Measure the input sync timing with a spare PIO state machine and reprogram
+ * the capture window (PIO back porch / pixel count, DMA line count and
+ * skipped lines) to match. The result is printed and cached in RAM that
+ * survives a warm reset; if detection fails the cached timing (or the
+ * defaults from video_config.h) stays in effect.
+ * Called by video_capture_init() when VIDEO_TIMING_AUTODETECT is set; must
+ * not be called once video_capture_run() has started.
+ *
+ * @return true if the timing was measured from the live signal
+ */
+bool video_capture_detect_timing(void);
+
+/**
+ * Get the timing the capture engine is currently programmed with
+ */
+void video_capture_get_timing(video_timing_t *timing);
+
 /**
  * Run the video capture loop (never returns)
- * Captures lines into the global line ring buffer
- * Signals VSYNC to Core 1 at frame boundaries
+ * LCD engine: starts the pixel and frame state machines, which then run
+ * continuously. The frame state machine skips vertical blanking itself and
+ * raises a frame-start IRQ, where the chained DMA for the active lines
+ * (control channel reprogramming the data channel once per line) is armed.
+ * No per-line CPU work; the completion IRQ publishes the frame to Core 1.
+ * MVS engine: waits for the VSYNC pulse separated from CSYNC by the PIO,
+ * then ping-pongs raw lines through DMA and converts each one to RGB565
+ * while the next is being captured.
+ * Both engines carry out video_capture_request_resync() from this loop.
  */
 void video_capture_run(void);
 
+/**
+ * Ask the capture loop (Core 0) to realign to the next VSYNC: the PIO state
+ * machines are restarted and any half-captured frame is abandoned, while
+ * GPIO, DMA channels, buffers and the programmed timing stay as they are.
+ * The period across the gap is not recorded. Safe to call from Core 1.
+ */
+void video_capture_request_resync(void);
+
 /**
  * Get current frame count
  */
 uint32_t video_capture_get_frame_count(void);
 
+/**
+ * Take a consistent snapshot of the capture statistics.
+ * Lock-free (sequence counter), safe to call from Core 1.
+ */
+void video_capture_get_stats(video_capture_stats_t *stats);
+
 #endif // VIDEO_CAPTURE_H
@@ -5,8 +5,67 @@
 #define FRAME_WIDTH  320
 #define FRAME_HEIGHT 240
 
-// MVS/LCD 有效区域
+// HDMI 输出分辨率 (水平、垂直各倍增一次)
+#define OUTPUT_WIDTH  (FRAME_WIDTH * 2)
+#define OUTPUT_HEIGHT (FRAME_HEIGHT * 2)
+
+// 输出每帧总行数 (640x480@60: 480 有效行 + 45 行消隐)
+// 用于估计最后一个有效行之后到下一帧第 0 行回调的时间
+#define OUTPUT_V_TOTAL 525
+
+// 采集引擎 (由 CMake 的 NEOPICO_VIDEO_INPUT 设置):
+// 0 = LCD 面板总线 (分离同步, RGB565, video_capture.c)
+// 1 = MVS (CSYNC 复合同步, RGB555 + SHADOW, mvs_capture.c)
+#ifndef VIDEO_INPUT_MVS
+#define VIDEO_INPUT_MVS 0
+#endif
+
+// MVS/LCD 有效区域 (MVS 224 行居中放在 240 行的帧缓冲中)
+#if VIDEO_INPUT_MVS
+#define MVS_HEIGHT   224
+#define V_OFFSET     8
+#else
 #define MVS_HEIGHT   240
 #define V_OFFSET     0
+#endif
+
+// MVS 采集窗口 (固定时序，按主板实测微调)
+#define MVS_H_BACK_PORCH    28 // CSYNC 上升沿后丢弃的 PCLK 数
+#define MVS_V_BACK_PORCH    16 // 最后一个场同步脉冲后丢弃的行数
+#define MVS_VSYNC_THRESHOLD 64 // CSYNC 低电平超过此 PCLK 数判定为场同步
+
+// 输入时序默认值 (UMSH-8065MD-11T 手册)，均从同步下降沿开始计
+// 自动识别失败且没有缓存结果时使用
+#define H_BACK_PORCH 68 // HSYNC 下降沿后丢弃的 PCLK 数
+#define V_BACK_PORCH 18 // VSYNC 下降沿后丢弃的行数
+
+// 启动时用空闲 PIO 状态机测量输入时序，并据此设置采集窗口
+#ifndef VIDEO_TIMING_AUTODETECT
+#define VIDEO_TIMING_AUTODETECT 1
+#endif
+
+// 行缓存: 每个源行只倍增一次，第二个输出行由 DMA 从缓存复制
+// 设为 0 可与逐行倍增的 Core 1 负载对比 (video_pipeline_get_stats)
+#ifndef VIDEO_SCANLINE_CACHE
+#define VIDEO_SCANLINE_CACHE 1
+#endif
+
+// 硬件像素倍增: DMA 窄写入复制 + PIO 搬运，扫描线回调不做像素运算
+// 开启后不再使用行缓存 (两个输出行都直接由硬件生成)
+#ifndef VIDEO_HW_PIXEL_DOUBLE
+#define VIDEO_HW_PIXEL_DOUBLE 0
+#endif
+
+// 无输入信号时的画面颜色 (RGB565 蓝色)，信号锁定管理 (signal_lock.h) 选择蓝屏时使用
+#ifndef VIDEO_NO_SIGNAL_COLOR
+#define VIDEO_NO_SIGNAL_COLOR 0x001F
+#endif
+
+// 低延迟 "追线" 输出模式:
+// 0 = 三帧缓冲 (g_frame_buf, 输出 VSYNC 时切换, 最多一帧延迟)
+// 1 = 行环形缓冲 (g_line_ring, 输出紧跟输入几行, 不分配整帧缓冲)
+#ifndef VIDEO_LINE_RACING
+#define VIDEO_LINE_RACING 0
+#endif
 
 #endif // VIDEO_CONFIG_H
@@ -1,58 +1,288 @@
 #include "video_pipeline.h"
-#include <string.h>
 #include <stdint.h> // 关键修复：添加标准整数类型定义
 #include "pico.h"
 #include "pico/stdlib.h"
 #include "pico_hdmi/video_output.h"
 #include "video_config.h"
-#include "video_buffers.h" 
+#include "video_buffers.h"
+#include "scanline.h"
+#include "memory_layout.h"
+#include "cycle_count.h"
+#include "hardware/dma.h"
+#if VIDEO_HW_PIXEL_DOUBLE
+#include "pixel_double.h"
+#endif
 
-// 快速像素倍增函数 (内联优化)
-static inline void __attribute__((always_inline)) double_pixels_fast(uint32_t *dst, const uint16_t *src, int width)
+// 输出方式: 请求值随时可改，输出第 0 行时锁存，整帧内不变
+static volatile video_fallback_t g_fallback_request = VIDEO_FALLBACK_NONE;
+static video_fallback_t g_fallback = VIDEO_FALLBACK_NONE;
+
+#if VIDEO_LINE_RACING
+// 追线模式统计: 当前输出帧累计中，上一帧结果在输出 VSYNC 时锁存
+static video_pipeline_racing_stats_t g_racing_stats;
+static uint32_t g_frame_late_lines = 0;
+static uint32_t g_frame_overrun_lines = 0;
+
+// 上一次成功读取的源行，用于迟到/溢出时重复显示
+static const uint16_t *g_last_src_row = NULL;
+
+// 从行环形缓冲取源行，失败时回退到上一行 (没有上一行则返回 NULL 输出黑色)
+static inline const uint16_t *racing_get_src_row(uint32_t active_line, uint32_t y_src)
 {
-    // 输入 src 是 16位 (RGB565)
-    // 输出 dst 是 32位 (包含两个像素)
-    // 我们的目标是将 320 个像素扩展为 640 个像素。
-    
-    for (int i = 0; i < width; i++) {
-        uint32_t p = src[i];
-        // 将1个像素复制两遍，拼成一个32位整数 (低16位=P, 高16位=P)
-        dst[i] = (p << 16) | p;
+    // 输出帧开始: 锁存统计并对齐到当前输入帧
+    if (active_line == 0) {
+        g_racing_stats.last_frame_late_lines = g_frame_late_lines;
+        g_racing_stats.last_frame_overrun_lines = g_frame_overrun_lines;
+        g_racing_stats.frames++;
+        g_frame_late_lines = 0;
+        g_frame_overrun_lines = 0;
+        g_last_src_row = NULL;
+        // 保持画面时不跟随输入帧，继续读上一帧的行 (已被采集覆盖的行按溢出处理)
+        if (g_fallback != VIDEO_FALLBACK_HOLD) {
+            line_ring_output_vsync();
+        }
+    }
+
+    line_ring_state_t state = line_ring_state((uint16_t)y_src);
+    if (state == LINE_RING_READY) {
+        g_last_src_row = line_ring_read_ptr((uint16_t)y_src);
+        return g_last_src_row;
     }
+
+    // 每个源行输出两次，只在第一次时计数
+    if ((active_line & 1) == 0) {
+        if (state == LINE_RING_LATE) {
+            g_frame_late_lines++;
+            g_racing_stats.total_late_lines++;
+        } else {
+            g_frame_overrun_lines++;
+            g_racing_stats.total_overrun_lines++;
+        }
+    }
+    return g_last_src_row;
 }
 
-/**
- * 扫描线回调 - 由 HDMI 库 Core 1 调用
- * 签名匹配：void (*)(uint32_t, uint32_t, uint32_t *)
- */
-void __time_critical_func(video_pipeline_scanline_callback)(uint32_t v_scanline, uint32_t active_line, uint32_t *dst)
+void video_pipeline_get_racing_stats(video_pipeline_racing_stats_t *stats)
 {
-    (void)v_scanline;
+    *stats = g_racing_stats;
+}
+#else
+// 本输出帧扫描的源帧，只在输出第 0 行切换，整帧内不变
+static const uint16_t *g_scan_frame = NULL;
+#endif
+
+#if VIDEO_SCANLINE_CACHE && !VIDEO_HW_PIXEL_DOUBLE
+// 倍增后的源行。每个源行输出两次: 第一次展开到这里，两次都由 DMA 复制到 dst
+static uint32_t MEM_PLACE(MEM_LAYOUT_SCANLINE_CACHE, scanline_cache) g_line_cache[FRAME_WIDTH];
+static uint32_t g_cache_y = UINT32_MAX;
+static int g_copy_chan = -1;
+
+// 缓存 -> dst 复制一行 (READ_ADDR 每次复位，TRANS_COUNT 触发时自动重装)
+// HDMI 库没有说明回调返回后何时开始读取 dst，所以等复制完成再返回
+// (320 个字，约 320 个总线周期，比 CPU 倍增一行少得多)
+static inline void copy_from_cache(uint32_t *dst)
+{
+    dma_channel_set_read_addr(g_copy_chan, g_line_cache, false);
+    dma_channel_set_write_addr(g_copy_chan, dst, true);
+    dma_channel_wait_for_finish_blocking(g_copy_chan);
+}
+#endif
 
+// Core 1 负载统计: 当前输出帧累计中，输出第 0 行时锁存
+static video_pipeline_stats_t g_stats;
+static uint32_t g_frame_start_cycles = 0;
+static uint32_t g_frame_busy_cycles = 0;
+static uint32_t g_frame_line_max = 0;
+static uint32_t g_frame_cached_lines = 0;
+static bool g_cycle_count_ready = false;
+
+// 扫描线节拍 (Core 1 后台调度使用): 上一次回调的开始时刻和有效行号，
+// 以及相邻有效行回调间隔的平滑值 (行周期)
+static uint32_t g_line_start_cycles = 0;
+static uint32_t g_line_active = UINT32_MAX;
+static uint32_t g_line_period_cycles = 0;
+
+static inline void render_scanline(uint32_t active_line, uint32_t *dst)
+{
     // 1. 计算源行号 (320 -> 640, 所以除以 2)
     // 输入缓冲区是 240 行，输出是 480 行，所以除以 2
     uint32_t y_src = active_line >> 1;
 
     // 2. 边界检查
     if (y_src >= FRAME_HEIGHT) {
-        // 如果越界，输出黑色。注意 dst 是 32位指针，长度是 640/2 = 320 个字
-        memset(dst, 0, 640 * 2); 
+        // 如果越界，输出黑色。注意 dst 是 32位指针，每个字包含两个输出像素
+        scanline_fill(dst, 0, OUTPUT_WIDTH / 2);
         return;
     }
 
-    // 3. 从双缓冲读取
-    // 读取当前 Core 0 已经写好的那一帧 (g_display_idx)
-    const uint16_t *src_row = &g_frame_buf[g_display_idx][y_src * FRAME_WIDTH];
+    // 无信号: 整行填充蓝色，不读取源帧
+    if (g_fallback == VIDEO_FALLBACK_BLUE) {
+        scanline_fill(dst, VIDEO_NO_SIGNAL_COLOR, OUTPUT_WIDTH / 2);
+        return;
+    }
+
+#if VIDEO_SCANLINE_CACHE && !VIDEO_HW_PIXEL_DOUBLE
+    if (active_line == 0) {
+        g_cache_y = UINT32_MAX;
+    }
+    if (y_src == g_cache_y) {
+        // 第二次输出同一源行: 不做任何像素运算
+        copy_from_cache(dst);
+        g_frame_cached_lines++;
+        return;
+    }
+#endif
+
+#if VIDEO_LINE_RACING
+    // 3. 从行环形缓冲读取 (紧跟采集端几行)
+    const uint16_t *src_row = racing_get_src_row(active_line, y_src);
+    if (src_row == NULL) {
+        scanline_fill(dst, 0, OUTPUT_WIDTH / 2);
+        return;
+    }
+#else
+    // 3. 从三缓冲读取
+    // 输出帧开始时取最新的完整帧 (没有新帧则重复当前帧)，避免画面撕裂
+    // 保持画面时不切换，信号恢复过程中采集到的帧不会显示出来
+    if ((active_line == 0 && g_fallback != VIDEO_FALLBACK_HOLD) || g_scan_frame == NULL) {
+        g_scan_frame = frame_manager_output_vsync();
+    }
+    const uint16_t *src_row = &g_scan_frame[y_src * FRAME_WIDTH];
+#endif
+
+#if VIDEO_HW_PIXEL_DOUBLE
+    // 4. 由 DMA + PIO 倍增到 dst，CPU 不处理像素
+    // 每个字都经过 PIO FIFO (约 2 周期/字)，dst 写完之前不能交给 HDMI 库
+    pixel_double_start(dst, src_row, FRAME_WIDTH);
+    pixel_double_wait();
+#elif VIDEO_SCANLINE_CACHE
+    // 4. 展开到缓存，再由 DMA 复制到 dst
+    scanline_double(g_line_cache, src_row, FRAME_WIDTH);
+    g_cache_y = y_src;
+    copy_from_cache(dst);
+#else
+    // 4. 直接展开到 dst
+    scanline_double(dst, src_row, FRAME_WIDTH);
+#endif
+}
+
+// 输出帧开始: 锁存上一帧的 Core 1 负载
+static inline void latch_frame_stats(uint32_t now)
+{
+    if (g_stats.frames != 0) {
+        g_stats.frame_cycles = now - g_frame_start_cycles;
+        g_stats.busy_cycles = g_frame_busy_cycles;
+        g_stats.line_cycles_max = g_frame_line_max;
+        g_stats.cached_lines = g_frame_cached_lines;
+        if (g_frame_line_max > g_stats.line_cycles_peak) {
+            g_stats.line_cycles_peak = g_frame_line_max;
+        }
+    }
+    g_stats.frames++;
+    g_frame_start_cycles = now;
+    g_frame_busy_cycles = 0;
+    g_frame_line_max = 0;
+    g_frame_cached_lines = 0;
+}
+
+/**
+ * 扫描线回调 - 由 HDMI 库 Core 1 调用
+ * 签名匹配：void (*)(uint32_t, uint32_t, uint32_t *)
+ */
+void __time_critical_func(video_pipeline_scanline_callback)(uint32_t v_scanline, uint32_t active_line, uint32_t *dst)
+{
+    (void)v_scanline;
+
+    // DWT 周期计数器每个核各有一个，在 Core 1 上第一次进入时打开
+    if (!g_cycle_count_ready) {
+        cycle_count_init();
+        g_cycle_count_ready = true;
+    }
+
+    uint32_t t0 = cycle_count_now();
+    if (active_line == 0) {
+        latch_frame_stats(t0);
+        g_fallback = g_fallback_request;
+    }
 
-    // 4. 像素倍增 (320 -> 640)
-    double_pixels_fast(dst, src_row, FRAME_WIDTH);
+    // 只用相邻有效行的间隔更新行周期 (跨过消隐或丢行的间隔不计入)，1/8 平滑
+    if (active_line != 0 && active_line == g_line_active + 1) {
+        uint32_t delta = t0 - g_line_start_cycles;
+        if (g_line_period_cycles == 0) {
+            g_line_period_cycles = delta;
+        } else {
+            g_line_period_cycles += (int32_t)(delta - g_line_period_cycles) / 8;
+        }
+    }
+    g_line_start_cycles = t0;
+    g_line_active = active_line;
+
+    render_scanline(active_line, dst);
+
+    uint32_t cycles = cycle_count_now() - t0;
+    g_frame_busy_cycles += cycles;
+    if (cycles > g_frame_line_max) {
+        g_frame_line_max = cycles;
+    }
+}
+
+void video_pipeline_set_fallback(video_fallback_t fallback)
+{
+    g_fallback_request = fallback;
+}
+
+void video_pipeline_get_stats(video_pipeline_stats_t *stats)
+{
+    *stats = g_stats;
+}
+
+bool video_pipeline_frame_position(uint32_t *frame, uint32_t *elapsed_cycles, uint32_t *frame_cycles)
+{
+    // 上一帧的长度在第二帧开始时才有
+    if (g_stats.frame_cycles == 0) {
+        return false;
+    }
+    *frame = g_stats.frames;
+    *elapsed_cycles = cycle_count_now() - g_frame_start_cycles;
+    *frame_cycles = g_stats.frame_cycles;
+    return true;
+}
+
+bool video_pipeline_next_line_due(uint32_t *due_cycles)
+{
+    if (g_line_period_cycles == 0) {
+        return false;
+    }
+
+    // 帧内下一行紧跟一个行周期；最后一个有效行之后要等过整个消隐区
+    uint32_t lines = 1;
+    if (g_line_active + 1 >= OUTPUT_HEIGHT) {
+        lines = OUTPUT_V_TOTAL - OUTPUT_HEIGHT + 1;
+    }
+    *due_cycles = g_line_start_cycles + g_line_period_cycles * lines;
+    return true;
 }
 
 void video_pipeline_init(uint32_t frame_width, uint32_t frame_height)
 {
     // 初始化 HDMI 输出 (标准 VGA 640x480)
     // 库函数需要明确的分辨率参数
-    video_output_init(640, 480);
+    video_output_init(OUTPUT_WIDTH, OUTPUT_HEIGHT);
+
+#if VIDEO_HW_PIXEL_DOUBLE
+    // 硬件倍增需要一个空闲 PIO 状态机和两个 DMA 通道
+    hard_assert(pixel_double_init());
+#elif VIDEO_SCANLINE_CACHE
+    // 缓存行 -> dst 的复制通道: 32 位，不等待 DREQ
+    g_copy_chan = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config(g_copy_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_dreq(&c, DREQ_FORCE);
+    dma_channel_configure(g_copy_chan, &c, NULL, g_line_cache, FRAME_WIDTH, false);
+    memory_layout_note("scanline_cache", g_line_cache, sizeof(g_line_cache));
+#endif
 
     // 注册回调函数
     video_output_set_scanline_callback(video_pipeline_scanline_callback);
@@ -4,7 +4,52 @@
 #include <stdint.h> // 确保这里有这一行
 #include <stdbool.h>
 
+// 追线模式 (VIDEO_LINE_RACING) 统计，单位: 源行
+typedef struct {
+    uint32_t frames;                   // 已输出帧数
+    uint32_t last_frame_late_lines;    // 上一帧中采集尚未写到的行
+    uint32_t last_frame_overrun_lines; // 上一帧中已被采集覆盖的行
+    uint32_t total_late_lines;
+    uint32_t total_overrun_lines;
+} video_pipeline_racing_stats_t;
+
+// 输入信号不可用时的输出 (由信号锁定管理设置)
+typedef enum {
+    VIDEO_FALLBACK_NONE = 0, // 正常显示输入
+    VIDEO_FALLBACK_HOLD,     // 保持最后一个完整帧
+    VIDEO_FALLBACK_BLUE,     // 蓝屏 (VIDEO_NO_SIGNAL_COLOR)
+} video_fallback_t;
+
+// Core 1 扫描线负载 (DWT 周期)，每个输出帧开始时更新为上一帧的结果
+// 空闲周期 = frame_cycles - busy_cycles
+typedef struct {
+    uint32_t frames;           // 已输出帧数
+    uint32_t frame_cycles;     // 上一帧总周期 (输出第 0 行到下一个第 0 行)
+    uint32_t busy_cycles;      // 上一帧扫描线回调占用的周期
+    uint32_t line_cycles_max;  // 上一帧单行回调最大周期
+    uint32_t line_cycles_peak; // 启动以来单行回调最大周期
+    uint32_t cached_lines;     // 上一帧由行缓存直接复制的输出行
+} video_pipeline_stats_t;
+
 void video_pipeline_init(uint32_t frame_width, uint32_t frame_height);
 void video_pipeline_scanline_callback(uint32_t v_scanline, uint32_t active_line, uint32_t *dst);
 
+// 选择输出方式，在下一个输出帧的第 0 行生效 (整帧内不变)
+void video_pipeline_set_fallback(video_fallback_t fallback);
+
+// 读取 Core 1 扫描线负载统计
+void video_pipeline_get_stats(video_pipeline_stats_t *stats);
+
+// 当前输出帧的位置 (Core 1 DWT 周期，只能在 Core 1 上调用):
+// frame = 帧序号 (输出第 0 行时加一)，elapsed = 距本帧第 0 行的周期，frame_cycles = 上一帧的长度
+// 还没测到完整一帧时返回 false
+bool video_pipeline_frame_position(uint32_t *frame, uint32_t *elapsed_cycles, uint32_t *frame_cycles);
+
+// 下一次扫描线回调的预计开始时刻 (Core 1 DWT 周期，只能在 Core 1 上调用)
+// 由最近一次回调的时刻、行号和实测行周期推算；还没测到行周期时返回 false
+bool video_pipeline_next_line_due(uint32_t *due_cycles);
+
+// 读取追线模式统计 (仅 VIDEO_LINE_RACING=1 时可用)
+void video_pipeline_get_racing_stats(video_pipeline_racing_stats_t *stats);
+
 #endif
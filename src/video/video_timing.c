@@ -0,0 +1,88 @@
+#include "video_timing.h"
+
+#include <string.h>
+
+// Median of up to VIDEO_TIMING_MAX_SAMPLES values (insertion sort on a copy)
+static uint32_t median(const video_timing_sample_t *samples, uint32_t count, bool use_pulse)
+{
+    uint32_t sorted[VIDEO_TIMING_MAX_SAMPLES];
+    if (count > VIDEO_TIMING_MAX_SAMPLES) {
+        count = VIDEO_TIMING_MAX_SAMPLES;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t v = use_pulse ? samples[i].pulse : samples[i].period;
+        uint32_t j = i;
+        while (j > 0 && sorted[j - 1] > v) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = v;
+    }
+    return sorted[count / 2];
+}
+
+// Fit one axis: back porch must clear the sync pulse, active must fit the period.
+// total - bp still includes the front porch, so it is only an upper bound; the
+// frame buffer size (max_active) is what normally limits the window. Active is
+// rounded down to a multiple of align, and anything under 2 is rejected: the
+// capture programs are loaded with active / 2 - 1 and porch - 1
+static bool fit_axis(uint32_t total, uint32_t sync, uint16_t default_porch, uint16_t max_active, uint32_t align,
+                     uint16_t *porch, uint16_t *active)
+{
+    if (total == 0 || sync >= total || total > 0xFFFF) {
+        return false;
+    }
+
+    uint32_t bp = default_porch;
+    if (bp <= sync) {
+        bp = sync + 1;
+    }
+    if (bp >= total) {
+        return false;
+    }
+
+    uint32_t act = total - bp;
+    if (act > max_active) {
+        act = max_active;
+    }
+    act -= act % align;
+    if (act < 2) {
+        return false;
+    }
+
+    *porch = (uint16_t)bp;
+    *active = (uint16_t)act;
+    return true;
+}
+
+bool video_timing_detect(const video_timing_sample_t *h, uint32_t h_count, const video_timing_sample_t *v,
+                         uint32_t v_count, const video_timing_t *defaults, video_timing_t *out)
+{
+    if (h_count < VIDEO_TIMING_MIN_SAMPLES || v_count < VIDEO_TIMING_MIN_SAMPLES) {
+        return false;
+    }
+
+    video_timing_t t;
+    memset(&t, 0, sizeof(t));
+
+    uint32_t h_total = median(h, h_count, false);
+    uint32_t h_sync = median(h, h_count, true);
+    uint32_t v_total = median(v, v_count, false);
+    uint32_t v_sync = median(v, v_count, true);
+
+    // Two pixels per capture FIFO word: even width
+    if (!fit_axis(h_total, h_sync, defaults->h_back_porch, defaults->h_active, 2, &t.h_back_porch, &t.h_active)) {
+        return false;
+    }
+    if (!fit_axis(v_total, v_sync, defaults->v_back_porch, defaults->v_active, 1, &t.v_back_porch, &t.v_active)) {
+        return false;
+    }
+
+    t.h_total = (uint16_t)h_total;
+    t.h_sync = (uint16_t)h_sync;
+    t.v_total = (uint16_t)v_total;
+    t.v_sync = (uint16_t)v_sync;
+    *out = t;
+    return true;
+}
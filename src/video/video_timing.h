@@ -0,0 +1,57 @@
+#ifndef VIDEO_TIMING_H
+#define VIDEO_TIMING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Fewest sync periods needed for a measurement to be trusted
+#define VIDEO_TIMING_MIN_SAMPLES 3
+// Most sync periods considered per axis
+#define VIDEO_TIMING_MAX_SAMPLES 32
+
+/**
+ * Input timing, in PCLKs (horizontal) and lines (vertical).
+ * Back porches are counted from the falling edge of the sync pulse, which is
+ * how the capture program waits for them.
+ */
+typedef struct {
+    uint16_t h_total;      // PCLKs per line (HSYNC to HSYNC)
+    uint16_t h_sync;       // HSYNC pulse width
+    uint16_t h_back_porch; // PCLKs skipped before the first captured pixel
+    uint16_t h_active;     // Pixels captured per line
+    uint16_t v_total;      // Lines per frame (VSYNC to VSYNC)
+    uint16_t v_sync;       // VSYNC pulse width
+    uint16_t v_back_porch; // Lines skipped before the first captured line
+    uint16_t v_active;     // Lines captured per frame
+} video_timing_t;
+
+/**
+ * One measured sync period as reported by the timing probe program:
+ * pulse width and total period, both in clock counts.
+ */
+typedef struct {
+    uint32_t pulse;
+    uint32_t period;
+} video_timing_sample_t;
+
+/**
+ * Derive the capture window from measured sync traces.
+ *
+ * Uses the median of each trace to reject glitches, keeps the configured back
+ * porches (or moves them past the sync pulse if it is wider) and clamps the
+ * active window to what fits in the frame buffer. The width is made even (two
+ * pixels per capture FIFO word); a window under 2 pixels or lines is rejected. Pure function, no hardware
+ * access, so recorded traces can be replayed on a host.
+ *
+ * @param h         HSYNC periods counted in PCLKs
+ * @param h_count   Number of entries in h
+ * @param v         VSYNC periods counted in HSYNCs
+ * @param v_count   Number of entries in v
+ * @param defaults  Back porches and maximum active window to fit into
+ * @param out       Detected timing
+ * @return false if the traces are too short or implausible
+ */
+bool video_timing_detect(const video_timing_sample_t *h, uint32_t h_count, const video_timing_sample_t *v,
+                         uint32_t v_count, const video_timing_t *defaults, video_timing_t *out);
+
+#endif // VIDEO_TIMING_H
@@ -0,0 +1,75 @@
+/**
+ * Host run of the audio DSP kernel table (audio_dsp_bench_print(), the
+ * AUDIO_DSP_BENCH report), followed by the polyphase dot product two ways:
+ * one 16x16 MAC per tap, as before dsp_dot_q15(), and dsp_dot_q15() with two
+ * taps per SMLAD step. Their results must be identical.
+ *
+ * Cycles come from cycle_count.h, the host cycle counter on this build, and
+ * the host has no DSP extension (AUDIO_DSP_SIMD=0), so the figures show the
+ * relative cost of the kernels in portable C; the same table printed by an
+ * AUDIO_DSP_BENCH=1 firmware gives the target numbers.
+ */
+
+#include "audio_dsp.h"
+#include "cycle_count.h"
+#include "src.h"
+#include "test_common.h"
+
+#include <stdlib.h>
+
+#define DOT_RUNS 200000
+#define HIST 256
+
+static int16_t g_coeffs[SRC_POLY_TAPS] __attribute__((aligned(4)));
+static int16_t g_hist[HIST + SRC_POLY_TAPS];
+
+static int32_t dot_per_tap(const int16_t *coeffs, const int16_t *x, int n, int32_t acc)
+{
+    for (int k = 0; k < n; k++) {
+        acc += (int32_t)coeffs[k] * x[k];
+    }
+    return acc;
+}
+
+static double time_dot(int32_t (*dot)(const int16_t *, const int16_t *, int, int32_t), int runs, int32_t *sum)
+{
+    uint64_t total = 0;
+    int32_t s = 0;
+    for (int r = 0; r < runs; r++) {
+        // Odd window starts too: the delay line position moves one sample at a time
+        const int16_t *x = &g_hist[r % HIST];
+        uint32_t t0 = cycle_count_now();
+        s += dot(g_coeffs, x, SRC_POLY_TAPS, 1 << 14);
+        total += cycle_count_now() - t0;
+    }
+    *sum = s;
+    return (double)total / runs;
+}
+
+int main(int argc, char **argv)
+{
+    int runs = argc > 1 ? atoi(argv[1]) : DOT_RUNS;
+    if (runs < 1) {
+        runs = 1;
+    }
+
+    audio_dsp_bench_print();
+
+    uint32_t seed = 0x534D4C44;
+    for (int k = 0; k < SRC_POLY_TAPS; k++) {
+        g_coeffs[k] = (int16_t)(test_rand(&seed) >> 18); // Q15 taps well inside the range
+    }
+    for (int i = 0; i < HIST + SRC_POLY_TAPS; i++) {
+        g_hist[i] = (int16_t)test_rand(&seed);
+    }
+
+    int32_t sum_tap, sum_smlad;
+    double tap = time_dot(dot_per_tap, runs, &sum_tap);
+    double smlad = time_dot(dsp_dot_q15, runs, &sum_smlad);
+    printf("[audio] %d-tap Q15 dot product, cycles per channel:\n", SRC_POLY_TAPS);
+    printf("[audio]   %-13s %6.1f\n", "per tap", tap);
+    printf("[audio]   %-13s %6.1f\n", "dsp_dot_q15", smlad);
+
+    CHECK_MSG(sum_tap == sum_smlad, "dot products differ: %d vs %d", sum_tap, sum_smlad);
+    return test_finish("bench_audio_dsp");
+}
@@ -0,0 +1,191 @@
+/**
+ * Host benchmark of audio ingestion: samples per microsecond from the I2S
+ * DMA ring to SRC output, before and after the stages ran in place on the
+ * capture ring.
+ *
+ *   before: the three-copy path this replaced. Unpack the 24-bit R/L DMA
+ *           words one ap_ring_write() at a time, copy 64-sample blocks out
+ *           with ap_ring_read(), then run DC, lowpass and SRC on the copy.
+ *   after:  audio_pipeline_process() as built: the packed I2S words land in
+ *           the capture ring (fed here through the DMA stub, outside the
+ *           timing) and poll + stages work on ring spans.
+ *
+ * Both get the same input in video-frame sized bursts (925 frames, one 60 Hz
+ * frame at 55.5 kHz) and use the same stage code and modes, so the
+ * difference is the ingestion. Built with AUDIO_FUSED_KERNEL=0 the "after"
+ * figure runs the separate stages too, which isolates the copies.
+ */
+
+#include "audio_pipeline.h"
+#include "hardware/dma.h"
+#include "test_common.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_BURSTS 2000
+#define BURST_FRAMES 925
+#define BLOCK 64
+
+// Unpacked DMA ring of the old path: right word, left word per frame
+#define RAW_WORDS 4096
+#define RAW_MASK (RAW_WORDS - 1)
+
+static audio_sample_t g_input[BURST_FRAMES * 16];
+static uint32_t g_output_samples;
+static uint32_t g_output_sum;
+
+static void output(const audio_sample_t *samples, uint32_t count, void *ctx)
+{
+    // Touch the output so none of the work can be optimised away
+    for (uint32_t i = 0; i < count; i++) {
+        g_output_sum += (uint16_t)samples[i].left ^ (uint16_t)samples[i].right;
+    }
+    g_output_samples += count;
+}
+
+static const audio_sample_t *burst_input(int burst)
+{
+    return &g_input[(burst % 16) * BURST_FRAMES];
+}
+
+// -----------------------------------------------------------------------------
+// Before: unpack per sample, copy out per sample, stages on the copy
+// -----------------------------------------------------------------------------
+
+static uint32_t g_raw[RAW_WORDS];
+static audio_sample_t g_old_storage[AP_RING_SIZE];
+static audio_sample_t g_process_in[BLOCK];
+static audio_sample_t g_process_out[BLOCK];
+
+static double bench_before(int bursts)
+{
+    ap_ring_t ring;
+    dc_filter_t dc;
+    lowpass_t lp;
+    src_t src;
+    ap_ring_init(&ring, g_old_storage);
+    dc_filter_init(&dc);
+    dc.enabled = true;
+    lowpass_init(&lp, SRC_INPUT_RATE_DEFAULT, LOWPASS_CUTOFF_HZ);
+    lp.enabled = true;
+    src_init(&src, SRC_INPUT_RATE_DEFAULT, SRC_OUTPUT_RATE_DEFAULT);
+    src.mode = SRC_MODE_LINEAR;
+
+    uint32_t dma_idx = 0, read_idx = 0;
+    uint64_t ns = 0;
+    for (int b = 0; b < bursts; b++) {
+        // The DMA writes the burst (24-bit words, padding bits set)
+        const audio_sample_t *in = burst_input(b);
+        for (uint32_t i = 0; i < BURST_FRAMES; i++) {
+            g_raw[dma_idx] = 0xA50000u | (uint16_t)in[i].right;
+            g_raw[(dma_idx + 1) & RAW_MASK] = 0x5A0000u | (uint16_t)in[i].left;
+            dma_idx = (dma_idx + 2) & RAW_MASK;
+        }
+
+        uint64_t t0 = test_now_ns();
+
+        // Old poll: one ap_ring_write() per frame
+        uint32_t frames = ((dma_idx - read_idx) & RAW_MASK) / 2;
+        for (uint32_t i = 0; i < frames && ap_ring_free(&ring) > 0; i++) {
+            audio_sample_t s;
+            s.right = (int16_t)(g_raw[read_idx] & 0xFFFF);
+            s.left = (int16_t)(g_raw[(read_idx + 1) & RAW_MASK] & 0xFFFF);
+            read_idx = (read_idx + 2) & RAW_MASK;
+            ap_ring_write(&ring, s);
+        }
+
+        // Old process: copy a block out, stages on the copy
+        uint32_t available;
+        while ((available = ap_ring_available(&ring)) > 0) {
+            uint32_t n = available < BLOCK ? available : BLOCK;
+            for (uint32_t i = 0; i < n; i++) {
+                g_process_in[i] = ap_ring_read(&ring);
+            }
+            dc_filter_process_buffer(&dc, g_process_in, n);
+            lowpass_process_buffer(&lp, g_process_in, n);
+            uint32_t consumed = 0;
+            uint32_t out = src_process(&src, g_process_in, n, g_process_out, BLOCK, &consumed);
+            if (out > 0) {
+                output(g_process_out, out, NULL);
+            }
+        }
+
+        ns += test_now_ns() - t0;
+    }
+    return (double)bursts * BURST_FRAMES / ((double)ns / 1000.0);
+}
+
+// -----------------------------------------------------------------------------
+// After: the pipeline as built
+// -----------------------------------------------------------------------------
+
+static double bench_after(int bursts)
+{
+    static audio_pipeline_t p;
+    const audio_pipeline_config_t config = {
+        .pin_bck = 24,
+        .pin_dat = 22,
+        .pin_ws = 23,
+        .pin_btn1 = AUDIO_BTN1_PIN,
+        .pin_btn2 = AUDIO_BTN2_PIN,
+        .pio = pio0,
+        .sm = 0,
+    };
+    if (!audio_pipeline_init(&p, &config)) {
+        return 0;
+    }
+    audio_pipeline_start(&p);
+
+    uint64_t ns = 0;
+    for (int b = 0; b < bursts; b++) {
+        // The PIO pushes the burst as packed words
+        const audio_sample_t *in = burst_input(b);
+        for (uint32_t i = 0; i < BURST_FRAMES; i++) {
+            uint32_t word;
+            memcpy(&word, &in[i], sizeof(word));
+            pio0->rxf[0] = word;
+            host_dma_transfer((uint)p.capture.dma_chan, 1);
+        }
+
+        uint64_t t0 = test_now_ns();
+        audio_pipeline_process(&p, output, NULL);
+        ns += test_now_ns() - t0;
+    }
+    CHECK(p.capture.overflows == 0);
+    return (double)bursts * BURST_FRAMES / ((double)ns / 1000.0);
+}
+
+int main(int argc, char **argv)
+{
+    int bursts = argc > 1 ? atoi(argv[1]) : BENCH_BURSTS;
+    if (bursts < 1) {
+        bursts = 1;
+    }
+
+    // Two tones and a little noise, full scale
+    uint32_t seed = 0x2468ACE1;
+    for (size_t i = 0; i < sizeof(g_input) / sizeof(g_input[0]); i++) {
+        double t = (double)i / AUDIO_INPUT_RATE;
+        int noise = (int)(test_rand(&seed) & 0x3FF) - 512;
+        g_input[i].left = (int16_t)(12000 * sin(2 * M_PI * 440 * t) + noise);
+        g_input[i].right = (int16_t)(12000 * sin(2 * M_PI * 1000 * t) - noise);
+    }
+
+    g_output_samples = 0;
+    double before = bench_before(bursts);
+    uint32_t out_before = g_output_samples;
+    g_output_samples = 0;
+    double after = bench_after(bursts);
+    uint32_t out_after = g_output_samples;
+
+    printf("audio ingestion, %d bursts of %d frames, SRC %s, %s stages\n", bursts, BURST_FRAMES,
+           src_mode_name(SRC_MODE_LINEAR), AUDIO_FUSED_KERNEL ? "fused" : "separate");
+    printf("  before (unpack + ring copy + block copy): %7.1f samples/us\n", before);
+    printf("  after  (stages on capture ring spans):    %7.1f samples/us  (x%.2f)\n", after, after / before);
+
+    // Same input, same SRC: the same number of output samples either way
+    CHECK_MSG(out_before == out_after, "%u vs %u output samples", out_before, out_after);
+    return test_finish("bench_audio_ingest");
+}
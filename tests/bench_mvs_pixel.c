@@ -0,0 +1,105 @@
+/**
+ * Host benchmark of the MVS line conversion: cycles per line for
+ * mvs_pixel_convert_line() against converting the same line one pixel at a
+ * time with mvs_pixel_convert() and with the bit-level decode the tables
+ * replace (channel bit reversal, green expansion and SHADOW per pixel).
+ *
+ * Cycles come from cycle_count.h, which is the host cycle counter on this
+ * build. The target figure to compare with is the input line period, about
+ * 8000 cycles at 126 MHz (15.7 kHz lines), which the conversion shares with
+ * the DMA restart and stats of the capture loop.
+ */
+
+#include "cycle_count.h"
+#include "mvs_pixel.h"
+#include "test_common.h"
+
+#include <stdlib.h>
+
+#define BENCH_LINES 20000
+#define LINE_PIXELS 320
+#define RAW_LINES 16
+
+#define TARGET_SYS_HZ 126000000u
+#define TARGET_LINE_CYCLES (TARGET_SYS_HZ / 15734u)
+
+static uint32_t g_raw[RAW_LINES][LINE_PIXELS];
+static uint16_t g_dst[LINE_PIXELS];
+static uint32_t g_sum;
+
+static uint32_t decode_channel(uint32_t raw, int shift)
+{
+    uint32_t v = 0;
+    for (int i = 0; i < 5; i++) {
+        v = (v << 1) | ((raw >> (shift + i)) & 1);
+    }
+    return v;
+}
+
+static void convert_line_decode(uint16_t *dst, const uint32_t *raw, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t r = decode_channel(raw[i], MVS_RAW_RED_SHIFT);
+        uint32_t g = decode_channel(raw[i], MVS_RAW_GREEN_SHIFT);
+        uint32_t b = decode_channel(raw[i], MVS_RAW_BLUE_SHIFT);
+        g = (g << 1) | (g >> 4);
+        if ((raw[i] >> MVS_RAW_SHADOW_BIT) & 1) {
+            r >>= 1;
+            g >>= 1;
+            b >>= 1;
+        }
+        dst[i] = (uint16_t)((r << 11) | (g << 5) | b);
+    }
+}
+
+static void convert_line_pixel(uint16_t *dst, const uint32_t *raw, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        dst[i] = mvs_pixel_convert(raw[i]);
+    }
+}
+
+static void run(const char *name, void (*convert)(uint16_t *, const uint32_t *, uint32_t), int lines)
+{
+    uint64_t total = 0;
+    uint32_t worst = 0;
+    for (int i = 0; i < lines; i++) {
+        uint32_t t0 = cycle_count_now();
+        convert(g_dst, g_raw[i % RAW_LINES], LINE_PIXELS);
+        uint32_t cycles = cycle_count_now() - t0;
+        total += cycles;
+        worst = cycles > worst ? cycles : worst;
+        // Touch the output so none of the work can be optimised away
+        g_sum += g_dst[i % LINE_PIXELS];
+    }
+    printf("  %-22s %8.1f cycles/line (worst %u)\n", name, (double)total / lines, worst);
+}
+
+int main(int argc, char **argv)
+{
+    int lines = argc > 1 ? atoi(argv[1]) : BENCH_LINES;
+    if (lines < 1) {
+        lines = 1;
+    }
+
+    uint32_t seed = 0x6D767321;
+    for (int l = 0; l < RAW_LINES; l++) {
+        for (int i = 0; i < LINE_PIXELS; i++) {
+            g_raw[l][i] = test_rand(&seed) & 0x3FFFF;
+        }
+    }
+    mvs_pixel_init();
+    cycle_count_init();
+
+    // Warm-up pass of each (caches, table pages), then the timed runs
+    convert_line_decode(g_dst, g_raw[0], LINE_PIXELS);
+    mvs_pixel_convert_line(g_dst, g_raw[0], LINE_PIXELS);
+
+    printf("MVS line conversion, %d lines x %d pixels\n", lines, LINE_PIXELS);
+    run("bit decode per pixel", convert_line_decode, lines);
+    run("tables per pixel", convert_line_pixel, lines);
+    run("mvs_pixel_convert_line", mvs_pixel_convert_line, lines);
+    printf("  %-22s %8u cycles/line at %u MHz\n", "target line period", TARGET_LINE_CYCLES,
+           TARGET_SYS_HZ / 1000000u);
+    return g_sum == 0xFFFFFFFFu;
+}
@@ -0,0 +1,99 @@
+/**
+ * Host benchmark of the fused DC block + lowpass + SRC kernel: cycles per
+ * input sample for the separate stages (two in-place passes over the block,
+ * then the resampler) and for src_process_fused(), in LINEAR and POLYPHASE
+ * modes, on 64-sample blocks of noise.
+ *
+ * Cycles come from cycle_count.h, the host cycle counter on this build. On
+ * target the whole pipeline has about 2270 cycles per input sample at
+ * 126 MHz (55.5 kHz), shared with the encoder and the video background work.
+ */
+
+#include "cycle_count.h"
+#include "src.h"
+#include "test_common.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_BLOCKS 20000
+#define BLOCK 64
+#define INPUT_BLOCKS 64
+
+static audio_sample_t g_input[INPUT_BLOCKS * BLOCK];
+static audio_sample_t g_work[BLOCK];
+static audio_sample_t g_out[2 * BLOCK];
+static uint32_t g_sum;
+
+typedef struct {
+    src_t src;
+    dc_filter_t dc;
+    lowpass_t lp;
+} chain_t;
+
+static void chain_init(chain_t *c, src_mode_t mode)
+{
+    src_init(&c->src, SRC_INPUT_RATE_DEFAULT, SRC_OUTPUT_RATE_DEFAULT);
+    src_set_mode(&c->src, mode);
+    dc_filter_init(&c->dc);
+    c->dc.enabled = true;
+    lowpass_init(&c->lp, SRC_INPUT_RATE_DEFAULT, LOWPASS_CUTOFF_HZ);
+}
+
+static uint32_t run_staged(chain_t *c, const audio_sample_t *in)
+{
+    uint32_t used;
+    memcpy(g_work, in, sizeof(g_work));
+    dc_filter_process_buffer(&c->dc, g_work, BLOCK);
+    lowpass_process_buffer(&c->lp, g_work, BLOCK);
+    return src_process(&c->src, g_work, BLOCK, g_out, 2 * BLOCK, &used);
+}
+
+static uint32_t run_fused(chain_t *c, const audio_sample_t *in)
+{
+    uint32_t used;
+    return src_process_fused(&c->src, &c->dc, &c->lp, in, BLOCK, g_out, 2 * BLOCK, &used);
+}
+
+static double measure(src_mode_t mode, uint32_t (*run)(chain_t *, const audio_sample_t *), int blocks)
+{
+    chain_t c;
+    chain_init(&c, mode);
+    run(&c, g_input); // Warm-up
+
+    uint64_t total = 0;
+    for (int b = 0; b < blocks; b++) {
+        const audio_sample_t *in = &g_input[(b % INPUT_BLOCKS) * BLOCK];
+        uint32_t t0 = cycle_count_now();
+        uint32_t n = run(&c, in);
+        total += cycle_count_now() - t0;
+        // Touch the output so none of the work can be optimised away
+        g_sum += n + (uint16_t)g_out[0].left;
+    }
+    return (double)total / ((double)blocks * BLOCK);
+}
+
+int main(int argc, char **argv)
+{
+    int blocks = argc > 1 ? atoi(argv[1]) : BENCH_BLOCKS;
+    if (blocks < 1) {
+        blocks = 1;
+    }
+
+    uint32_t seed = 0x42454E43;
+    for (size_t i = 0; i < sizeof(g_input) / sizeof(g_input[0]); i++) {
+        g_input[i].left = (int16_t)test_rand(&seed);
+        g_input[i].right = (int16_t)(test_rand(&seed) >> 2);
+    }
+    cycle_count_init();
+
+    printf("DC + lowpass + SRC, %d blocks x %d samples (host cycles per input sample)\n", blocks, BLOCK);
+    printf("  %-10s %10s %10s %8s\n", "mode", "staged", "fused", "speedup");
+    const src_mode_t modes[] = {SRC_MODE_LINEAR, SRC_MODE_POLYPHASE};
+    for (int m = 0; m < 2; m++) {
+        double staged = measure(modes[m], run_staged, blocks);
+        double fused = measure(modes[m], run_fused, blocks);
+        printf("  %-10s %10.1f %10.1f %7.2fx\n", src_mode_name(modes[m]), staged, fused, staged / fused);
+    }
+    return g_sum == 0xFFFFFFFFu;
+}
@@ -0,0 +1,58 @@
+/**
+ * Separate-sync LCD bus waveform for the PIO model: PCLK, HSYNC, VSYNC and a
+ * 16-bit pixel bus on the firmware's pins (hardware_config.h), as a function
+ * of the system clock.
+ *
+ * Each PCLK is low for the first half of its period and high for the second;
+ * pixel data changes on the falling edge and is stable at the rising edge.
+ * HSYNC is low for h_sync PCLKs from the start of a line, VSYNC for v_sync
+ * lines from the start of a frame. Line 0 of each frame is the one whose
+ * HSYNC falls together with VSYNC; PCLK 0 of a line starts at its HSYNC
+ * falling edge.
+ */
+
+#ifndef LCD_WAVEFORM_H
+#define LCD_WAVEFORM_H
+
+#include "hardware_config.h"
+
+#include <stdint.h>
+
+typedef struct {
+    uint32_t clocks_per_pclk; // System clocks per PCLK (even or odd)
+    uint32_t h_total, h_sync; // PCLKs
+    uint32_t v_total, v_sync; // Lines
+} lcd_waveform_t;
+
+// Value on the pixel bus at PCLK p of line l (distinct across a frame)
+static inline uint16_t lcd_pixel(uint32_t line, uint32_t pclk)
+{
+    return (uint16_t)((line * 0x9E37u + pclk * 0x0101u) ^ 0x5A5Au);
+}
+
+static inline uint64_t lcd_waveform_gpios(const lcd_waveform_t *w, uint64_t clock)
+{
+    uint64_t pclk_index = clock / w->clocks_per_pclk;
+    uint32_t phase = (uint32_t)(clock % w->clocks_per_pclk);
+    uint32_t pclk = (uint32_t)(pclk_index % w->h_total);
+    uint32_t line = (uint32_t)((pclk_index / w->h_total) % w->v_total);
+
+    uint64_t gpios = (uint64_t)lcd_pixel(line, pclk) << PIN_RGB_BASE;
+    if (phase >= w->clocks_per_pclk / 2) {
+        gpios |= 1ull << PIN_PCLK;
+    }
+    if (pclk >= w->h_sync) {
+        gpios |= 1ull << PIN_HSYNC;
+    }
+    if (line >= w->v_sync) {
+        gpios |= 1ull << PIN_VSYNC;
+    }
+    return gpios;
+}
+
+static inline uint64_t lcd_waveform_frame_clocks(const lcd_waveform_t *w)
+{
+    return (uint64_t)w->clocks_per_pclk * w->h_total * w->v_total;
+}
+
+#endif // LCD_WAVEFORM_H
@@ -0,0 +1,585 @@
+#include "pio_model.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// =============================================================================
+// Assembler
+// =============================================================================
+
+#define MAX_LABELS 32
+#define MAX_LINE 256
+
+typedef struct {
+    char name[32];
+    uint32_t addr;
+} label_t;
+
+// Pending jmp targets are resolved after the whole program is read
+typedef struct {
+    label_t labels[MAX_LABELS];
+    uint32_t label_count;
+    char targets[PIO_MODEL_MAX_INSTRUCTIONS][32];
+} asm_ctx_t;
+
+static bool asm_error(const char *path, int line_no, const char *what, const char *text)
+{
+    fprintf(stderr, "%s:%d: %s: %s\n", path, line_no, what, text);
+    return false;
+}
+
+// Split on whitespace and commas; returns the token count
+static int tokenize(char *s, char *tok[], int max)
+{
+    int n = 0;
+    while (*s != '\0' && n < max) {
+        while (*s == ' ' || *s == '\t' || *s == ',') {
+            s++;
+        }
+        if (*s == '\0') {
+            break;
+        }
+        tok[n++] = s;
+        while (*s != '\0' && *s != ' ' && *s != '\t' && *s != ',') {
+            s++;
+        }
+        if (*s != '\0') {
+            *s++ = '\0';
+        }
+    }
+    return n;
+}
+
+static bool parse_number(const char *s, uint32_t *v)
+{
+    char *end;
+    *v = (uint32_t)strtoul(s, &end, 0);
+    return end != s && *end == '\0';
+}
+
+static bool parse_loc(const char *s, pio_loc_t *loc)
+{
+    static const struct {
+        const char *name;
+        pio_loc_t loc;
+    } names[] = {
+        {"pins", PIO_LOC_PINS}, {"x", PIO_LOC_X},           {"y", PIO_LOC_Y},       {"null", PIO_LOC_NULL},
+        {"isr", PIO_LOC_ISR},   {"osr", PIO_LOC_OSR},       {"pindirs", PIO_LOC_PINDIRS},
+        {"pc", PIO_LOC_PC},     {"exec", PIO_LOC_EXEC},     {"status", PIO_LOC_STATUS},
+        {"gpio", PIO_LOC_GPIO}, {"pin", PIO_LOC_PIN},       {"irq", PIO_LOC_IRQ},
+        {"jmppin", PIO_LOC_JMPPIN},
+    };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (strcmp(s, names[i].name) == 0) {
+            *loc = names[i].loc;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parse_cond(const char *s, pio_cond_t *cond)
+{
+    static const struct {
+        const char *name;
+        pio_cond_t cond;
+    } names[] = {
+        {"!x", PIO_COND_NOT_X},   {"x--", PIO_COND_X_DEC}, {"!y", PIO_COND_NOT_Y},         {"y--", PIO_COND_Y_DEC},
+        {"x!=y", PIO_COND_X_NE_Y}, {"pin", PIO_COND_PIN},  {"!osre", PIO_COND_NOT_OSRE},
+    };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (strcmp(s, names[i].name) == 0) {
+            *cond = names[i].cond;
+            return true;
+        }
+    }
+    return false;
+}
+
+// One instruction from its tokens (label and comment already stripped)
+static bool parse_instr(asm_ctx_t *ctx, pio_model_program_t *prog, char *tok[], int n)
+{
+    pio_instr_t *in = &prog->code[prog->length];
+    memset(in, 0, sizeof(*in));
+
+    // Trailing [delay]
+    if (n > 1 && tok[n - 1][0] == '[') {
+        uint32_t d;
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%s", tok[n - 1] + 1);
+        char *close = strchr(buf, ']');
+        if (close == NULL) {
+            return false;
+        }
+        *close = '\0';
+        if (!parse_number(buf, &d) || d > 31) {
+            return false;
+        }
+        in->delay = (uint8_t)d;
+        n--;
+    }
+
+    const char *op = tok[0];
+    if (strcmp(op, "nop") == 0 && n == 1) {
+        in->op = PIO_OP_MOV;
+        in->dst = PIO_LOC_Y;
+        in->src = PIO_LOC_Y;
+    } else if (strcmp(op, "jmp") == 0 && (n == 2 || n == 3)) {
+        in->op = PIO_OP_JMP;
+        if (n == 3 && !parse_cond(tok[1], &in->cond)) {
+            return false;
+        }
+        snprintf(ctx->targets[prog->length], sizeof(ctx->targets[0]), "%s", tok[n - 1]);
+    } else if (strcmp(op, "wait") == 0 && (n == 3 || n == 5) && strcmp(tok[2], "jmppin") == 0) {
+        // wait <pol> jmppin [+ <offset>]
+        uint32_t pol;
+        in->op = PIO_OP_WAIT;
+        in->src = PIO_LOC_JMPPIN;
+        if (!parse_number(tok[1], &pol) || pol > 1) {
+            return false;
+        }
+        if (n == 5 && (strcmp(tok[3], "+") != 0 || !parse_number(tok[4], &in->value) || in->value > 3)) {
+            return false;
+        }
+        in->polarity = pol;
+    } else if (strcmp(op, "wait") == 0 && (n == 4 || n == 5)) {
+        uint32_t pol;
+        in->op = PIO_OP_WAIT;
+        if (!parse_number(tok[1], &pol) || pol > 1 || !parse_loc(tok[2], &in->src) ||
+            !parse_number(tok[3], &in->value)) {
+            return false;
+        }
+        if (in->src != PIO_LOC_GPIO && in->src != PIO_LOC_PIN && in->src != PIO_LOC_IRQ) {
+            return false;
+        }
+        if (n == 5 && strcmp(tok[4], "rel") != 0) {
+            return false;
+        }
+        in->polarity = pol;
+    } else if ((strcmp(op, "in") == 0 || strcmp(op, "out") == 0) && n == 3) {
+        in->op = op[0] == 'i' ? PIO_OP_IN : PIO_OP_OUT;
+        pio_loc_t *loc = in->op == PIO_OP_IN ? &in->src : &in->dst;
+        if (!parse_loc(tok[1], loc) || !parse_number(tok[2], &in->value) || in->value < 1 || in->value > 32) {
+            return false;
+        }
+    } else if ((strcmp(op, "push") == 0 || strcmp(op, "pull") == 0) && n <= 3) {
+        in->op = op[1] == 'u' && op[2] == 's' ? PIO_OP_PUSH : PIO_OP_PULL;
+        in->block = true;
+        for (int i = 1; i < n; i++) {
+            if (strcmp(tok[i], "iffull") == 0 || strcmp(tok[i], "ifempty") == 0) {
+                in->if_flag = true;
+            } else if (strcmp(tok[i], "noblock") == 0) {
+                in->block = false;
+            } else if (strcmp(tok[i], "block") != 0) {
+                return false;
+            }
+        }
+    } else if (strcmp(op, "mov") == 0 && n == 3) {
+        const char *src = tok[2];
+        in->op = PIO_OP_MOV;
+        if (src[0] == '~' || src[0] == '!') {
+            in->invert = true;
+            src++;
+        } else if (src[0] == ':' && src[1] == ':') {
+            in->reverse = true;
+            src += 2;
+        }
+        if (!parse_loc(tok[1], &in->dst) || !parse_loc(src, &in->src)) {
+            return false;
+        }
+    } else if (strcmp(op, "irq") == 0 && n >= 2) {
+        int i = 1;
+        in->op = PIO_OP_IRQ;
+        if (strcmp(tok[i], "set") == 0 || strcmp(tok[i], "nowait") == 0) {
+            i++;
+        } else if (strcmp(tok[i], "clear") == 0) {
+            in->irq_clear = true;
+            i++;
+        }
+        if (i >= n || !parse_number(tok[i], &in->value) || in->value > 7) {
+            return false;
+        }
+        if (i + 1 < n && strcmp(tok[i + 1], "rel") != 0) {
+            return false;
+        }
+    } else if (strcmp(op, "set") == 0 && n == 3) {
+        in->op = PIO_OP_SET;
+        if (!parse_loc(tok[1], &in->dst) || !parse_number(tok[2], &in->value) || in->value > 31) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+
+    prog->length++;
+    return true;
+}
+
+bool pio_model_load(pio_model_program_t *prog, const char *path, const char *name)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+
+    asm_ctx_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    memset(prog, 0, sizeof(*prog));
+    snprintf(prog->name, sizeof(prog->name), "%s", name);
+
+    bool in_program = false;
+    bool found = false;
+    bool have_wrap = false;
+    bool ok = true;
+    char line[MAX_LINE];
+    int line_no = 0;
+
+    while (ok && fgets(line, sizeof(line), f) != NULL) {
+        line_no++;
+        char text[MAX_LINE];
+        snprintf(text, sizeof(text), "%s", line);
+        text[strcspn(text, "\r\n")] = '\0';
+        line[strcspn(line, "\r\n")] = '\0';
+
+        // Comments
+        char *c = strchr(line, ';');
+        if (c != NULL) {
+            *c = '\0';
+        }
+        c = strstr(line, "//");
+        if (c != NULL) {
+            *c = '\0';
+        }
+
+        char *tok[8];
+        int n = tokenize(line, tok, 8);
+        if (n == 0) {
+            continue;
+        }
+
+        // C blocks end the program section
+        if (tok[0][0] == '%') {
+            in_program = false;
+            continue;
+        }
+        if (strcmp(tok[0], ".program") == 0) {
+            in_program = n == 2 && strcmp(tok[1], name) == 0;
+            found |= in_program;
+            continue;
+        }
+        if (!in_program) {
+            continue;
+        }
+
+        if (strcmp(tok[0], ".wrap_target") == 0) {
+            prog->wrap_target = prog->length;
+        } else if (strcmp(tok[0], ".wrap") == 0) {
+            prog->wrap = prog->length - 1;
+            have_wrap = true;
+        } else if (strcmp(tok[0], ".pio_version") == 0) {
+            // Nothing to model
+        } else if (tok[0][0] == '.') {
+            ok = asm_error(path, line_no, "unsupported directive", text);
+        } else {
+            // Optional label
+            size_t len = strlen(tok[0]);
+            if (tok[0][len - 1] == ':') {
+                if (ctx.label_count == MAX_LABELS) {
+                    ok = asm_error(path, line_no, "too many labels", text);
+                    break;
+                }
+                tok[0][len - 1] = '\0';
+                snprintf(ctx.labels[ctx.label_count].name, sizeof(ctx.labels[0].name), "%s", tok[0]);
+                ctx.labels[ctx.label_count++].addr = prog->length;
+                if (n == 1) {
+                    continue;
+                }
+                memmove(tok, tok + 1, sizeof(tok[0]) * (size_t)--n);
+            }
+            if (prog->length == PIO_MODEL_MAX_INSTRUCTIONS || !parse_instr(&ctx, prog, tok, n)) {
+                ok = asm_error(path, line_no, "cannot assemble", text);
+            }
+        }
+    }
+    fclose(f);
+
+    if (ok && !found) {
+        fprintf(stderr, "%s: no program %s\n", path, name);
+        ok = false;
+    }
+    if (!have_wrap) {
+        prog->wrap = prog->length - 1;
+    }
+
+    // Resolve jmp targets
+    for (uint32_t i = 0; ok && i < prog->length; i++) {
+        if (prog->code[i].op != PIO_OP_JMP) {
+            continue;
+        }
+        bool resolved = parse_number(ctx.targets[i], &prog->code[i].value);
+        for (uint32_t l = 0; !resolved && l < ctx.label_count; l++) {
+            if (strcmp(ctx.labels[l].name, ctx.targets[i]) == 0) {
+                prog->code[i].value = ctx.labels[l].addr;
+                resolved = true;
+            }
+        }
+        if (!resolved) {
+            fprintf(stderr, "%s: %s: unknown jmp target %s\n", path, name, ctx.targets[i]);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// =============================================================================
+// Execution
+// =============================================================================
+
+pio_model_sm_t *pio_model_add_sm(pio_model_t *pio, const pio_model_program_t *prog)
+{
+    if (pio->sm_count == PIO_MODEL_SM_COUNT) {
+        return NULL;
+    }
+    pio_model_sm_t *sm = &pio->sm[pio->sm_count++];
+    memset(sm, 0, sizeof(*sm));
+    sm->prog = prog;
+    sm->push_threshold = 32;
+    return sm;
+}
+
+static uint32_t bit_mask(uint32_t bits)
+{
+    return bits >= 32 ? 0xFFFFFFFFu : (1u << bits) - 1;
+}
+
+static uint32_t bit_reverse(uint32_t v)
+{
+    uint32_t r = 0;
+    for (int i = 0; i < 32; i++) {
+        r = (r << 1) | ((v >> i) & 1);
+    }
+    return r;
+}
+
+static bool rx_push(pio_model_sm_t *sm, bool block)
+{
+    if (pio_model_rx_level(sm) == PIO_MODEL_FIFO_DEPTH) {
+        if (block) {
+            return false;
+        }
+        sm->rx_dropped++;
+    } else {
+        sm->rx[sm->rx_head++ % PIO_MODEL_FIFO_DEPTH] = sm->isr;
+    }
+    sm->isr = 0;
+    sm->isr_count = 0;
+    return true;
+}
+
+static uint32_t read_src(const pio_model_sm_t *sm, pio_loc_t src, uint64_t gpios)
+{
+    switch (src) {
+        case PIO_LOC_PINS:
+            return (uint32_t)(gpios >> sm->in_base);
+        case PIO_LOC_X:
+            return sm->x;
+        case PIO_LOC_Y:
+            return sm->y;
+        case PIO_LOC_ISR:
+            return sm->isr;
+        case PIO_LOC_OSR:
+            return sm->osr;
+        default:
+            return 0;
+    }
+}
+
+static void write_dst(pio_model_sm_t *sm, pio_loc_t dst, uint32_t v, bool *jumped)
+{
+    switch (dst) {
+        case PIO_LOC_X:
+            sm->x = v;
+            break;
+        case PIO_LOC_Y:
+            sm->y = v;
+            break;
+        case PIO_LOC_ISR:
+            sm->isr = v;
+            sm->isr_count = 0;
+            break;
+        case PIO_LOC_OSR:
+            sm->osr = v;
+            sm->osr_count = 0;
+            break;
+        case PIO_LOC_PC:
+            sm->pc = v % sm->prog->length;
+            *jumped = true;
+            break;
+        default:
+            // Output pins are not modelled
+            break;
+    }
+}
+
+// Execute the instruction at pc; returns false while stalled
+static bool execute(pio_model_t *pio, pio_model_sm_t *sm, uint64_t gpios, bool *jumped)
+{
+    const pio_instr_t *in = &sm->prog->code[sm->pc];
+
+    switch (in->op) {
+        case PIO_OP_JMP: {
+            bool take;
+            switch (in->cond) {
+                case PIO_COND_NOT_X:
+                    take = sm->x == 0;
+                    break;
+                case PIO_COND_X_DEC:
+                    take = sm->x-- != 0;
+                    break;
+                case PIO_COND_NOT_Y:
+                    take = sm->y == 0;
+                    break;
+                case PIO_COND_Y_DEC:
+                    take = sm->y-- != 0;
+                    break;
+                case PIO_COND_X_NE_Y:
+                    take = sm->x != sm->y;
+                    break;
+                case PIO_COND_PIN:
+                    take = (gpios >> sm->jmp_pin) & 1;
+                    break;
+                case PIO_COND_NOT_OSRE:
+                    take = sm->osr_count < 32;
+                    break;
+                default:
+                    take = true;
+                    break;
+            }
+            if (take) {
+                sm->pc = in->value;
+                *jumped = true;
+            }
+            return true;
+        }
+
+        case PIO_OP_WAIT: {
+            bool level;
+            if (in->src == PIO_LOC_IRQ) {
+                level = (pio->irq >> in->value) & 1;
+                if (level == in->polarity && in->polarity) {
+                    pio->irq &= ~(1u << in->value);
+                }
+            } else {
+                uint32_t pin = in->src == PIO_LOC_PIN      ? sm->in_base + in->value
+                               : in->src == PIO_LOC_JMPPIN ? sm->jmp_pin + in->value
+                                                           : in->value;
+                level = (gpios >> pin) & 1;
+            }
+            return level == in->polarity;
+        }
+
+        case PIO_OP_IN: {
+            uint32_t data = in->src == PIO_LOC_NULL ? 0 : read_src(sm, in->src, gpios);
+            uint32_t n = in->value;
+            data &= bit_mask(n);
+            if (n == 32) {
+                sm->isr = data;
+            } else if (sm->in_shift_right) {
+                sm->isr = (sm->isr >> n) | (data << (32 - n));
+            } else {
+                sm->isr = (sm->isr << n) | data;
+            }
+            sm->isr_count = sm->isr_count + n > 32 ? 32 : sm->isr_count + n;
+            if (sm->autopush && sm->isr_count >= sm->push_threshold) {
+                // A full FIFO would stall here on hardware; the model's FIFO is deep
+                rx_push(sm, false);
+            }
+            return true;
+        }
+
+        case PIO_OP_OUT: {
+            uint32_t n = in->value;
+            uint32_t data;
+            if (sm->out_shift_right) {
+                data = sm->osr & bit_mask(n);
+                sm->osr = n == 32 ? 0 : sm->osr >> n;
+            } else {
+                data = n == 32 ? sm->osr : sm->osr >> (32 - n);
+                sm->osr = n == 32 ? 0 : sm->osr << n;
+            }
+            sm->osr_count = sm->osr_count + n > 32 ? 32 : sm->osr_count + n;
+            if (in->dst != PIO_LOC_NULL) {
+                write_dst(sm, in->dst, data, jumped);
+            }
+            return true;
+        }
+
+        case PIO_OP_PUSH:
+            if (in->if_flag && sm->isr_count < sm->push_threshold) {
+                return true;
+            }
+            return rx_push(sm, in->block);
+
+        case PIO_OP_PULL:
+            if (sm->tx_head == sm->tx_tail) {
+                if (in->block) {
+                    return false;
+                }
+                // Non-blocking pull from an empty FIFO copies X
+                sm->osr = sm->x;
+            } else {
+                sm->osr = sm->tx[sm->tx_tail++ % PIO_MODEL_FIFO_DEPTH];
+            }
+            sm->osr_count = 0;
+            return true;
+
+        case PIO_OP_MOV: {
+            uint32_t v = in->src == PIO_LOC_NULL ? 0 : read_src(sm, in->src, gpios);
+            if (in->invert) {
+                v = ~v;
+            } else if (in->reverse) {
+                v = bit_reverse(v);
+            }
+            write_dst(sm, in->dst, v, jumped);
+            return true;
+        }
+
+        case PIO_OP_IRQ:
+            if (in->irq_clear) {
+                pio->irq &= ~(1u << in->value);
+            } else {
+                pio->irq |= 1u << in->value;
+            }
+            return true;
+
+        case PIO_OP_SET:
+            write_dst(sm, in->dst, in->value, jumped);
+            return true;
+    }
+    return true;
+}
+
+void pio_model_step(pio_model_t *pio, uint64_t gpios)
+{
+    for (uint32_t i = 0; i < pio->sm_count; i++) {
+        pio_model_sm_t *sm = &pio->sm[i];
+        sm->cycles++;
+        if (sm->delay != 0) {
+            sm->delay--;
+            continue;
+        }
+
+        bool jumped = false;
+        uint32_t delay = sm->prog->code[sm->pc].delay;
+        if (!execute(pio, sm, gpios, &jumped)) {
+            sm->stalls++;
+            continue;
+        }
+        sm->delay = delay;
+        if (!jumped) {
+            sm->pc = sm->pc == sm->prog->wrap ? sm->prog->wrap_target : sm->pc + 1;
+        }
+    }
+}
@@ -0,0 +1,152 @@
+/**
+ * Instruction-level model of an RP2350 PIO block for host tests.
+ *
+ * Programs are assembled straight from the firmware's .pio sources, so the
+ * tests exercise exactly what pioasm would build. Each call to
+ * pio_model_step() is one system clock: every state machine executes (or
+ * stalls on) one instruction against the GPIO levels passed in. Covers the
+ * subset the firmware uses: jmp, wait (gpio, pin, irq, jmppin), in, out, push,
+ * pull, mov, irq, set, nop, delays and .wrap; side-set is not modelled.
+ */
+
+#ifndef PIO_MODEL_H
+#define PIO_MODEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PIO_MODEL_MAX_INSTRUCTIONS 32
+#define PIO_MODEL_SM_COUNT 4
+#define PIO_MODEL_FIFO_DEPTH 4096
+
+typedef enum {
+    PIO_OP_JMP,
+    PIO_OP_WAIT,
+    PIO_OP_IN,
+    PIO_OP_OUT,
+    PIO_OP_PUSH,
+    PIO_OP_PULL,
+    PIO_OP_MOV,
+    PIO_OP_IRQ,
+    PIO_OP_SET,
+} pio_op_t;
+
+// Sources and destinations (a superset; each op accepts the ones it allows)
+typedef enum {
+    PIO_LOC_PINS,
+    PIO_LOC_X,
+    PIO_LOC_Y,
+    PIO_LOC_NULL,
+    PIO_LOC_ISR,
+    PIO_LOC_OSR,
+    PIO_LOC_PINDIRS,
+    PIO_LOC_PC,
+    PIO_LOC_EXEC,
+    PIO_LOC_STATUS,
+    PIO_LOC_GPIO,   // wait only
+    PIO_LOC_PIN,    // wait / jmp pin
+    PIO_LOC_IRQ,    // wait only
+    PIO_LOC_JMPPIN, // wait only (PIO version 1)
+} pio_loc_t;
+
+typedef enum {
+    PIO_COND_ALWAYS,
+    PIO_COND_NOT_X,
+    PIO_COND_X_DEC,
+    PIO_COND_NOT_Y,
+    PIO_COND_Y_DEC,
+    PIO_COND_X_NE_Y,
+    PIO_COND_PIN,
+    PIO_COND_NOT_OSRE,
+} pio_cond_t;
+
+typedef struct {
+    pio_op_t op;
+    pio_loc_t dst;
+    pio_loc_t src;
+    pio_cond_t cond;
+    uint32_t value;    // jmp target, bit count, wait index, set value, irq index
+    bool polarity;     // wait 0/1
+    bool invert;       // mov ~src
+    bool reverse;      // mov ::src
+    bool if_flag;      // push iffull / pull ifempty
+    bool block;        // push / pull block (default)
+    bool irq_clear;    // irq clear (irq wait is not modelled)
+    uint8_t delay;
+} pio_instr_t;
+
+typedef struct {
+    char name[32];
+    pio_instr_t code[PIO_MODEL_MAX_INSTRUCTIONS];
+    uint32_t length;
+    uint32_t wrap_target;
+    uint32_t wrap;
+} pio_model_program_t;
+
+typedef struct {
+    const pio_model_program_t *prog;
+
+    // Configuration (sm_config_* equivalents)
+    uint32_t in_base;
+    uint32_t jmp_pin;
+    bool in_shift_right;
+    bool out_shift_right;
+    bool autopush;
+    uint32_t push_threshold;
+
+    // State
+    uint32_t pc;
+    uint32_t x, y;
+    uint32_t isr, osr;
+    uint32_t isr_count, osr_count;
+    uint32_t delay;
+    uint64_t cycles;  // Clocks stepped
+    uint64_t stalls;  // Clocks spent waiting
+
+    // FIFOs (deep, so tests can drain them at their own pace)
+    uint32_t rx[PIO_MODEL_FIFO_DEPTH];
+    uint32_t rx_head, rx_tail;
+    uint32_t tx[PIO_MODEL_FIFO_DEPTH];
+    uint32_t tx_head, tx_tail;
+    uint32_t rx_dropped; // push noblock with a full FIFO
+} pio_model_sm_t;
+
+typedef struct {
+    pio_model_sm_t sm[PIO_MODEL_SM_COUNT];
+    uint32_t sm_count;
+    uint32_t irq; // IRQ flags 0-7, shared by the block's state machines
+} pio_model_t;
+
+/**
+ * Assemble program `name` from a .pio source file. Returns false (and prints
+ * the offending line) on anything outside the modelled subset.
+ */
+bool pio_model_load(pio_model_program_t *prog, const char *path, const char *name);
+
+/**
+ * Add a state machine running prog from its first instruction, with the
+ * reset configuration (shift left, no autopush, threshold 32).
+ */
+pio_model_sm_t *pio_model_add_sm(pio_model_t *pio, const pio_model_program_t *prog);
+
+/**
+ * Advance every state machine by one clock with the given GPIO levels.
+ */
+void pio_model_step(pio_model_t *pio, uint64_t gpios);
+
+static inline uint32_t pio_model_rx_level(const pio_model_sm_t *sm)
+{
+    return sm->rx_head - sm->rx_tail;
+}
+
+static inline uint32_t pio_model_rx_get(pio_model_sm_t *sm)
+{
+    return sm->rx[sm->rx_tail++ % PIO_MODEL_FIFO_DEPTH];
+}
+
+static inline void pio_model_tx_put(pio_model_sm_t *sm, uint32_t word)
+{
+    sm->tx[sm->tx_head++ % PIO_MODEL_FIFO_DEPTH] = word;
+}
+
+#endif // PIO_MODEL_H
@@ -0,0 +1,104 @@
+/**
+ * Host stub of the DMA driver. An unpaced channel copies its whole transfer
+ * count when it is waited for (or triggered again), not when it is
+ * triggered, so a destination handed on before the wait still holds its old
+ * contents; there is no chaining. A channel
+ * paced by a peripheral DREQ only arms when triggered; the test then plays the
+ * peripheral with host_dma_transfer(). dma_hw mirrors the registers the
+ * firmware reads back.
+ */
+
+#ifndef HOST_STUB_HARDWARE_DMA_H
+#define HOST_STUB_HARDWARE_DMA_H
+
+#include "pico.h"
+
+#define NUM_DMA_CHANNELS 16
+#define DREQ_FORCE 0x3f
+
+// TRANS_COUNT: count in bits 27:0, mode in bits 31:28 (RP2350)
+#define DMA_CH0_TRANS_COUNT_COUNT_BITS 0x0fffffffu
+#define DMA_CH0_TRANS_COUNT_MODE_LSB 28
+#define DMA_CH0_TRANS_COUNT_MODE_VALUE_NORMAL 0x0
+#define DMA_CH0_TRANS_COUNT_MODE_VALUE_TRIGGER_SELF 0x1
+#define DMA_CH0_TRANS_COUNT_MODE_VALUE_ENDLESS 0xf
+
+enum dma_channel_transfer_size { DMA_SIZE_8 = 0, DMA_SIZE_16 = 1, DMA_SIZE_32 = 2 };
+
+typedef struct {
+    enum dma_channel_transfer_size size;
+    bool read_increment;
+    bool write_increment;
+    uint dreq;
+    uint chain_to;
+    bool ring_write;
+    uint ring_size_bits; // 0 = no wrapping
+} dma_channel_config;
+
+typedef struct {
+    volatile uint32_t read_addr;
+    volatile uint32_t write_addr;
+    volatile uint32_t transfer_count; // Remaining count and mode, as read back
+    volatile uint32_t ctrl_trig;
+} dma_channel_hw_t;
+
+typedef struct {
+    dma_channel_hw_t ch[NUM_DMA_CHANNELS];
+} dma_hw_t;
+
+extern dma_hw_t host_dma_hw;
+#define dma_hw (&host_dma_hw)
+
+int dma_claim_unused_channel(bool required);
+void dma_channel_unclaim(uint channel);
+dma_channel_config dma_channel_get_default_config(uint channel);
+
+static inline void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size)
+{
+    c->size = size;
+}
+static inline void channel_config_set_read_increment(dma_channel_config *c, bool incr)
+{
+    c->read_increment = incr;
+}
+static inline void channel_config_set_write_increment(dma_channel_config *c, bool incr)
+{
+    c->write_increment = incr;
+}
+static inline void channel_config_set_dreq(dma_channel_config *c, uint dreq)
+{
+    c->dreq = dreq;
+}
+static inline void channel_config_set_chain_to(dma_channel_config *c, uint chain_to)
+{
+    c->chain_to = chain_to;
+}
+static inline void channel_config_set_ring(dma_channel_config *c, bool write, uint size_bits)
+{
+    c->ring_write = write;
+    c->ring_size_bits = size_bits;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint32_t transfer_count, bool trigger);
+void dma_channel_set_read_addr(uint channel, const volatile void *read_addr, bool trigger);
+void dma_channel_set_write_addr(uint channel, volatile void *write_addr, bool trigger);
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger);
+void dma_channel_start(uint channel);
+void dma_channel_abort(uint channel);
+
+// An unpaced (DREQ_FORCE) transfer stays busy and writes nothing until it is
+// waited for; paced channels never report busy
+bool dma_channel_is_busy(uint channel);
+void dma_channel_wait_for_finish_blocking(uint channel);
+
+// Host only: transfers started on a channel since it was claimed
+uint32_t host_dma_triggers(uint channel);
+
+// Host only: the peripheral raises DREQ n times on an armed paced channel.
+// Each transfer moves one item and counts down; at zero the channel stops,
+// or reloads and goes on in TRIGGER_SELF mode (ENDLESS never counts down).
+// Returns the transfers made.
+uint32_t host_dma_transfer(uint channel, uint32_t n);
+
+#endif // HOST_STUB_HARDWARE_DMA_H
@@ -0,0 +1,34 @@
+/**
+ * Host stub of the GPIO driver: pin setup calls are accepted and ignored,
+ * inputs read high (idle pulled-up buttons).
+ */
+
+#ifndef HOST_STUB_HARDWARE_GPIO_H
+#define HOST_STUB_HARDWARE_GPIO_H
+
+#include "pico.h"
+
+#define GPIO_IN false
+#define GPIO_OUT true
+
+static inline void gpio_init(uint gpio)
+{
+}
+static inline void gpio_set_dir(uint gpio, bool out)
+{
+}
+static inline void gpio_disable_pulls(uint gpio)
+{
+}
+static inline void gpio_set_input_hysteresis_enabled(uint gpio, bool enabled)
+{
+}
+static inline void gpio_pull_up(uint gpio)
+{
+}
+static inline bool gpio_get(uint gpio)
+{
+    return true;
+}
+
+#endif // HOST_STUB_HARDWARE_GPIO_H
@@ -0,0 +1,67 @@
+/**
+ * Host stub of the PIO driver: just enough for modules that load a program,
+ * point a DMA channel at a FIFO and start/stop state machines. Programs do not
+ * run here (tests/pio_model.h runs the .pio sources); a test feeds the FIFO's
+ * DMA channel itself (host_dma_transfer()).
+ */
+
+#ifndef HOST_STUB_HARDWARE_PIO_H
+#define HOST_STUB_HARDWARE_PIO_H
+
+#include "pico.h"
+
+#define NUM_PIO_STATE_MACHINES 4
+
+typedef struct {
+    volatile uint32_t txf[NUM_PIO_STATE_MACHINES];
+    volatile uint32_t rxf[NUM_PIO_STATE_MACHINES];
+} pio_hw_t;
+
+typedef pio_hw_t *PIO;
+
+extern pio_hw_t host_pio_hw[3];
+#define pio0 (&host_pio_hw[0])
+#define pio1 (&host_pio_hw[1])
+#define pio2 (&host_pio_hw[2])
+
+typedef struct {
+    const uint16_t *instructions;
+    uint8_t length;
+    int8_t origin;
+    uint8_t pio_version;
+} pio_program_t;
+
+typedef struct {
+    uint32_t clkdiv, execctrl, shiftctrl, pinctrl;
+} pio_sm_config;
+
+static inline int pio_set_gpio_base(PIO pio, uint gpio_base)
+{
+    return 0;
+}
+static inline uint pio_add_program(PIO pio, const pio_program_t *program)
+{
+    return 0;
+}
+static inline uint pio_get_dreq(PIO pio, uint sm, bool is_tx)
+{
+    return (uint)(pio - host_pio_hw) * 8 + sm + (is_tx ? 0 : 4);
+}
+static inline uint pio_encode_jmp(uint addr)
+{
+    return addr;
+}
+static inline void pio_sm_set_enabled(PIO pio, uint sm, bool enabled)
+{
+}
+static inline void pio_sm_restart(PIO pio, uint sm)
+{
+}
+static inline void pio_sm_clear_fifos(PIO pio, uint sm)
+{
+}
+static inline void pio_sm_exec(PIO pio, uint sm, uint instr)
+{
+}
+
+#endif // HOST_STUB_HARDWARE_PIO_H
@@ -0,0 +1,32 @@
+/**
+ * Host stub of the Cortex-M33 system registers used by cycle_count.h. Every
+ * access through m33_hw refreshes DWT_CYCCNT from the host's cycle counter
+ * (TSC on x86, nanoseconds elsewhere), so cycle_count_now() measures the
+ * host in the same units the firmware reports on target.
+ *
+ * Scheduling tests switch to a simulated counter with host_cycle_count_set():
+ * from then on DWT_CYCCNT only changes when the test sets it (or the
+ * firmware writes it, as cycle_count_init() does).
+ */
+
+#ifndef HOST_STUB_M33_H
+#define HOST_STUB_M33_H
+
+#include "pico.h"
+
+typedef struct {
+    uint32_t demcr;
+    uint32_t dwt_ctrl;
+    uint32_t dwt_cyccnt;
+} m33_hw_t;
+
+#define M33_DEMCR_TRCENA_BITS (1u << 24)
+#define M33_DWT_CTRL_CYCCNTENA_BITS (1u << 0)
+
+m33_hw_t *host_m33_hw(void);
+
+// Switch to the simulated counter and set it
+void host_cycle_count_set(uint32_t cycles);
+#define m33_hw (host_m33_hw())
+
+#endif // HOST_STUB_M33_H
@@ -0,0 +1,36 @@
+/**
+ * Host stub of the hardware spinlocks and interrupt masking. Tests run every
+ * "core" on one thread, so locks only need to hand out distinct instances.
+ */
+
+#ifndef HOST_STUB_HARDWARE_SYNC_H
+#define HOST_STUB_HARDWARE_SYNC_H
+
+#include "pico.h"
+
+typedef volatile uint32_t spin_lock_t;
+
+int spin_lock_claim_unused(bool required);
+spin_lock_t *spin_lock_instance(uint lock_num);
+
+static inline uint32_t save_and_disable_interrupts(void)
+{
+    return 0;
+}
+static inline void restore_interrupts(uint32_t status)
+{
+    (void)status;
+}
+
+static inline uint32_t spin_lock_blocking(spin_lock_t *lock)
+{
+    *lock = 1;
+    return 0;
+}
+static inline void spin_unlock(spin_lock_t *lock, uint32_t saved)
+{
+    (void)saved;
+    *lock = 0;
+}
+
+#endif // HOST_STUB_HARDWARE_SYNC_H
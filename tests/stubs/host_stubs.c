@@ -0,0 +1,404 @@
+/**
+ * Host implementations behind tests/stubs: time, DMA copies, spinlocks, the
+ * cycle counter, PIO FIFO registers, the pico_hdmi callback registry and the
+ * memory layout registry.
+ */
+
+#include "hardware/dma.h"
+#include "hardware/pio.h"
+#include "hardware/structs/m33.h"
+#include "hardware/sync.h"
+#include "memory_layout.h"
+#include "pico/time.h"
+#include "pico_hdmi/video_output.h"
+
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// =============================================================================
+// Time
+// =============================================================================
+
+static uint64_t host_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static bool host_time_simulated;
+static uint64_t host_time_us;
+
+void host_time_set_us(uint64_t us)
+{
+    host_time_simulated = true;
+    host_time_us = us;
+}
+
+uint64_t time_us_64(void)
+{
+    if (host_time_simulated) {
+        return host_time_us;
+    }
+    static uint64_t start_ns;
+    if (start_ns == 0) {
+        start_ns = host_ns();
+    }
+    return (host_ns() - start_ns) / 1000u;
+}
+
+void sleep_us(uint64_t us)
+{
+    usleep((useconds_t)us);
+}
+
+void sleep_ms(uint32_t ms)
+{
+    sleep_us((uint64_t)ms * 1000u);
+}
+
+// =============================================================================
+// Cycle counter
+// =============================================================================
+
+static uint64_t host_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return host_ns();
+#endif
+}
+
+static m33_hw_t host_m33_regs;
+static bool host_cycles_simulated;
+
+void host_cycle_count_set(uint32_t cycles)
+{
+    host_cycles_simulated = true;
+    host_m33_regs.dwt_cyccnt = cycles;
+}
+
+m33_hw_t *host_m33_hw(void)
+{
+    static uint64_t base;
+    static uint32_t last;
+
+    if (host_cycles_simulated) {
+        return &host_m33_regs;
+    }
+
+    // A value written since the last access (cycle_count_init() zeroes the
+    // counter) becomes the new origin
+    uint64_t now = host_cycles();
+    if (host_m33_regs.dwt_cyccnt != last) {
+        base = now - host_m33_regs.dwt_cyccnt;
+    }
+    host_m33_regs.dwt_cyccnt = last = (uint32_t)(now - base);
+    return &host_m33_regs;
+}
+
+// =============================================================================
+// DMA
+// =============================================================================
+
+typedef struct {
+    bool claimed;
+    bool armed;   // Paced channel triggered and not finished
+    bool pending; // Unpaced transfer triggered, not waited for yet
+    dma_channel_config config;
+    volatile void *write_addr;
+    const volatile void *read_addr;
+    uint32_t transfer_count; // As written: count and mode
+    uint32_t remaining;
+    uint32_t triggers;
+} host_dma_channel_t;
+
+static host_dma_channel_t g_dma[NUM_DMA_CHANNELS];
+dma_hw_t host_dma_hw;
+
+// Mirror the channel into the readable registers (low 32 bits of addresses)
+static void dma_sync_regs(uint channel)
+{
+    host_dma_channel_t *ch = &g_dma[channel];
+    dma_channel_hw_t *hw = &host_dma_hw.ch[channel];
+    hw->read_addr = (uint32_t)(uintptr_t)ch->read_addr;
+    hw->write_addr = (uint32_t)(uintptr_t)ch->write_addr;
+    hw->transfer_count = (ch->transfer_count & ~DMA_CH0_TRANS_COUNT_COUNT_BITS) | ch->remaining;
+}
+
+static uint32_t dma_mode(const host_dma_channel_t *ch)
+{
+    return ch->transfer_count >> DMA_CH0_TRANS_COUNT_MODE_LSB;
+}
+
+int dma_claim_unused_channel(bool required)
+{
+    for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+        if (!g_dma[i].claimed) {
+            memset(&g_dma[i], 0, sizeof(g_dma[i]));
+            g_dma[i].claimed = true;
+            dma_sync_regs(i);
+            return (int)i;
+        }
+    }
+    hard_assert(!required);
+    return -1;
+}
+
+void dma_channel_unclaim(uint channel)
+{
+    g_dma[channel].claimed = false;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel)
+{
+    return (dma_channel_config){
+        .size = DMA_SIZE_32,
+        .read_increment = true,
+        .write_increment = false,
+        .dreq = DREQ_FORCE,
+        .chain_to = channel,
+    };
+}
+
+// Next address after one item, wrapping inside the ring if this side has one
+static uintptr_t dma_next_addr(const dma_channel_config *c, uintptr_t addr, bool write)
+{
+    uintptr_t next = addr + ((uintptr_t)1 << c->size);
+    if (c->ring_size_bits != 0 && c->ring_write == write) {
+        uintptr_t mask = ((uintptr_t)1 << c->ring_size_bits) - 1;
+        next = (addr & ~mask) | (next & mask);
+    }
+    return next;
+}
+
+// Run an unpaced transfer that was started and not waited for
+static void dma_finish_pending(uint channel)
+{
+    host_dma_channel_t *ch = &g_dma[channel];
+    const size_t size = (size_t)1 << ch->config.size;
+    const volatile uint8_t *src = ch->read_addr;
+    volatile uint8_t *dst = ch->write_addr;
+
+    if (!ch->pending) {
+        return;
+    }
+    ch->pending = false;
+
+    // Memory-to-memory copy: one memcpy (what the benchmarks should not measure)
+    if (ch->config.read_increment && ch->config.write_increment) {
+        memcpy((void *)dst, (const void *)src, size * ch->remaining);
+        ch->remaining = 0;
+        dma_sync_regs(channel);
+        return;
+    }
+    for (uint32_t i = 0; i < ch->remaining; i++) {
+        for (size_t b = 0; b < size; b++) {
+            dst[b] = src[b];
+        }
+        if (ch->config.read_increment) {
+            src += size;
+        }
+        if (ch->config.write_increment) {
+            dst += size;
+        }
+    }
+    ch->remaining = 0;
+    dma_sync_regs(channel);
+}
+
+void dma_channel_start(uint channel)
+{
+    host_dma_channel_t *ch = &g_dma[channel];
+
+    // A transfer still pending from the last trigger would have finished by now
+    dma_finish_pending(channel);
+    ch->triggers++;
+    ch->remaining = ch->transfer_count & DMA_CH0_TRANS_COUNT_COUNT_BITS;
+
+    // Paced by a peripheral: wait for host_dma_transfer()
+    if (ch->config.dreq != DREQ_FORCE) {
+        ch->armed = true;
+        dma_sync_regs(channel);
+        return;
+    }
+
+    // Unpaced: the data lands when the channel is waited for, so code that
+    // reads (or hands out) the destination without waiting sees stale data
+    ch->pending = true;
+    dma_sync_regs(channel);
+}
+
+bool dma_channel_is_busy(uint channel)
+{
+    return g_dma[channel].pending;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel)
+{
+    dma_finish_pending(channel);
+}
+
+uint32_t host_dma_transfer(uint channel, uint32_t n)
+{
+    host_dma_channel_t *ch = &g_dma[channel];
+    const size_t size = (size_t)1 << ch->config.size;
+    const uint32_t mode = dma_mode(ch);
+    uint32_t done = 0;
+
+    while (ch->armed && done < n) {
+        memcpy((void *)ch->write_addr, (const void *)ch->read_addr, size);
+        if (ch->config.read_increment) {
+            ch->read_addr = (const volatile void *)dma_next_addr(&ch->config, (uintptr_t)ch->read_addr, false);
+        }
+        if (ch->config.write_increment) {
+            ch->write_addr = (volatile void *)dma_next_addr(&ch->config, (uintptr_t)ch->write_addr, true);
+        }
+        done++;
+
+        if (mode == DMA_CH0_TRANS_COUNT_MODE_VALUE_ENDLESS) {
+            continue;
+        }
+        if (--ch->remaining == 0) {
+            if (mode == DMA_CH0_TRANS_COUNT_MODE_VALUE_TRIGGER_SELF) {
+                ch->remaining = ch->transfer_count & DMA_CH0_TRANS_COUNT_COUNT_BITS;
+                ch->triggers++;
+            } else {
+                ch->armed = false;
+            }
+        }
+    }
+    dma_sync_regs(channel);
+    return done;
+}
+
+void dma_channel_abort(uint channel)
+{
+    g_dma[channel].armed = false;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint32_t transfer_count, bool trigger)
+{
+    g_dma[channel].config = *config;
+    g_dma[channel].write_addr = write_addr;
+    g_dma[channel].read_addr = read_addr;
+    g_dma[channel].transfer_count = transfer_count;
+    dma_sync_regs(channel);
+    if (trigger) {
+        dma_channel_start(channel);
+    }
+}
+
+void dma_channel_set_read_addr(uint channel, const volatile void *read_addr, bool trigger)
+{
+    g_dma[channel].read_addr = read_addr;
+    dma_sync_regs(channel);
+    if (trigger) {
+        dma_channel_start(channel);
+    }
+}
+
+void dma_channel_set_write_addr(uint channel, volatile void *write_addr, bool trigger)
+{
+    g_dma[channel].write_addr = write_addr;
+    dma_sync_regs(channel);
+    if (trigger) {
+        dma_channel_start(channel);
+    }
+}
+
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger)
+{
+    g_dma[channel].transfer_count = trans_count;
+    if (trigger) {
+        dma_channel_start(channel);
+    }
+}
+
+uint32_t host_dma_triggers(uint channel)
+{
+    return g_dma[channel].triggers;
+}
+
+// =============================================================================
+// PIO
+// =============================================================================
+
+pio_hw_t host_pio_hw[3];
+
+// =============================================================================
+// Spinlocks
+// =============================================================================
+
+static spin_lock_t g_spin_locks[32];
+static uint32_t g_spin_locks_claimed;
+
+int spin_lock_claim_unused(bool required)
+{
+    for (int i = 0; i < 32; i++) {
+        if (!(g_spin_locks_claimed & (1u << i))) {
+            g_spin_locks_claimed |= 1u << i;
+            return i;
+        }
+    }
+    hard_assert(!required);
+    return -1;
+}
+
+spin_lock_t *spin_lock_instance(uint lock_num)
+{
+    return &g_spin_locks[lock_num];
+}
+
+// =============================================================================
+// pico_hdmi
+// =============================================================================
+
+volatile uint32_t video_frame_count;
+
+static video_output_scanline_cb_t g_scanline_cb;
+static video_output_task_fn g_background_task;
+
+void video_output_init(uint32_t width, uint32_t height)
+{
+    (void)width;
+    (void)height;
+}
+
+void video_output_set_scanline_callback(video_output_scanline_cb_t cb)
+{
+    g_scanline_cb = cb;
+}
+
+void video_output_set_background_task(video_output_task_fn task)
+{
+    g_background_task = task;
+}
+
+video_output_scanline_cb_t host_video_output_scanline_callback(void)
+{
+    return g_scanline_cb;
+}
+
+video_output_task_fn host_video_output_background_task(void)
+{
+    return g_background_task;
+}
+
+// =============================================================================
+// Memory layout registry (placement is meaningless on the host)
+// =============================================================================
+
+void memory_layout_note(const char *name, const void *addr, size_t size)
+{
+    (void)name;
+    (void)addr;
+    (void)size;
+}
@@ -0,0 +1,23 @@
+/**
+ * Host stand-in for the pioasm output of src/audio/i2s_capture.pio: program
+ * descriptors and init helpers with nothing behind them (the programs
+ * themselves run on tests/pio_model.h).
+ */
+
+#ifndef HOST_STUB_I2S_CAPTURE_PIO_H
+#define HOST_STUB_I2S_CAPTURE_PIO_H
+
+#include "hardware/pio.h"
+
+static const pio_program_t i2s_capture_program = {0};
+static const pio_program_t i2s_capture_packed_program = {0};
+
+static inline void i2s_capture_program_init(PIO pio, uint sm, uint offset, uint pin_dat, uint pin_ws, uint pin_bck)
+{
+}
+static inline void i2s_capture_packed_program_init(PIO pio, uint sm, uint offset, uint pin_dat, uint pin_ws,
+                                                   uint pin_bck)
+{
+}
+
+#endif // HOST_STUB_I2S_CAPTURE_PIO_H
@@ -0,0 +1,57 @@
+/**
+ * Host stub of the Pico SDK base header: the types, section attributes and
+ * barriers the firmware modules use, with no hardware behind them.
+ */
+
+#ifndef HOST_STUB_PICO_H
+#define HOST_STUB_PICO_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef unsigned int uint;
+
+// Code and data placement has no meaning on the host
+#define __time_critical_func(func) func
+#define __not_in_flash_func(func) func
+#define __scratch_x(name)
+#define __scratch_y(name)
+#define __aligned(n) __attribute__((aligned(n)))
+
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+// Evaluated in every build, like the SDK's (the condition often has side effects)
+#define hard_assert(cond)                                                                                              \
+    do {                                                                                                               \
+        if (!(cond))                                                                                                   \
+            __builtin_trap();                                                                                          \
+    } while (0)
+
+#ifndef MIN
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+// Single-threaded host: barriers and events only stop the compiler reordering
+static inline void __compiler_memory_barrier(void)
+{
+    __asm__ volatile("" ::: "memory");
+}
+static inline void __dmb(void)
+{
+    __compiler_memory_barrier();
+}
+static inline void __sev(void)
+{
+}
+static inline void __wfe(void)
+{
+}
+static inline void tight_loop_contents(void)
+{
+}
+
+#endif // HOST_STUB_PICO_H
@@ -0,0 +1,7 @@
+#ifndef HOST_STUB_PICO_STDLIB_H
+#define HOST_STUB_PICO_STDLIB_H
+
+#include "pico.h"
+#include "pico/time.h"
+
+#endif // HOST_STUB_PICO_STDLIB_H
@@ -0,0 +1,32 @@
+#ifndef HOST_STUB_PICO_TIME_H
+#define HOST_STUB_PICO_TIME_H
+
+#include "pico.h"
+
+// Microseconds since the first call (CLOCK_MONOTONIC), or the simulated
+// time once host_time_set_us() was called
+uint64_t time_us_64(void);
+
+// Switch to simulated time: time_us_64() returns `us` until set again
+void host_time_set_us(uint64_t us);
+
+static inline uint32_t time_us_32(void)
+{
+    return (uint32_t)time_us_64();
+}
+
+typedef uint64_t absolute_time_t;
+
+static inline absolute_time_t get_absolute_time(void)
+{
+    return time_us_64();
+}
+static inline uint32_t to_ms_since_boot(absolute_time_t t)
+{
+    return (uint32_t)(t / 1000u);
+}
+
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+
+#endif // HOST_STUB_PICO_TIME_H
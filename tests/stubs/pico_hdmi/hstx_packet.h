@@ -0,0 +1,16 @@
+/**
+ * Host stub of the pico_hdmi packet header: the stereo sample type the audio
+ * modules exchange, laid out as in the library (left, then right).
+ */
+
+#ifndef HOST_STUB_HSTX_PACKET_H
+#define HOST_STUB_HSTX_PACKET_H
+
+#include <stdint.h>
+
+typedef struct {
+    int16_t left;
+    int16_t right;
+} audio_sample_t;
+
+#endif // HOST_STUB_HSTX_PACKET_H
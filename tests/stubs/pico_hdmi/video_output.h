@@ -0,0 +1,24 @@
+/**
+ * Host stub of the pico_hdmi output: records the registered callbacks so a
+ * test can play the part of the Core 1 HSTX loop and call them itself.
+ */
+
+#ifndef HOST_STUB_VIDEO_OUTPUT_H
+#define HOST_STUB_VIDEO_OUTPUT_H
+
+#include <stdint.h>
+
+typedef void (*video_output_scanline_cb_t)(uint32_t v_scanline, uint32_t active_line, uint32_t *dst);
+typedef void (*video_output_task_fn)(void);
+
+extern volatile uint32_t video_frame_count;
+
+void video_output_init(uint32_t width, uint32_t height);
+void video_output_set_scanline_callback(video_output_scanline_cb_t cb);
+void video_output_set_background_task(video_output_task_fn task);
+
+// Host only: what the firmware registered (NULL if nothing yet)
+video_output_scanline_cb_t host_video_output_scanline_callback(void);
+video_output_task_fn host_video_output_background_task(void);
+
+#endif // HOST_STUB_VIDEO_OUTPUT_H
@@ -0,0 +1,196 @@
+/**
+ * Frame-locked packet cadence.
+ *
+ * Checks the per-frame quota (200 packets = 800 samples at 48 kHz / 60 Hz),
+ * the fractional carry at rates that do not divide (44.1 kHz / 60 Hz,
+ * 48 kHz / 59.94 Hz: every quota is the floor or the ceiling and the running
+ * total never drifts), the debt limit when a frame releases nothing, the
+ * accounting of frames skipped while Core 1 stalled (every skipped quota is
+ * counted in packets_missed and the carry goes on as if no frame had been
+ * skipped), and audio_cadence_allowance() releasing debt first and then
+ * packet k at k / frame_packets of the period.
+ */
+
+#include "audio_cadence.h"
+#include "test_common.h"
+
+#define PERIOD 20000 // Frame length in the allowance's units
+
+// Releases everything the frame allows
+static uint32_t release_all(audio_cadence_t *c)
+{
+    uint32_t n = audio_cadence_allowance(c, PERIOD, PERIOD);
+    for (uint32_t i = 0; i < n; i++) {
+        audio_cadence_release(c);
+    }
+    return n;
+}
+
+// Packets due in the first `frames` frames: floor(frames * rate / (4 * fps))
+static uint64_t packets_due(uint32_t sample_rate, uint32_t frame_rate_mhz, uint32_t frames)
+{
+    return (uint64_t)frames * sample_rate * 1000u / ((uint64_t)AUDIO_CADENCE_SAMPLES_PER_PACKET * frame_rate_mhz);
+}
+
+static void test_integer_rate(void)
+{
+    audio_cadence_t c;
+    audio_cadence_init(&c, 48000, 60000);
+    CHECK(audio_cadence_frame(&c, 100) == 0);
+    for (uint32_t f = 101; f < 200; f++) {
+        CHECK(c.frame_packets == 200);
+        CHECK(release_all(&c) == 200);
+        CHECK(audio_cadence_allowance(&c, PERIOD, PERIOD) == 0);
+        CHECK(audio_cadence_frame(&c, f) == 0);
+        CHECK(c.carry == 0);
+    }
+    // Repeated calls within the same frame change nothing
+    CHECK(audio_cadence_frame(&c, 199) == 0);
+    CHECK(c.frames == 99 && c.frames_short == 0 && c.packets_missed == 0);
+}
+
+static void test_fractional_carry(uint32_t sample_rate, uint32_t frame_rate_mhz)
+{
+    const uint32_t frames = 10000;
+    const uint32_t lo = (uint32_t)packets_due(sample_rate, frame_rate_mhz, 1);
+    audio_cadence_t c;
+    audio_cadence_init(&c, sample_rate, frame_rate_mhz);
+    audio_cadence_frame(&c, 0);
+
+    uint64_t total = 0;
+    uint32_t drift = 0, odd = 0;
+    for (uint32_t f = 1; f <= frames; f++) {
+        uint32_t q = c.frame_packets;
+        odd += q != lo && q != lo + 1;
+        total += release_all(&c);
+        drift += total != packets_due(sample_rate, frame_rate_mhz, f);
+        CHECK(audio_cadence_frame(&c, f) == 0);
+    }
+    CHECK_MSG(odd == 0, "%u Hz @ %u mHz: %u quotas not %u or %u packets", sample_rate, frame_rate_mhz, odd, lo, lo + 1);
+    CHECK_MSG(drift == 0, "%u Hz @ %u mHz: running total off in %u frames", sample_rate, frame_rate_mhz, drift);
+    CHECK(total == packets_due(sample_rate, frame_rate_mhz, frames));
+}
+
+static void test_debt_limit(void)
+{
+    audio_cadence_t c;
+    audio_cadence_init(&c, 48000, 60000);
+    audio_cadence_frame(&c, 0);
+
+    // Half a frame released: 100 owed, 8 carried over, 92 written off
+    for (int i = 0; i < 100; i++) {
+        audio_cadence_release(&c);
+    }
+    CHECK(audio_cadence_frame(&c, 1) == 100);
+    CHECK(c.debt == AUDIO_CADENCE_MAX_DEBT);
+    CHECK(c.packets_missed == 100 - AUDIO_CADENCE_MAX_DEBT);
+    CHECK(c.frames_short == 1);
+
+    // Nothing released: debt plus the whole quota owed, limit again
+    CHECK(audio_cadence_frame(&c, 2) == AUDIO_CADENCE_MAX_DEBT + 200);
+    CHECK(c.debt == AUDIO_CADENCE_MAX_DEBT);
+    CHECK(c.packets_missed == 100 - AUDIO_CADENCE_MAX_DEBT + 200);
+
+    // Debt and quota both paid: clean again
+    CHECK(release_all(&c) == AUDIO_CADENCE_MAX_DEBT + 200);
+    CHECK(audio_cadence_frame(&c, 3) == 0);
+    CHECK(c.debt == 0 && c.frames_short == 2);
+
+    // Short by less than the limit: all of it carried, nothing written off
+    uint32_t missed = c.packets_missed;
+    for (int i = 0; i < 195; i++) {
+        audio_cadence_release(&c);
+    }
+    CHECK(audio_cadence_frame(&c, 4) == 5);
+    CHECK(c.debt == 5 && c.packets_missed == missed);
+}
+
+static void test_stall(uint32_t sample_rate, uint32_t frame_rate_mhz, uint32_t gap)
+{
+    // `ref` sees every frame, `c` misses gap - 1 of them
+    audio_cadence_t c, ref;
+    audio_cadence_init(&c, sample_rate, frame_rate_mhz);
+    audio_cadence_init(&ref, sample_rate, frame_rate_mhz);
+    audio_cadence_frame(&c, 0);
+    audio_cadence_frame(&ref, 0);
+    for (uint32_t f = 1; f <= 3; f++) {
+        release_all(&c);
+        release_all(&ref);
+        audio_cadence_frame(&c, f);
+        audio_cadence_frame(&ref, f);
+    }
+
+    // Frame 3 fully released, frames 4 .. 2 + gap never seen
+    release_all(&c);
+    for (uint32_t f = 4; f <= 3 + gap; f++) {
+        release_all(&ref);
+        audio_cadence_frame(&ref, f);
+    }
+    uint32_t owed = audio_cadence_frame(&c, 3 + gap);
+
+    // Quotas of the frames 4 .. 2 + gap (frame f holds the quota ending at f + 1)
+    uint64_t due = packets_due(sample_rate, frame_rate_mhz, 3 + gap) - packets_due(sample_rate, frame_rate_mhz, 4);
+    CHECK_MSG(owed == due, "gap %u: owed %u, expected %llu", gap, owed, (unsigned long long)due);
+    CHECK(c.frames_short == 1);
+    CHECK_MSG(c.packets_missed == (due > AUDIO_CADENCE_MAX_DEBT ? due - AUDIO_CADENCE_MAX_DEBT : 0),
+              "gap %u: %u packets missed of %llu owed", gap, c.packets_missed, (unsigned long long)due);
+    CHECK(c.debt == (due < AUDIO_CADENCE_MAX_DEBT ? due : AUDIO_CADENCE_MAX_DEBT));
+
+    // The carry is where it would be without the stall
+    CHECK(c.carry == ref.carry);
+    CHECK(c.frame_packets == ref.frame_packets);
+}
+
+static void test_allowance(void)
+{
+    audio_cadence_t c;
+    audio_cadence_init(&c, 48000, 60000);
+    audio_cadence_frame(&c, 0);
+    audio_cadence_frame(&c, 1); // Nothing released: debt at the limit
+
+    // Debt and the first packet are due at once
+    CHECK(audio_cadence_allowance(&c, 0, PERIOD) == AUDIO_CADENCE_MAX_DEBT + 1);
+    for (int i = 0; i < AUDIO_CADENCE_MAX_DEBT; i++) {
+        audio_cadence_release(&c);
+    }
+
+    // Then packet k at exactly k * PERIOD / 200, one at a time
+    uint32_t late = 0, burst = 0, quarter[4] = {0};
+    uint32_t k = 0;
+    for (uint32_t t = 0; t < PERIOD; t++) {
+        uint32_t n = audio_cadence_allowance(&c, t, PERIOD);
+        burst += n > 1;
+        if (n > 0) {
+            late += t != k * PERIOD / 200;
+            quarter[t * 4 / PERIOD]++;
+            audio_cadence_release(&c);
+            k++;
+        }
+    }
+    CHECK(k == 200);
+    CHECK_MSG(late == 0 && burst == 0, "%u packets off schedule, %u bursts", late, burst);
+    for (int i = 0; i < 4; i++) {
+        CHECK_MSG(quarter[i] == 50, "quarter %d released %u packets", i, quarter[i]);
+    }
+    CHECK(audio_cadence_allowance(&c, PERIOD, PERIOD) == 0);
+    CHECK(audio_cadence_allowance(&c, PERIOD * 2, PERIOD) == 0);
+    CHECK(audio_cadence_frame(&c, 2) == 0);
+
+    // Zero period (timing unknown): the whole quota at once
+    CHECK(audio_cadence_allowance(&c, 0, 0) == 200);
+}
+
+int main(void)
+{
+    test_integer_rate();
+    test_fractional_carry(44100, 60000);
+    test_fractional_carry(48000, 59940);
+    test_fractional_carry(32000, 59185);
+    test_debt_limit();
+    test_stall(48000, 60000, 2);
+    test_stall(48000, 60000, 4);
+    test_stall(44100, 60000, 30);
+    test_stall(48000, 59940, 600);
+    test_allowance();
+    return test_finish("test_audio_cadence");
+}
@@ -0,0 +1,177 @@
+/**
+ * Audio pipeline output accounting on a simulated clock.
+ *
+ * The I2S words go in through the PIO FIFO and DMA stubs, and
+ * audio_pipeline_process_slice() runs them through the stages. The output
+ * callback stands in for the encoder: it counts the samples it was handed,
+ * and the test retires them with audio_pipeline_note_output() at chosen
+ * times. Checks:
+ * - the latency probe follows the tagged sample through a sliced run and
+ *   lands in the right histogram bucket (the last bucket is open-ended)
+ * - a probe that never retires is dropped after PROBE_TIMEOUT_US (1 s), so
+ *   no stale latency is recorded, and the next capture starts a new probe
+ * - the occupancy high-water marks
+ * - output_underruns counts only the pushes reported as underruns
+ */
+
+#include "audio_pipeline.h"
+#include "hardware/dma.h"
+#include "pico/time.h"
+#include "test_common.h"
+
+static audio_pipeline_t g_pipeline;
+static uint32_t g_produced; // Samples handed to the output callback
+
+static void output(const audio_sample_t *samples, uint32_t count, void *ctx)
+{
+    g_produced += count;
+}
+
+// The PIO captures `frames` stereo frames (packed words) and the DMA lands them
+static void capture(uint32_t frames)
+{
+    static uint32_t seed = 0x41505031;
+    for (uint32_t i = 0; i < frames; i++) {
+        pio0->rxf[0] = test_rand(&seed);
+        host_dma_transfer((uint)g_pipeline.capture.dma_chan, 1);
+    }
+}
+
+static void start_pipeline(void)
+{
+    const audio_pipeline_config_t config = {
+        .pin_bck = 24,
+        .pin_dat = 22,
+        .pin_ws = 23,
+        .pin_btn1 = AUDIO_BTN1_PIN,
+        .pin_btn2 = AUDIO_BTN2_PIN,
+        .pio = pio0,
+        .sm = 0,
+    };
+    host_time_set_us(0);
+    CHECK(audio_pipeline_init(&g_pipeline, &config));
+    audio_pipeline_start(&g_pipeline);
+    g_produced = 0;
+}
+
+static audio_pipeline_status_t status(void)
+{
+    audio_pipeline_status_t s;
+    audio_pipeline_get_status(&g_pipeline, &s);
+    return s;
+}
+
+static void test_latency_histogram(void)
+{
+    start_pipeline();
+
+    // 200 frames captured at 1 ms, processed 64 at a time: the probe is the
+    // newest of them, so it is not through until the last slice
+    host_time_set_us(1000);
+    capture(200);
+    uint32_t left = audio_pipeline_process_slice(&g_pipeline, 64, output, NULL);
+    CHECK(left == 136);
+    audio_pipeline_note_output(&g_pipeline, g_produced, 0, 0, false);
+    CHECK(status().latency_samples == 0);
+
+    host_time_set_us(1500);
+    while (audio_pipeline_process_slice(&g_pipeline, 64, output, NULL) > 0) {
+    }
+
+    // Only part of the output has left: still in flight
+    host_time_set_us(3000);
+    const uint32_t collect_peak = g_produced;
+    audio_pipeline_note_output(&g_pipeline, g_produced - 1, collect_peak, 2, false);
+    CHECK(status().latency_samples == 0);
+
+    // The last sample leaves 3.5 ms after the capture was seen: bucket 3
+    host_time_set_us(4500);
+    audio_pipeline_note_output(&g_pipeline, g_produced, 0, 3, false);
+    audio_pipeline_status_t s = status();
+    CHECK(s.latency_samples == 1);
+    CHECK(s.latency_us_last == 3500 && s.latency_us_min == 3500 && s.latency_us_max == 3500);
+    CHECK(s.latency_hist[3] == 1);
+
+    // Next probe: 40 ms, past the last bucket, counted in it
+    capture(100);
+    audio_pipeline_process_slice(&g_pipeline, UINT32_MAX, output, NULL);
+    host_time_set_us(44500);
+    audio_pipeline_note_output(&g_pipeline, g_produced, 0, 1, false);
+    s = status();
+    CHECK(s.latency_samples == 2);
+    CHECK(s.latency_us_min == 3500 && s.latency_us_max == 40000);
+    CHECK(s.latency_hist[AUDIO_LATENCY_BUCKETS - 1] == 1);
+
+    uint32_t total = 0;
+    for (int b = 0; b < AUDIO_LATENCY_BUCKETS; b++) {
+        total += s.latency_hist[b];
+    }
+    CHECK(total == s.latency_samples);
+
+    // High-water marks: capture ring at 200, one 64-sample block out, the
+    // largest levels reported with the retirements
+    CHECK(s.capture_ring_max == 200);
+    CHECK(s.process_out_max > 0 && s.process_out_max <= 64);
+    CHECK(s.collect_max == collect_peak);
+    CHECK(s.queue_max == 3);
+}
+
+static void test_probe_timeout(void)
+{
+    start_pipeline();
+
+    // Tagged and processed at 10 ms, but its output never retires
+    host_time_set_us(10000);
+    capture(100);
+    audio_pipeline_process_slice(&g_pipeline, UINT32_MAX, output, NULL);
+    uint32_t stuck = g_produced;
+    audio_pipeline_note_output(&g_pipeline, 0, stuck, 0, false);
+
+    // Just inside the timeout it is still waiting
+    host_time_set_us(10000 + 1000000);
+    audio_pipeline_process_slice(&g_pipeline, UINT32_MAX, output, NULL);
+    CHECK(g_pipeline.probe_state != 0); // Not PROBE_IDLE
+
+    // Past it the next slice drops it: the late retirement records nothing
+    host_time_set_us(10000 + 1000001);
+    audio_pipeline_process_slice(&g_pipeline, UINT32_MAX, output, NULL);
+    audio_pipeline_note_output(&g_pipeline, stuck, 0, 0, false);
+    CHECK(status().latency_samples == 0);
+
+    // A new capture starts a fresh probe, timed from its own capture
+    host_time_set_us(2000000);
+    capture(100);
+    audio_pipeline_process_slice(&g_pipeline, UINT32_MAX, output, NULL);
+    host_time_set_us(2002250);
+    audio_pipeline_note_output(&g_pipeline, g_produced, 0, 0, false);
+    audio_pipeline_status_t s = status();
+    CHECK(s.latency_samples == 1);
+    CHECK_MSG(s.latency_us_last == 2250, "latency %u us", s.latency_us_last);
+    CHECK(s.latency_hist[2] == 1);
+}
+
+static void test_underruns(void)
+{
+    start_pipeline();
+    capture(100);
+    audio_pipeline_process_slice(&g_pipeline, UINT32_MAX, output, NULL);
+
+    // Pushes that found the queue non-empty, then two that found it empty
+    audio_pipeline_note_output(&g_pipeline, 4, 40, 2, false);
+    audio_pipeline_note_output(&g_pipeline, 8, 36, 1, false);
+    audio_pipeline_note_output(&g_pipeline, 12, 32, 0, true);
+    audio_pipeline_note_output(&g_pipeline, 16, 28, 0, true);
+    audio_pipeline_note_output(&g_pipeline, 20, 24, 1, false);
+    audio_pipeline_status_t s = status();
+    CHECK(s.output_underruns == 2);
+    CHECK(s.collect_max == 40 && s.queue_max == 2);
+    CHECK(s.samples_output == g_produced);
+}
+
+int main(void)
+{
+    test_latency_histogram();
+    test_probe_timeout();
+    test_underruns();
+    return test_finish("test_audio_pipeline");
+}
@@ -0,0 +1,76 @@
+/**
+ * Minimal host test helpers: checks that count failures instead of stopping,
+ * a monotonic clock for benchmarks, and CRC-32 for golden data.
+ */
+
+#ifndef TEST_COMMON_H
+#define TEST_COMMON_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+static int g_test_failures;
+
+#define CHECK(cond)                                                                                                    \
+    do {                                                                                                               \
+        if (!(cond)) {                                                                                                 \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);                                   \
+            g_test_failures++;                                                                                         \
+        }                                                                                                              \
+    } while (0)
+
+// CHECK with a printf-style explanation
+#define CHECK_MSG(cond, ...)                                                                                           \
+    do {                                                                                                               \
+        if (!(cond)) {                                                                                                 \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed: ", __FILE__, __LINE__, #cond);                                   \
+            fprintf(stderr, __VA_ARGS__);                                                                              \
+            fputc('\n', stderr);                                                                                       \
+            g_test_failures++;                                                                                         \
+        }                                                                                                              \
+    } while (0)
+
+// Exit status for main(): 0 when every check passed
+static inline int test_finish(const char *name)
+{
+    if (g_test_failures != 0) {
+        printf("%s: %d check(s) FAILED\n", name, g_test_failures);
+        return 1;
+    }
+    printf("%s: ok\n", name);
+    return 0;
+}
+
+static inline uint64_t test_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// CRC-32 (IEEE 802.3, reflected), continued from crc (start with 0)
+static inline uint32_t test_crc32(uint32_t crc, const void *data, size_t len)
+{
+    const uint8_t *p = data;
+    crc = ~crc;
+    while (len--) {
+        crc ^= *p++;
+        for (int k = 0; k < 8; k++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+// Deterministic pseudo-random stream (xorshift32) for synthetic inputs
+static inline uint32_t test_rand(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+#endif // TEST_COMMON_H
@@ -0,0 +1,239 @@
+/**
+ * Core 1 background scheduler against a modelled output loop.
+ *
+ * The DWT counter is simulated (host_cycle_count_set()) and the test stands
+ * in for video_pipeline_next_line_due() and the HDMI output loop: 200 active
+ * lines of 4000 cycles, each with a 2500-cycle scanline callback, then 45
+ * lines of blanking without callbacks. Between callbacks the loop calls the
+ * scheduler until the next line is due; a call that runs nothing costs the
+ * loop 50 cycles.
+ *
+ * Three tasks with work refilled every frame, all of it timed by advancing
+ * the counter (a call with nothing to do takes 20 cycles):
+ *   small  budget 600, takes 500: fits the ~1500 free cycles of a line
+ *   big    budget 30000, takes 28000: never fits a line, must be deferred
+ *          to the blanking
+ *   liar   budget 800, takes 2000 every 5th call: overruns, and runs late
+ *          when that happens inside an active line
+ *
+ * Checks that big only runs before video timing exists or in the blanking
+ * and still finishes its work every frame, that small is never late, and
+ * that runs, overruns, late completions and the worst call per task match
+ * what the model saw.
+ */
+
+#include "core1_sched.h"
+#include "cycle_count.h"
+#include "pico_hdmi/video_output.h"
+#include "test_common.h"
+#include "video_pipeline.h"
+
+#define FRAMES 20
+#define ACTIVE_LINES 200
+#define BLANK_LINES 45
+#define LINE_CYCLES 4000
+#define CALLBACK_CYCLES 2500
+#define IDLE_CYCLES 50
+#define NO_WORK_CYCLES 20 // A task called with nothing to do
+
+typedef struct {
+    uint32_t budget;
+    uint32_t cost;
+    uint32_t slow_cost;  // Cost of every 5th call (0 = never slow)
+    uint32_t work;       // Units per frame
+    uint32_t pending;    // Units left this frame
+    // What the model saw
+    uint32_t runs;
+    uint32_t units; // Runs that did a unit of work
+    uint32_t overruns;
+    uint32_t late;
+    uint32_t cycles_max;
+    uint32_t runs_active; // Runs started inside an active line
+    uint32_t frames_unfinished;
+} model_task_t;
+
+static model_task_t g_small = {.budget = 600, .cost = 500, .work = 150};
+static model_task_t g_big = {.budget = 30000, .cost = 28000, .work = 3};
+static model_task_t g_liar = {.budget = 800, .cost = 800, .slow_cost = 2000, .work = 40};
+
+// Output loop state seen by video_pipeline_next_line_due()
+static bool g_timing;
+static uint32_t g_line;       // Last active line called back
+static uint32_t g_line_start; // Its callback start
+static bool g_late_since_line; // A task ended past the due time since that callback
+
+static uint32_t now(void)
+{
+    return cycle_count_now();
+}
+
+static void advance(uint32_t cycles)
+{
+    host_cycle_count_set(now() + cycles);
+}
+
+// Same rule as the pipeline: the next line follows one period later, after
+// the last active line the whole blanking goes by first
+bool video_pipeline_next_line_due(uint32_t *due_cycles)
+{
+    if (!g_timing) {
+        return false;
+    }
+    uint32_t lines = g_line + 1 >= ACTIVE_LINES ? BLANK_LINES + 1 : 1;
+    *due_cycles = g_line_start + LINE_CYCLES * lines;
+    return true;
+}
+
+static bool in_blanking(void)
+{
+    return g_timing && g_line + 1 >= ACTIVE_LINES;
+}
+
+static bool model_run(model_task_t *t)
+{
+    uint32_t due = 0;
+    bool bounded = video_pipeline_next_line_due(&due);
+    bool active = g_timing && !in_blanking();
+
+    uint32_t cost = NO_WORK_CYCLES;
+    if (t->pending > 0) {
+        cost = t->slow_cost != 0 && t->units % 5 == 4 ? t->slow_cost : t->cost;
+        t->pending--;
+        t->units++;
+    }
+    advance(cost);
+    t->runs++;
+    t->overruns += cost > t->budget;
+    bool late = bounded && (int32_t)(due - now()) < 0;
+    t->late += late;
+    g_late_since_line |= late;
+    t->runs_active += active;
+    if (cost > t->cycles_max) {
+        t->cycles_max = cost;
+    }
+    return t->pending > 0;
+}
+
+static bool small_task(void)
+{
+    return model_run(&g_small);
+}
+
+static bool big_task(void)
+{
+    return model_run(&g_big);
+}
+
+static bool liar_task(void)
+{
+    return model_run(&g_liar);
+}
+
+static void check_task(int id, const model_task_t *t, const char *name)
+{
+    core1_task_stats_t s;
+    core1_sched_get_stats(id, &s);
+    CHECK_MSG(s.runs == t->runs, "%s: %u runs, model %u", name, s.runs, t->runs);
+    CHECK_MSG(s.overruns == t->overruns, "%s: %u overruns, model %u", name, s.overruns, t->overruns);
+    CHECK_MSG(s.late == t->late, "%s: %u late, model %u", name, s.late, t->late);
+    CHECK_MSG(s.cycles_max == t->cycles_max, "%s: worst %u cycles, model %u", name, s.cycles_max, t->cycles_max);
+    printf("  %-5s runs %5u (active lines %5u)  deferred %6u  overruns %3u  late %3u\n", name, s.runs, t->runs_active,
+           s.deferred, s.overruns, s.late);
+}
+
+int main(void)
+{
+    model_task_t *tasks[] = {&g_small, &g_big, &g_liar};
+    int small_id = core1_sched_add("small", small_task, g_small.budget);
+    int big_id = core1_sched_add("big", big_task, g_big.budget);
+    int liar_id = core1_sched_add("liar", liar_task, g_liar.budget);
+    CHECK(small_id == 0 && big_id == 1 && liar_id == 2);
+    CHECK(core1_sched_task_count() == 3);
+    video_output_task_fn background = host_video_output_background_task();
+    CHECK(background != NULL);
+    if (background == NULL) {
+        return test_finish("test_core1_sched");
+    }
+
+    // Before video timing is known nothing is bounded: every task runs once
+    host_cycle_count_set(0);
+    background();
+    CHECK(g_small.runs == 1 && g_big.runs == 1 && g_liar.runs == 1);
+
+    g_timing = true;
+    uint32_t callbacks_late = 0, callbacks_late_unexplained = 0;
+    bool prev_late = false;
+    uint32_t frame_start = now() + LINE_CYCLES;
+    for (int f = 0; f < FRAMES; f++) {
+        for (int i = 0; i < 3; i++) {
+            tasks[i]->frames_unfinished += f > 0 && tasks[i]->pending > 0;
+            tasks[i]->pending = tasks[i]->work;
+        }
+
+        for (uint32_t line = 0; line < ACTIVE_LINES; line++) {
+            // Scanline callback, late if the background call before it overran
+            // The due time follows the measured callback start, so one late
+            // callback can make the next one late too
+            uint32_t start = frame_start + line * LINE_CYCLES;
+            bool late = (int32_t)(now() - start) > 0;
+            if (late) {
+                callbacks_late++;
+                callbacks_late_unexplained += !g_late_since_line && !prev_late;
+                start = now();
+            }
+            prev_late = late;
+            host_cycle_count_set(start);
+            g_line = line;
+            g_line_start = start;
+            g_late_since_line = false;
+            advance(CALLBACK_CYCLES);
+
+            // Background calls until the next callback is due
+            uint32_t next = line + 1 < ACTIVE_LINES ? frame_start + (line + 1) * LINE_CYCLES
+                                                    : frame_start + (ACTIVE_LINES + BLANK_LINES) * LINE_CYCLES;
+            while ((int32_t)(next - now()) > 0) {
+                uint32_t before = now();
+                background();
+                if (now() == before) {
+                    uint32_t left = next - now();
+                    advance(left < IDLE_CYCLES ? left : IDLE_CYCLES);
+                }
+            }
+        }
+        frame_start += (ACTIVE_LINES + BLANK_LINES) * LINE_CYCLES;
+    }
+
+    printf("test_core1_sched: %d frames of %d + %d lines\n", FRAMES, ACTIVE_LINES, BLANK_LINES);
+    check_task(small_id, &g_small, "small");
+    check_task(big_id, &g_big, "big");
+    check_task(liar_id, &g_liar, "liar");
+
+    core1_task_stats_t big, small, liar;
+    core1_sched_get_stats(big_id, &big);
+    core1_sched_get_stats(small_id, &small);
+    core1_sched_get_stats(liar_id, &liar);
+
+    // big never fits a line: deferred there, run in the blanking, done every frame
+    CHECK(big.deferred > 0);
+    CHECK_MSG(g_big.runs_active == 0, "big ran %u times inside active lines", g_big.runs_active);
+    CHECK(g_big.units == FRAMES * g_big.work);
+    CHECK(g_big.frames_unfinished == 0 && g_big.pending == 0);
+    CHECK(big.late == 0 && big.overruns == 0);
+
+    // small fits the lines and never runs past a deadline
+    CHECK(g_small.runs_active > 0);
+    CHECK(small.late == 0 && small.overruns == 0);
+    CHECK(g_small.frames_unfinished == 0);
+
+    // liar's slow calls are overruns, the ones inside active lines also late
+    CHECK(liar.overruns > 0 && liar.overruns == g_liar.units / 5);
+    CHECK(liar.late > 0 && liar.late <= liar.overruns);
+
+    // A scanline callback only starts late after a late completion (or a late
+    // callback before it)
+    CHECK(callbacks_late > 0);
+    CHECK_MSG(callbacks_late_unexplained == 0, "%u of %u late callbacks without a late task", callbacks_late_unexplained,
+              callbacks_late);
+
+    return test_finish("test_core1_sched");
+}
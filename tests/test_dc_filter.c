@@ -0,0 +1,167 @@
+/**
+ * DC blocker residual: no standing offset left by rounding.
+ *
+ * The fixed-point blocker truncates alpha * y[n-1] every sample. Without the
+ * error feedback in dc_filter_step() that bias builds up to a constant
+ * offset of about -1000 LSB (1 / (1 - alpha) times -0.5 LSB) for any input.
+ * Checked here:
+ * - constant inputs from 1 LSB to near full scale, both signs, on both
+ *   channels at once: after settling every output sample is within 1 LSB
+ *   of zero and the mean is within 0.25 LSB
+ * - an offset that steps mid-stream settles again
+ * - low-level noise on an offset comes out with zero mean and its level
+ *   intact (no deadband)
+ * - the per-sample and buffer entry points give identical output
+ * - disabling resets the state, including the carried fraction
+ *
+ * Built as well with AUDIO_DC_FLOAT=1 for the float blocker.
+ */
+
+#include "dc_filter.h"
+#include "test_common.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SAMPLES 60000
+#define SETTLE 40000 // About 20 time constants of the ~10 Hz corner
+
+static audio_sample_t g_buf[SAMPLES];
+
+static void fill(int16_t left, int16_t right, uint32_t from, uint32_t to)
+{
+    for (uint32_t n = from; n < to; n++) {
+        g_buf[n].left = left;
+        g_buf[n].right = right;
+    }
+}
+
+// Residual of each channel over [from, to): largest |y| and the mean
+static void residual(uint32_t from, uint32_t to, int *max_l, int *max_r, double *mean_l, double *mean_r)
+{
+    double sl = 0, sr = 0;
+    *max_l = *max_r = 0;
+    for (uint32_t n = from; n < to; n++) {
+        *max_l = abs(g_buf[n].left) > *max_l ? abs(g_buf[n].left) : *max_l;
+        *max_r = abs(g_buf[n].right) > *max_r ? abs(g_buf[n].right) : *max_r;
+        sl += g_buf[n].left;
+        sr += g_buf[n].right;
+    }
+    *mean_l = sl / (to - from);
+    *mean_r = sr / (to - from);
+}
+
+static void check_settled(const char *what, uint32_t from, uint32_t to)
+{
+    int max_l, max_r;
+    double mean_l, mean_r;
+    residual(from, to, &max_l, &max_r, &mean_l, &mean_r);
+    CHECK_MSG(max_l <= 1 && max_r <= 1, "%s: residual up to %d / %d LSB", what, max_l, max_r);
+    CHECK_MSG(fabs(mean_l) < 0.25 && fabs(mean_r) < 0.25, "%s: mean residual %+.2f / %+.2f LSB", what, mean_l,
+              mean_r);
+}
+
+static void test_constant(int16_t offset)
+{
+    dc_filter_t dc;
+    dc_filter_init(&dc);
+    dc_filter_set_enabled(&dc, true);
+    fill(offset, (int16_t)-offset, 0, SAMPLES);
+    dc_filter_process_buffer(&dc, g_buf, SAMPLES);
+
+    char what[32];
+    snprintf(what, sizeof(what), "offset %+d", offset);
+    check_settled(what, SETTLE, SAMPLES);
+}
+
+static void test_step(void)
+{
+    dc_filter_t dc;
+    dc_filter_init(&dc);
+    dc_filter_set_enabled(&dc, true);
+
+    // +2000 / -300, then -500 / +12000, processed in pipeline-sized blocks
+    fill(2000, -300, 0, SAMPLES / 2);
+    fill(-500, 12000, SAMPLES / 2, SAMPLES);
+    for (uint32_t n = 0; n < SAMPLES; n += 64) {
+        dc_filter_process_buffer(&dc, &g_buf[n], SAMPLES - n < 64 ? SAMPLES - n : 64);
+    }
+    check_settled("before the step", SAMPLES / 2 - 5000, SAMPLES / 2);
+    check_settled("after the step", SAMPLES - 5000, SAMPLES);
+}
+
+static void test_quiet_noise(void)
+{
+    dc_filter_t dc;
+    dc_filter_init(&dc);
+    dc_filter_set_enabled(&dc, true);
+
+    // +/-8 LSB of white noise on +1000 / -1000
+    uint32_t seed = 0x44434631;
+    double in_power = 0;
+    for (uint32_t n = 0; n < SAMPLES; n++) {
+        int16_t v = (int16_t)((int32_t)(test_rand(&seed) % 17) - 8);
+        g_buf[n].left = (int16_t)(1000 + v);
+        g_buf[n].right = (int16_t)(-1000 - v);
+        if (n >= SETTLE) {
+            in_power += (double)v * v;
+        }
+    }
+    dc_filter_process_buffer(&dc, g_buf, SAMPLES);
+
+    double mean_l = 0, mean_r = 0, out_power = 0;
+    for (uint32_t n = SETTLE; n < SAMPLES; n++) {
+        mean_l += g_buf[n].left;
+        mean_r += g_buf[n].right;
+        out_power += (double)g_buf[n].left * g_buf[n].left;
+    }
+    mean_l /= SAMPLES - SETTLE;
+    mean_r /= SAMPLES - SETTLE;
+    double level_db = 10 * log10(out_power / in_power);
+    printf("DC blocker, +/-8 LSB noise on +/-1000: mean %+.3f / %+.3f LSB, level %+.2f dB\n", mean_l, mean_r,
+           level_db);
+    CHECK_MSG(fabs(mean_l) < 0.25 && fabs(mean_r) < 0.25, "noise: mean residual %+.3f / %+.3f LSB", mean_l, mean_r);
+    CHECK_MSG(fabs(level_db) < 0.5, "noise level changed by %+.2f dB", level_db);
+}
+
+static void test_entry_points(void)
+{
+    static audio_sample_t single[SAMPLES / 4];
+    dc_filter_t a, b;
+    dc_filter_init(&a);
+    dc_filter_init(&b);
+    dc_filter_set_enabled(&a, true);
+    dc_filter_set_enabled(&b, true);
+
+    uint32_t seed = 0x44434632;
+    for (uint32_t n = 0; n < SAMPLES / 4; n++) {
+        g_buf[n].left = (int16_t)(3000 + (int16_t)(test_rand(&seed) >> 20));
+        g_buf[n].right = (int16_t)test_rand(&seed);
+    }
+    memcpy(single, g_buf, sizeof(single));
+    dc_filter_process_buffer(&a, g_buf, SAMPLES / 4);
+    for (uint32_t n = 0; n < SAMPLES / 4; n++) {
+        dc_filter_process(&b, &single[n]);
+    }
+    CHECK(memcmp(single, g_buf, sizeof(single)) == 0);
+
+    // Off and on again: the same as a fresh filter
+    dc_filter_set_enabled(&a, false);
+    dc_filter_set_enabled(&a, true);
+    dc_filter_init(&b);
+    dc_filter_set_enabled(&b, true);
+    CHECK(memcmp(&a.state, &b.state, sizeof(a.state)) == 0);
+}
+
+int main(void)
+{
+    static const int16_t offsets[] = {1, -1, 7, -7, 100, 2000, -2000, 30000, -30000};
+    for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++) {
+        test_constant(offsets[i]);
+    }
+    test_step();
+    test_quiet_noise();
+    test_entry_points();
+    return test_finish(AUDIO_DC_FLOAT ? "test_dc_filter_float" : "test_dc_filter");
+}
@@ -0,0 +1,206 @@
+/**
+ * Bit-exact regression of the fixed-point audio stages against stored goldens.
+ *
+ * A 2 s synthetic input at the MVS rate is run through each stage
+ * configuration in blocks of 1..64 samples, with the SRC ratio moved around
+ * the nominal one as the rate controller does. The output is compared
+ * with tests/golden/dsp_<case>.crc, one CRC-32 per 1024 output samples:
+ *
+ *   dc                   DC blocker
+ *   lowpass              biquad cascade
+ *   src_linear           SRC alone, LINEAR
+ *   src_polyphase        SRC alone, POLYPHASE
+ *   staged_linear        DC -> lowpass -> SRC as separate passes, LINEAR
+ *   staged_polyphase     the same, POLYPHASE
+ *   fused_linear         src_process_fused(), LINEAR
+ *   fused_polyphase      src_process_fused(), POLYPHASE
+ *
+ * The goldens are the output of the scalar code from before the packed-pair
+ * / SMLAD rework (6770315^): this file was built against those sources and
+ * run with --update. In the cases that include the DC blocker, that code
+ * got the DC error feedback (b16b2eb) first, because the feedback changes
+ * the output on purpose. lowpass, src_linear and src_polyphase are
+ * untouched old output.
+ *
+ * The input is integer-only (triangles, a square burst that saturates, a
+ * DC offset and xorshift noise), so the goldens do not depend on libm.
+ *
+ *   test_dsp_golden            compare against the goldens
+ *   test_dsp_golden --update   rewrite them from the code being built
+ */
+
+#include "dc_filter.h"
+#include "lowpass.h"
+#include "src.h"
+#include "test_common.h"
+
+#include <string.h>
+
+#define INPUT_SAMPLES (2 * SRC_INPUT_RATE_DEFAULT)
+#define BLOCK_MAX 64
+#define CRC_CHUNK 1024
+
+typedef enum { STAGE_DC, STAGE_LOWPASS, STAGE_SRC, STAGE_STAGED, STAGE_FUSED } stage_t;
+
+typedef struct {
+    const char *name;
+    stage_t stage;
+    src_mode_t mode;
+} golden_case_t;
+
+static const golden_case_t g_cases[] = {
+    {"dc", STAGE_DC, SRC_MODE_LINEAR},
+    {"lowpass", STAGE_LOWPASS, SRC_MODE_LINEAR},
+    {"src_linear", STAGE_SRC, SRC_MODE_LINEAR},
+    {"src_polyphase", STAGE_SRC, SRC_MODE_POLYPHASE},
+    {"staged_linear", STAGE_STAGED, SRC_MODE_LINEAR},
+    {"staged_polyphase", STAGE_STAGED, SRC_MODE_POLYPHASE},
+    {"fused_linear", STAGE_FUSED, SRC_MODE_LINEAR},
+    {"fused_polyphase", STAGE_FUSED, SRC_MODE_POLYPHASE},
+};
+
+static audio_sample_t g_input[INPUT_SAMPLES];
+static audio_sample_t g_output[INPUT_SAMPLES];
+static bool g_update;
+
+// Triangle wave, +/-amplitude, period in samples
+static int32_t triangle(uint32_t n, uint32_t period, int32_t amplitude)
+{
+    uint32_t p = n % period;
+    int32_t ramp = (int32_t)((4 * (uint64_t)amplitude * p) / period);
+    return p < period / 2 ? ramp - amplitude : 3 * amplitude - ramp;
+}
+
+static int16_t clamp16(int32_t v)
+{
+    return (int16_t)(v > 32767 ? 32767 : v < -32768 ? -32768 : v);
+}
+
+static void make_input(void)
+{
+    uint32_t seed = 0x44535031;
+    for (uint32_t n = 0; n < INPUT_SAMPLES; n++) {
+        int32_t noise = (int32_t)(test_rand(&seed) & 0xFFF) - 0x800;
+        int32_t l = triangle(n, 56, 9000) + triangle(n, 5, 4000) + 1500 + noise;
+        int32_t r = triangle(n, 127, 14000) - triangle(n, 3, 2500) - 800 - noise / 2;
+        // 2000-sample full-scale square bursts every half second
+        if (n % (SRC_INPUT_RATE_DEFAULT / 2) < 2000) {
+            int32_t sq = (n / 40) & 1 ? 32767 : -32768;
+            l = sq;
+            r = -sq;
+        }
+        g_input[n].left = clamp16(l);
+        g_input[n].right = clamp16(r);
+    }
+}
+
+// Run one case over the whole input, returns the output sample count
+static uint32_t run_case(const golden_case_t *c)
+{
+    static audio_sample_t block[BLOCK_MAX];
+    dc_filter_t dc;
+    lowpass_t lp;
+    src_t src;
+    dc_filter_init(&dc);
+    dc_filter_set_enabled(&dc, true);
+    lowpass_init(&lp, SRC_INPUT_RATE_DEFAULT, LOWPASS_CUTOFF_HZ);
+    lowpass_set_enabled(&lp, true);
+    src_init(&src, SRC_INPUT_RATE_DEFAULT, SRC_OUTPUT_RATE_DEFAULT);
+    src_set_mode(&src, c->mode);
+    if (c->stage == STAGE_FUSED) {
+        CHECK_MSG(src_fused_supported(&src, &dc, &lp), "%s: fused kernel not available", c->name);
+    }
+
+    const uint32_t nominal = src.step;
+    uint32_t seed = 0x424C4B31;
+    uint32_t out = 0;
+    for (uint32_t n = 0, blocks = 0; n < INPUT_SAMPLES; blocks++) {
+        uint32_t count = test_rand(&seed) % BLOCK_MAX + 1;
+        if (count > INPUT_SAMPLES - n) {
+            count = INPUT_SAMPLES - n;
+        }
+        // Ratio within +/-200 ppm of nominal, moved every 16 blocks
+        if (blocks % 16 == 0) {
+            int32_t ppm = (int32_t)(test_rand(&seed) % 401) - 200;
+            src_set_step(&src, nominal + (uint32_t)((int64_t)nominal * ppm / 1000000));
+        }
+        memcpy(block, &g_input[n], count * sizeof(block[0]));
+        n += count;
+
+        uint32_t consumed = 0;
+        switch (c->stage) {
+        case STAGE_DC:
+            dc_filter_process_buffer(&dc, block, count);
+            memcpy(&g_output[out], block, count * sizeof(block[0]));
+            out += count;
+            break;
+        case STAGE_LOWPASS:
+            lowpass_process_buffer(&lp, block, count);
+            memcpy(&g_output[out], block, count * sizeof(block[0]));
+            out += count;
+            break;
+        case STAGE_STAGED:
+            dc_filter_process_buffer(&dc, block, count);
+            lowpass_process_buffer(&lp, block, count);
+            // fall through
+        case STAGE_SRC:
+            out += src_process(&src, block, count, &g_output[out], BLOCK_MAX, &consumed);
+            CHECK(consumed == count);
+            break;
+        case STAGE_FUSED:
+            out += src_process_fused(&src, &dc, &lp, block, count, &g_output[out], BLOCK_MAX, &consumed);
+            CHECK(consumed == count);
+            break;
+        }
+    }
+    return out;
+}
+
+// Compare (or with --update, write) the chunk CRCs of g_output
+static void check_golden(const golden_case_t *c, uint32_t count)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/dsp_%s.crc", NEOPICO_TEST_GOLDEN_DIR, c->name);
+    FILE *f = fopen(path, g_update ? "w" : "r");
+    CHECK_MSG(f != NULL, "cannot open %s", path);
+    if (f == NULL) {
+        return;
+    }
+
+    unsigned golden_count = 0;
+    if (g_update) {
+        fprintf(f, "%u\n", count);
+    } else if (fscanf(f, "%u", &golden_count) != 1 || golden_count != count) {
+        CHECK_MSG(false, "%s: %u output samples, golden %u", c->name, count, golden_count);
+        fclose(f);
+        return;
+    }
+    for (uint32_t i = 0; i < count; i += CRC_CHUNK) {
+        uint32_t n = count - i < CRC_CHUNK ? count - i : CRC_CHUNK;
+        uint32_t crc = test_crc32(0, &g_output[i], n * sizeof(g_output[0]));
+        if (g_update) {
+            fprintf(f, "%08x\n", crc);
+            continue;
+        }
+        unsigned golden = 0;
+        if (fscanf(f, "%x", &golden) != 1 || golden != crc) {
+            CHECK_MSG(false, "%s: output samples %u..%u differ from the golden", c->name, i, i + n - 1);
+            break;
+        }
+    }
+    fclose(f);
+}
+
+int main(int argc, char **argv)
+{
+    g_update = argc > 1 && strcmp(argv[1], "--update") == 0;
+    make_input();
+    for (size_t i = 0; i < sizeof(g_cases) / sizeof(g_cases[0]); i++) {
+        uint32_t count = run_case(&g_cases[i]);
+        check_golden(&g_cases[i], count);
+        if (g_update) {
+            printf("%-18s %u samples written\n", g_cases[i].name, count);
+        }
+    }
+    return test_finish("test_dsp_golden");
+}
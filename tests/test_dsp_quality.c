@@ -0,0 +1,82 @@
+/**
+ * Audio DSP quality limits, whichever stage arithmetic is built.
+ *
+ * The same check runs on the fixed-point build and on the float builds
+ * (AUDIO_DC_FLOAT, AUDIO_LOWPASS_FLOAT, AUDIO_SRC_FLOAT, and all three), so
+ * switching a stage between fixed and float cannot lose quality unnoticed:
+ *  - THD+N of the full DC + lowpass + SRC chain as audio_dsp_bench_thdn()
+ *    measures it on target (1 kHz at -6 dBFS), in LINEAR and POLYPHASE
+ *  - the DC blocker on a quiet tone riding on an offset: the offset has to
+ *    go completely (no standing bias from rounding) and the tone has to pass
+ *    at unity gain
+ */
+
+#include "audio_dsp.h"
+#include "dc_filter.h"
+#include "test_common.h"
+
+#include <math.h>
+
+#define PI 3.14159265358979
+
+// Measured -66.4 (LINEAR) and -65.6 to -65.7 dB (POLYPHASE) on every build
+#define THDN_LINEAR_MAX_DB10 (-620)
+#define THDN_POLYPHASE_MAX_DB10 (-620)
+
+#define DC_SAMPLES 60000
+#define DC_SETTLE 30000
+#define DC_OFFSET 2000
+#define DC_TONE_HZ 1000.0
+#define DC_TONE_AMPLITUDE 164.0 // -46 dBFS
+
+static audio_sample_t g_buf[DC_SAMPLES];
+
+static void test_chain_thdn(void)
+{
+    int32_t linear = audio_dsp_bench_thdn(SRC_MODE_LINEAR);
+    int32_t poly = audio_dsp_bench_thdn(SRC_MODE_POLYPHASE);
+    printf("THD+N 1 kHz -6 dBFS: LINEAR %.1f dB, POLYPHASE %.1f dB\n", linear / 10.0, poly / 10.0);
+    CHECK_MSG(linear <= THDN_LINEAR_MAX_DB10, "LINEAR chain THD+N %.1f dB", linear / 10.0);
+    CHECK_MSG(poly <= THDN_POLYPHASE_MAX_DB10, "POLYPHASE chain THD+N %.1f dB", poly / 10.0);
+}
+
+static void test_dc_quiet_tone(void)
+{
+    dc_filter_t dc;
+    dc_filter_init(&dc);
+    dc_filter_set_enabled(&dc, true);
+
+    const double w = 2 * PI * DC_TONE_HZ / AUDIO_INPUT_RATE;
+    for (int n = 0; n < DC_SAMPLES; n++) {
+        int16_t v = (int16_t)lrint(DC_OFFSET + DC_TONE_AMPLITUDE * sin(w * n));
+        g_buf[n].left = v;
+        g_buf[n].right = (int16_t)(2 * DC_OFFSET - v); // Inverted tone, same offset
+    }
+    dc_filter_process_buffer(&dc, g_buf, DC_SAMPLES);
+
+    double mean_l = 0, mean_r = 0, ys = 0, yc = 0;
+    for (int n = DC_SETTLE; n < DC_SAMPLES; n++) {
+        mean_l += g_buf[n].left;
+        mean_r += g_buf[n].right;
+        ys += g_buf[n].left * sin(w * n);
+        yc += g_buf[n].left * cos(w * n);
+    }
+    mean_l /= DC_SAMPLES - DC_SETTLE;
+    mean_r /= DC_SAMPLES - DC_SETTLE;
+    double gain_db = 20 * log10(2.0 / (DC_SAMPLES - DC_SETTLE) * hypot(ys, yc) / DC_TONE_AMPLITUDE);
+    printf("DC blocker, -46 dBFS tone on +%d: residual DC %+.2f / %+.2f LSB, tone %+.3f dB\n", DC_OFFSET, mean_l,
+           mean_r, gain_db);
+
+    CHECK_MSG(fabs(mean_l) < 1.0 && fabs(mean_r) < 1.0, "DC blocker leaves %.2f / %.2f LSB of offset", mean_l,
+              mean_r);
+    CHECK_MSG(fabs(gain_db) < 0.05, "DC blocker changes a 1 kHz tone by %.3f dB", gain_db);
+}
+
+int main(void)
+{
+    printf("stages: dc %s, lowpass %s, src %s\n", AUDIO_DC_FLOAT ? "float" : "fixed",
+           AUDIO_LOWPASS_FLOAT ? "float" : "fixed", AUDIO_SRC_FLOAT ? "float" : "fixed");
+    test_chain_thdn();
+    test_dc_quiet_tone();
+    return test_finish("test_dsp_quality");
+}
@@ -0,0 +1,185 @@
+/**
+ * Triple-buffer pacing across input/output rate ratios.
+ *
+ * Capture and scanout are simulated line by line on one timeline: an input
+ * of 262 lines per frame (240 captured after an 18-line back porch, then
+ * frame_manager_capture_done() as the completion interrupt does) against the
+ * 525-line 60 Hz output (frame_manager_output_vsync() at line 0, 480 active
+ * lines each reading source line / 2). Every captured line stamps its
+ * buffer line with the input frame number.
+ *
+ * For each ratio the checks are that no output frame is ever shown
+ * partially: all 480 lines of an output frame come from one input frame,
+ * that frame was complete when the output VSYNC took it, and capture never
+ * writes the buffer being scanned out. Frames move forward only, and the
+ * repeat/drop counters add up to what the timeline saw.
+ */
+
+#include "frame_manager.h"
+#include "test_common.h"
+#include "video_config.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#define INPUT_LINES 262
+#define INPUT_BACK_PORCH 18
+#define OUTPUT_LINES OUTPUT_V_TOTAL
+#define OUTPUT_NS 16666667u // 60 Hz
+#define SIM_OUTPUT_FRAMES 600
+
+uint16_t g_frame_buf[FRAME_BUFFER_COUNT][FRAME_WIDTH * FRAME_HEIGHT];
+
+// Input frame number (+1, 0 = never written) of each buffer line
+static uint32_t g_stamp[FRAME_BUFFER_COUNT][FRAME_HEIGHT];
+
+static int buffer_index(const uint16_t *buf)
+{
+    for (int i = 0; i < FRAME_BUFFER_COUNT; i++) {
+        if (buf == g_frame_buf[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+typedef struct {
+    uint32_t partial;       // Output frames mixing input frames or showing unfinished ones
+    uint32_t blank;         // Output frames showing the power-on buffer
+    uint32_t waiting;       // Output VSYNCs before the first capture completed
+    uint32_t torn_writes;   // Capture lines written into the displayed buffer
+    uint32_t backwards;     // Output frames older than the previous one
+    uint32_t presented;     // Output frames showing a frame not shown before
+    uint32_t repeated;      // Output frames showing the same frame again
+    uint32_t completed;     // Input frames captured
+} sim_result_t;
+
+static sim_result_t simulate(double input_hz)
+{
+    const uint64_t in_frame_ns = (uint64_t)(1e9 / input_hz);
+    const uint64_t in_line_ns = in_frame_ns / INPUT_LINES;
+    const uint64_t out_line_ns = OUTPUT_NS / OUTPUT_LINES;
+
+    sim_result_t r;
+    memset(&r, 0, sizeof(r));
+    memset(g_stamp, 0, sizeof(g_stamp));
+    frame_manager_init();
+
+    int write = frame_manager_write_index();
+    int display = -1;
+    uint32_t shown = 0, last_shown = 0;
+    bool mixed = false;
+
+    // Input starts at an arbitrary phase against the output
+    uint64_t in_next = in_line_ns * 37, out_next = 0;
+    uint32_t in_line = 0, in_frame = 0, out_line = 0, out_frames = 0;
+
+    while (out_frames < SIM_OUTPUT_FRAMES) {
+        if (in_next <= out_next) {
+            // Input line: captured lines are written, the last one completes the frame
+            if (in_line >= INPUT_BACK_PORCH && in_line < INPUT_BACK_PORCH + FRAME_HEIGHT) {
+                if (write == display) {
+                    r.torn_writes++;
+                }
+                g_stamp[write][in_line - INPUT_BACK_PORCH] = in_frame + 1;
+                if (in_line == INPUT_BACK_PORCH + FRAME_HEIGHT - 1) {
+                    write = frame_manager_capture_done();
+                    r.completed++;
+                }
+            }
+            if (++in_line == INPUT_LINES) {
+                in_line = 0;
+                in_frame++;
+            }
+            in_next += in_line_ns;
+            continue;
+        }
+
+        // Output line
+        if (out_line == 0) {
+            // Close the previous output frame
+            if (display >= 0 && out_frames > 0) {
+                if (mixed) {
+                    r.partial++;
+                }
+                if (shown == 0) {
+                    r.blank++;
+                } else if (shown < last_shown) {
+                    r.backwards++;
+                } else if (shown == last_shown) {
+                    r.repeated++;
+                } else {
+                    r.presented++;
+                }
+                last_shown = shown;
+            }
+            if (r.completed == 0) {
+                r.waiting++;
+            }
+            display = buffer_index(frame_manager_output_vsync());
+            CHECK(display >= 0);
+            shown = g_stamp[display][0];
+            mixed = false;
+            // A frame is only handed over once its last line is captured
+            if (shown != 0 && g_stamp[display][FRAME_HEIGHT - 1] != shown) {
+                r.partial++;
+            }
+            out_frames++;
+        }
+        if (out_line < OUTPUT_HEIGHT && g_stamp[display][out_line / 2] != shown) {
+            mixed = true;
+        }
+        if (++out_line == OUTPUT_LINES) {
+            out_line = 0;
+        }
+        out_next += out_line_ns;
+    }
+    return r;
+}
+
+int main(void)
+{
+    // Slow to fast input, with the rates that matter most close to 1:1
+    static const double rates[] = {
+        24.0, 30.0, 50.0, 55.0, 57.0, 59.18, 59.5, 59.94, 60.0, 60.05, 60.5, 61.0, 65.0, 75.0, 90.0, 120.0, 144.0,
+    };
+
+    printf("%8s %10s %10s %10s %10s\n", "input Hz", "completed", "presented", "repeated", "dropped");
+    for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        sim_result_t r = simulate(rates[i]);
+        frame_manager_stats_t stats;
+        frame_manager_get_stats(&stats);
+        printf("%8.2f %10u %10u %10u %10u\n", rates[i], r.completed, stats.frames_presented, stats.frames_repeated,
+               stats.frames_dropped);
+
+        CHECK_MSG(r.partial == 0, "%.2f Hz: %u partial output frames", rates[i], r.partial);
+        CHECK_MSG(r.torn_writes == 0, "%.2f Hz: %u lines captured into the displayed buffer", rates[i],
+                  r.torn_writes);
+        CHECK_MSG(r.backwards == 0, "%.2f Hz: %u output frames went backwards", rates[i], r.backwards);
+
+        // Nothing but the power-on buffer is shown before the first capture completes
+        CHECK_MSG(r.blank == r.waiting, "%.2f Hz: %u blank output frames, %u before the first capture", rates[i],
+                  r.blank, r.waiting);
+
+        // Every VSYNC either presents or repeats; the ones that showed something new
+        // are the presents (the last output frame is not closed by the loop)
+        CHECK(stats.frames_presented + stats.frames_repeated == SIM_OUTPUT_FRAMES);
+        CHECK_MSG(r.presented <= stats.frames_presented && stats.frames_presented <= r.presented + 1,
+                  "%.2f Hz: %u presents seen, %u counted", rates[i], r.presented, stats.frames_presented);
+        // Completed frames are shown once, dropped, or still waiting (at most one)
+        uint32_t accounted = stats.frames_presented + stats.frames_dropped;
+        CHECK_MSG(accounted == r.completed || accounted + 1 == r.completed, "%.2f Hz: %u completed, %u accounted",
+                  rates[i], r.completed, accounted);
+
+        // Pacing: slower input repeats, faster input drops, never both at steady rates
+        // (repeats while waiting for the first capture do not count)
+        if (rates[i] < 59.0) {
+            CHECK(stats.frames_dropped == 0);
+        }
+        if (rates[i] > 61.0) {
+            CHECK_MSG(stats.frames_repeated <= r.blank, "%.2f Hz: %u repeats", rates[i], stats.frames_repeated);
+        }
+    }
+
+    return test_finish("test_frame_manager");
+}
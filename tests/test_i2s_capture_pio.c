@@ -0,0 +1,137 @@
+/**
+ * i2s_capture_packed on the PIO model: one word per stereo frame, right in
+ * bits 31:16 and left in bits 15:0, so a DMA write of the word is an
+ * audio_sample_t in memory. The same bit stream also runs through the
+ * unpacked i2s_capture program, whose low 16 bits per channel are what
+ * i2s_capture_poll() kept before; both must agree sample for sample.
+ *
+ * The bus is the MV1C's right-justified format: WS low = right, WS high =
+ * left, 24 BCKs per channel with 8 padding bits before 16 data bits, MSB
+ * first, data changing on the BCK falling edge. The padding carries noise so
+ * a slip of one bit shows up.
+ */
+
+#include "audio_common.h"
+#include "pio_model.h"
+#include "test_common.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#define PIO_PATH NEOPICO_SRC_DIR "/audio/i2s_capture.pio"
+
+// Pins relative to in_base, as i2s_capture_sm_init() sets them up
+#define PIN_DAT 0
+#define PIN_WS 1
+#define PIN_BCK 2
+
+#define BITS_PER_CHANNEL 24
+#define PAD_BITS 8
+#define FRAMES 256
+
+// 8 MHz / 3 BCK at 126 MHz is about 47 system clocks per BCK
+#define CLOCKS_PER_BCK 47
+
+static int16_t g_left[FRAMES], g_right[FRAMES];
+static uint8_t g_pad[FRAMES][2];
+
+// Bus state at system clock `clk`. Frame f starts with WS falling (right
+// channel); the preceding frame index -1 is idle with WS high.
+static uint64_t i2s_gpios(uint64_t clk)
+{
+    uint64_t bit_index = clk / CLOCKS_PER_BCK;
+    bool bck_high = clk % CLOCKS_PER_BCK >= CLOCKS_PER_BCK / 2;
+
+    // One idle left channel first so the program sees a WS high -> low edge
+    if (bit_index < BITS_PER_CHANNEL) {
+        return (1u << PIN_WS) | (bck_high ? 1u << PIN_BCK : 0);
+    }
+    bit_index -= BITS_PER_CHANNEL;
+
+    uint32_t frame = (uint32_t)(bit_index / (2 * BITS_PER_CHANNEL)) % FRAMES;
+    uint32_t slot = (uint32_t)(bit_index % (2 * BITS_PER_CHANNEL));
+    bool left = slot >= BITS_PER_CHANNEL;
+    uint32_t bit = slot % BITS_PER_CHANNEL;
+
+    uint32_t value = (uint32_t)g_pad[frame][left] << 16 | (uint16_t)(left ? g_left[frame] : g_right[frame]);
+    uint32_t dat = (value >> (BITS_PER_CHANNEL - 1 - bit)) & 1;
+
+    return (dat << PIN_DAT) | (left ? 1u << PIN_WS : 0) | (bck_high ? 1u << PIN_BCK : 0);
+}
+
+static pio_model_sm_t *add_i2s_sm(pio_model_t *pio, const pio_model_program_t *prog)
+{
+    pio_model_sm_t *sm = pio_model_add_sm(pio, prog);
+    sm->in_base = 0;
+    sm->in_shift_right = false; // MSB first into bit 0, moving up
+    sm->autopush = false;
+    return sm;
+}
+
+int main(void)
+{
+    static pio_model_program_t unpacked_prog, packed_prog;
+    if (!pio_model_load(&unpacked_prog, PIO_PATH, "i2s_capture") ||
+        !pio_model_load(&packed_prog, PIO_PATH, "i2s_capture_packed")) {
+        return 1;
+    }
+
+    uint32_t seed = 0x12345678;
+    for (int i = 0; i < FRAMES; i++) {
+        g_left[i] = (int16_t)test_rand(&seed);
+        g_right[i] = (int16_t)test_rand(&seed);
+        g_pad[i][0] = (uint8_t)test_rand(&seed);
+        g_pad[i][1] = (uint8_t)test_rand(&seed);
+    }
+    // Full-scale corners
+    g_left[0] = INT16_MIN;
+    g_right[0] = INT16_MAX;
+    g_left[1] = -1;
+    g_right[1] = 0;
+
+    pio_model_t pio;
+    memset(&pio, 0, sizeof(pio));
+    pio_model_sm_t *unpacked = add_i2s_sm(&pio, &unpacked_prog);
+    pio_model_sm_t *packed = add_i2s_sm(&pio, &packed_prog);
+
+    // The idle channel, FRAMES frames, and the first half of the next
+    const uint64_t clocks = (uint64_t)CLOCKS_PER_BCK * BITS_PER_CHANNEL * (2 * FRAMES + 2);
+    for (uint64_t clk = 0; clk < clocks; clk++) {
+        pio_model_step(&pio, i2s_gpios(clk));
+    }
+
+    CHECK_MSG(pio_model_rx_level(packed) == FRAMES, "%u packed words", pio_model_rx_level(packed));
+    CHECK_MSG(pio_model_rx_level(unpacked) == 2 * FRAMES + 1, "%u unpacked words", pio_model_rx_level(unpacked));
+
+    uint32_t bad_packed = 0, bad_match = 0;
+    for (int i = 0; i < FRAMES && pio_model_rx_level(packed) != 0 && pio_model_rx_level(unpacked) >= 2; i++) {
+        uint32_t word = pio_model_rx_get(packed);
+        uint32_t raw_r = pio_model_rx_get(unpacked);
+        uint32_t raw_l = pio_model_rx_get(unpacked);
+
+        uint32_t expect = (uint32_t)(uint16_t)g_right[i] << 16 | (uint16_t)g_left[i];
+        if (word != expect && bad_packed++ == 0) {
+            printf("frame %d: packed %08x, expected %08x\n", i, word, expect);
+        }
+
+        // The unpacked program keeps all 24 bits; poll() used the low 16
+        CHECK(raw_r == ((uint32_t)g_pad[i][0] << 16 | (uint16_t)g_right[i]));
+        CHECK(raw_l == ((uint32_t)g_pad[i][1] << 16 | (uint16_t)g_left[i]));
+
+        // As the DMA leaves it in the capture ring
+        audio_sample_t s;
+        memcpy(&s, &word, sizeof(s));
+        if ((s.left != (int16_t)(raw_l & 0xFFFF) || s.right != (int16_t)(raw_r & 0xFFFF)) && bad_match++ == 0) {
+            printf("frame %d: packed L %d R %d, unpacked L %d R %d\n", i, s.left, s.right, (int16_t)raw_l,
+                   (int16_t)raw_r);
+        }
+    }
+    CHECK_MSG(bad_packed == 0, "%u packed words wrong", bad_packed);
+    CHECK_MSG(bad_match == 0, "%u frames differ from the unpacked capture", bad_match);
+
+    // The layout the packed words rely on
+    CHECK(sizeof(audio_sample_t) == sizeof(uint32_t));
+    CHECK(offsetof(audio_sample_t, left) == 0 && offsetof(audio_sample_t, right) == 2);
+
+    return test_finish("test_i2s_capture_pio");
+}
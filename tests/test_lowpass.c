@@ -0,0 +1,141 @@
+/**
+ * Lowpass frequency response against the Butterworth prototype.
+ *
+ * Sine bursts at the MVS input rate are run through lowpass_process_buffer()
+ * and the settled output is correlated with the input frequency to get the
+ * gain. It must follow the bilinear-transformed Butterworth magnitude of
+ * order 2 * LOWPASS_SECTIONS: within 0.05 dB down to -40 dB, within 1 dB
+ * further down (where 16-bit rounding starts to show). The -3 dB point has
+ * to be at the cutoff. Also checked: unity DC gain, channels processed
+ * independently, silence staying silent after a full-scale burst (no limit
+ * cycles), and the design at other rates and cutoffs.
+ *
+ * Built as well with AUDIO_LOWPASS_FLOAT=1 for the float sections.
+ */
+
+#include "lowpass.h"
+#include "test_common.h"
+
+#include <math.h>
+#include <string.h>
+
+#define SAMPLES 40000
+#define SETTLE 8000
+#define AMPLITUDE 20000.0
+#define PI 3.14159265358979
+
+static audio_sample_t g_buf[SAMPLES];
+
+// Magnitude (dB) of the digital Butterworth the design targets
+static double butterworth_db(double f, double fs, double fc)
+{
+    double w = tan(PI * f / fs) / tan(PI * fc / fs);
+    return -10.0 * log10(1.0 + pow(w, 4.0 * LOWPASS_SECTIONS));
+}
+
+// Gain (dB) of the left and right channels at f: right gets an inverted copy
+// at half amplitude so any crosstalk or shared state shows up as an error
+static void measure(double fs, double fc, double f, double *left_db, double *right_db)
+{
+    lowpass_t lp;
+    lowpass_init(&lp, (uint32_t)fs, (uint32_t)fc);
+    for (int n = 0; n < SAMPLES; n++) {
+        double s = sin(2 * PI * f * n / fs);
+        g_buf[n].left = (int16_t)lrint(AMPLITUDE * s);
+        g_buf[n].right = (int16_t)lrint(-AMPLITUDE / 2 * s);
+    }
+    lowpass_process_buffer(&lp, g_buf, SAMPLES);
+
+    double li = 0, lq = 0, ri = 0, rq = 0;
+    for (int n = SETTLE; n < SAMPLES; n++) {
+        double c = cos(2 * PI * f * n / fs), s = sin(2 * PI * f * n / fs);
+        li += g_buf[n].left * s;
+        lq += g_buf[n].left * c;
+        ri += g_buf[n].right * s;
+        rq += g_buf[n].right * c;
+    }
+    const double scale = 2.0 / (SAMPLES - SETTLE);
+    *left_db = 20 * log10(scale * hypot(li, lq) / AMPLITUDE);
+    *right_db = 20 * log10(scale * hypot(ri, rq) / (AMPLITUDE / 2));
+}
+
+static void test_response(double fs, double fc, bool print)
+{
+    static const double freqs[] = {100,   1000,  5000,  10000, 15000, 17000, 18000, 19000,
+                                   20000, 21000, 22000, 23000, 24000, 25000, 26000, 27000};
+
+    if (print) {
+        printf("fs %.0f Hz, cutoff %.0f Hz, %d sections\n", fs, fc, LOWPASS_SECTIONS);
+    }
+    for (size_t i = 0; i < sizeof(freqs) / sizeof(freqs[0]); i++) {
+        double f = freqs[i] * fc / 19000.0;
+        if (f >= fs / 2) {
+            continue;
+        }
+        double want = butterworth_db(f, fs, fc), left, right;
+        measure(fs, fc, f, &left, &right);
+        if (print) {
+            printf("  %7.0f Hz %8.2f dB  (prototype %8.2f dB)\n", f, left, want);
+        }
+
+        // Right runs 6 dB lower, so its rounding floor is reached 6 dB earlier
+        double tol = want > -40 ? 0.05 : 1.0;
+        double tol_right = want > -34 ? 0.05 : 1.0;
+        if (want > -60) {
+            CHECK_MSG(fabs(left - want) <= tol, "fs %.0f fc %.0f: %.0f Hz left %.3f dB, want %.3f dB", fs, fc, f,
+                      left, want);
+            CHECK_MSG(fabs(right - want) <= tol_right, "fs %.0f fc %.0f: %.0f Hz right %.3f dB, want %.3f dB", fs, fc,
+                      f, right, want);
+        }
+    }
+
+    double left, right;
+    measure(fs, fc, fc, &left, &right);
+    CHECK_MSG(fabs(left + 3.01) <= 0.05, "fs %.0f: %.3f dB at the cutoff", fs, left);
+}
+
+static void test_dc_and_silence(void)
+{
+    lowpass_t lp;
+    lowpass_init(&lp, AUDIO_INPUT_RATE, LOWPASS_CUTOFF_HZ);
+
+    // Unity DC gain, exactly, on both rails
+    for (int n = 0; n < SAMPLES; n++) {
+        g_buf[n].left = 1000;
+        g_buf[n].right = -32768;
+    }
+    lowpass_process_buffer(&lp, g_buf, SAMPLES);
+    CHECK(g_buf[SAMPLES - 1].left == 1000);
+    CHECK(g_buf[SAMPLES - 1].right == -32768);
+
+    // Full-scale noise, then silence: the output has to decay to exactly zero
+    uint32_t seed = 0x4C504631;
+    for (int n = 0; n < SAMPLES / 2; n++) {
+        g_buf[n].left = (int16_t)test_rand(&seed);
+        g_buf[n].right = (int16_t)test_rand(&seed);
+    }
+    memset(&g_buf[SAMPLES / 2], 0, sizeof(g_buf[0]) * SAMPLES / 2);
+    lowpass_process_buffer(&lp, g_buf, SAMPLES);
+    uint32_t nonzero = 0;
+    for (int n = SAMPLES - 1000; n < SAMPLES; n++) {
+        nonzero += g_buf[n].left != 0 || g_buf[n].right != 0;
+    }
+    CHECK_MSG(nonzero == 0, "%u non-zero samples long after the input went silent", nonzero);
+
+    // Disabled: samples pass through untouched
+    lowpass_set_enabled(&lp, false);
+    g_buf[0].left = 1234;
+    g_buf[0].right = -4321;
+    lowpass_process_buffer(&lp, g_buf, 1);
+    CHECK(g_buf[0].left == 1234 && g_buf[0].right == -4321);
+}
+
+int main(void)
+{
+    test_response(AUDIO_INPUT_RATE, LOWPASS_CUTOFF_HZ, true);
+    test_response(48000, 16000, false);
+    test_response(44100, 8000, false);
+    test_response(96000, 20000, false);
+    test_dc_and_silence();
+    return test_finish(AUDIO_LOWPASS_FLOAT ? "test_lowpass_float" : "test_lowpass");
+}
@@ -0,0 +1,72 @@
+/**
+ * OSD text rendering on the host: glyphs land in osd_framebuffer bit for bit
+ * from font8x8 (bit 7 = leftmost pixel), with clipping at the box edges.
+ */
+
+#include "font_8x8.h"
+#include "osd.h"
+#include "test_common.h"
+
+#include <string.h>
+
+// One 8x8 cell at (x, y) matches the glyph of c
+static bool cell_matches(int x, int y, char c)
+{
+    for (int row = 0; row < 8; row++) {
+        for (int col = 0; col < 8; col++) {
+            bool on = (font8x8[(uint8_t)c][row] >> (7 - col)) & 1;
+            if (osd_framebuffer[y + row][x + col] != (on ? OSD_COLOR_FG : OSD_COLOR_BG)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool box_is_clear(void)
+{
+    for (int y = 0; y < OSD_BOX_H; y++) {
+        for (int x = 0; x < OSD_BOX_W; x++) {
+            if (osd_framebuffer[y][x] != OSD_COLOR_BG) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(void)
+{
+    memset(osd_framebuffer, 0x5A, sizeof(osd_framebuffer));
+    osd_init();
+    CHECK(!osd_visible);
+    CHECK(box_is_clear());
+
+    const char *text = "NeoPico-HD 1.0";
+    osd_puts(8, 16, text);
+    for (int i = 0; text[i] != '\0'; i++) {
+        CHECK_MSG(cell_matches(8 + i * 8, 16, text[i]), "glyph %d ('%c')", i, text[i]);
+    }
+
+    // Characters outside printable ASCII render as a space
+    osd_putchar(0, 0, '\n');
+    CHECK(cell_matches(0, 0, ' '));
+
+    // A string stops at the right edge, a cell past any edge is dropped
+    osd_clear();
+    osd_puts(OSD_BOX_W - 16, 0, "ABCD");
+    CHECK(cell_matches(OSD_BOX_W - 16, 0, 'A'));
+    CHECK(cell_matches(OSD_BOX_W - 8, 0, 'B'));
+    osd_clear();
+    osd_putchar(OSD_BOX_W - 7, 0, 'X');
+    osd_putchar(0, OSD_BOX_H - 7, 'X');
+    osd_putchar(-1, 0, 'X');
+    CHECK(box_is_clear());
+
+    osd_show();
+    CHECK(osd_visible);
+    osd_toggle();
+    CHECK(!osd_visible);
+
+    return test_finish("test_osd");
+}
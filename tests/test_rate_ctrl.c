@@ -0,0 +1,155 @@
+/**
+ * Rate recovery loop convergence across source drift.
+ *
+ * Closed loop on the host: I2S input at the nominal 55.5 kHz plus a drift,
+ * the SRC turning it into output samples at the ratio rate_ctrl_update()
+ * returns, and audio_cadence draining the backlog at exactly 48 kHz spread
+ * over each 60 Hz output frame, as the encode task does. The DSP runs in
+ * bursts at random points of the frame and the backlog is read once per
+ * frame, like the control task sees it; the feed-forward gets a 0.5 s sample
+ * count with +/-1 sample of noise every 30 frames.
+ *
+ * Each drift is run from an empty backlog and from twice the target, with
+ * and without the measured feed-forward. Checks: lock within 10 s, no
+ * cadence shortfall once locked, and over the last 30 s a mean backlog
+ * within 2 packets of RATE_CTRL_TARGET_LEVEL, a mean ratio within 10 ppm
+ * of the true one and ratio jitter under 60 ppm rms.
+ */
+
+#include "audio_cadence.h"
+#include "rate_ctrl.h"
+#include "src.h"
+#include "test_common.h"
+
+#include <math.h>
+
+#define SIM_SECONDS 60
+#define SIM_FRAMES (SIM_SECONDS * 60)
+#define STEADY_FRAME (30 * 60)
+#define SLOTS 64 // Scheduling points per output frame
+#define OUTPUT_RATE SRC_OUTPUT_RATE_DEFAULT
+
+#define LOCK_FRAMES_MAX (10 * 60)
+#define LEVEL_ERROR_MAX 2.0
+#define RATIO_ERROR_PPM_MAX 10.0
+#define RATIO_JITTER_PPM_MAX 60.0
+
+typedef struct {
+    int lock_frame;
+    uint32_t short_after_lock; // Cadence frames that ended owing packets, once locked
+    double level_mean;
+    double level_sd;
+    double ratio_error_ppm;
+    double ratio_jitter_ppm;
+} sim_result_t;
+
+static sim_result_t simulate(double drift_ppm, uint32_t start_level, bool measured, uint32_t seed)
+{
+    const double input_rate = 1e6 / 18.0 * (1.0 + drift_ppm * 1e-6); // 55555.6 Hz nominal
+    sim_result_t r = {.lock_frame = -1};
+
+    rate_ctrl_t rc;
+    rate_ctrl_init(&rc, SRC_INPUT_RATE_DEFAULT, OUTPUT_RATE);
+    audio_cadence_t cad;
+    audio_cadence_init(&cad, OUTPUT_RATE, 60000);
+
+    double input_pending = 0;                       // Captured, not processed yet (samples)
+    double output = (double)start_level * AUDIO_CADENCE_SAMPLES_PER_PACKET; // SRC output not released
+    double measure_samples = 0;
+    double sum = 0, sum2 = 0, rsum = 0, rsum2 = 0;
+    uint32_t n = 0;
+
+    for (uint32_t frame = 0; frame < SIM_FRAMES; frame++) {
+        if (audio_cadence_frame(&cad, frame) > 0 && r.lock_frame >= 0) {
+            r.short_after_lock++;
+        }
+        uint32_t read_slot = test_rand(&seed) % SLOTS;
+        uint32_t level = 0;
+
+        for (uint32_t slot = 0; slot < SLOTS; slot++) {
+            input_pending += input_rate / 60 / SLOTS;
+            measure_samples += input_rate / 60 / SLOTS;
+
+            // DSP slices run when Core 1 has time: in bursts, skipping about a quarter of the slots
+            if ((test_rand(&seed) & 3) != 0) {
+                output += input_pending * SRC_STEP_ONE / rc.step;
+                input_pending = 0;
+            }
+
+            // Encode task: release what the cadence allows and the backlog holds
+            uint32_t allowed = audio_cadence_allowance(&cad, slot + 1, SLOTS);
+            while (allowed-- > 0 && output >= AUDIO_CADENCE_SAMPLES_PER_PACKET) {
+                output -= AUDIO_CADENCE_SAMPLES_PER_PACKET;
+                audio_cadence_release(&cad);
+            }
+
+            if (slot == read_slot) {
+                level = (uint32_t)(output / AUDIO_CADENCE_SAMPLES_PER_PACKET);
+            }
+        }
+
+        // Control task: feed-forward every 30 frames, then one PI step
+        if (frame % 30 == 29) {
+            uint32_t count = (uint32_t)measure_samples + test_rand(&seed) % 3 - 1;
+            measure_samples -= (uint32_t)measure_samples;
+            if (measured) {
+                rate_ctrl_set_input_rate(&rc, count * 2);
+            }
+        }
+        rate_ctrl_update(&rc, level);
+        if (rc.locked && r.lock_frame < 0) {
+            r.lock_frame = (int)frame;
+        }
+
+        if (frame >= STEADY_FRAME) {
+            double packets = output / AUDIO_CADENCE_SAMPLES_PER_PACKET;
+            double ratio = (double)rc.step / SRC_STEP_ONE;
+            sum += packets;
+            sum2 += packets * packets;
+            rsum += ratio;
+            rsum2 += ratio * ratio;
+            n++;
+        }
+    }
+
+    const double ideal = input_rate / OUTPUT_RATE;
+    double rmean = rsum / n;
+    r.level_mean = sum / n;
+    r.level_sd = sqrt(fmax(0, sum2 / n - r.level_mean * r.level_mean));
+    r.ratio_error_ppm = (rmean / ideal - 1) * 1e6;
+    r.ratio_jitter_ppm = sqrt(fmax(0, rsum2 / n - rmean * rmean)) / ideal * 1e6;
+    return r;
+}
+
+int main(void)
+{
+    // Within the +/-5% range the loop can trim (RATE_CTRL_RANGE_PPM), with margin
+    static const double drifts[] = {0, -100, 100, -500, 500, -5000, 5000, -20000, 20000, -40000, 40000};
+    const uint32_t starts[] = {0, 2 * RATE_CTRL_TARGET_LEVEL};
+
+    printf("%8s %5s %4s %7s %11s %8s %10s %10s\n", "drift", "start", "meas", "lock s", "level mean", "level sd",
+           "ratio ppm", "jitter ppm");
+    uint32_t seed = 0x52435452;
+    for (size_t d = 0; d < sizeof(drifts) / sizeof(drifts[0]); d++) {
+        for (int s = 0; s < 2; s++) {
+            for (int m = 0; m < 2; m++) {
+                sim_result_t r = simulate(drifts[d], starts[s], m, seed);
+                test_rand(&seed);
+                printf("%+8.0f %5u %4d %7.2f %11.2f %8.2f %+10.2f %10.2f\n", drifts[d], starts[s], m,
+                       r.lock_frame / 60.0, r.level_mean, r.level_sd, r.ratio_error_ppm, r.ratio_jitter_ppm);
+
+                CHECK_MSG(r.lock_frame >= 0 && r.lock_frame <= LOCK_FRAMES_MAX, "%+.0f ppm: locked at frame %d",
+                          drifts[d], r.lock_frame);
+                CHECK_MSG(r.short_after_lock == 0, "%+.0f ppm: %u short frames after lock", drifts[d],
+                          r.short_after_lock);
+                CHECK_MSG(fabs(r.level_mean - RATE_CTRL_TARGET_LEVEL) <= LEVEL_ERROR_MAX,
+                          "%+.0f ppm: backlog settled at %.2f", drifts[d], r.level_mean);
+                CHECK_MSG(fabs(r.ratio_error_ppm) <= RATIO_ERROR_PPM_MAX, "%+.0f ppm: ratio off by %.2f ppm",
+                          drifts[d], r.ratio_error_ppm);
+                CHECK_MSG(r.ratio_jitter_ppm <= RATIO_JITTER_PPM_MAX, "%+.0f ppm: ratio jitter %.2f ppm",
+                          drifts[d], r.ratio_jitter_ppm);
+            }
+        }
+    }
+    return test_finish("test_rate_ctrl");
+}
@@ -0,0 +1,301 @@
+/**
+ * Signal lock manager transitions on replayed input traces.
+ *
+ * A trace is a list of segments with an input frame period (0 = no sync)
+ * and whether I2S is running. The input side is simulated in 100 us steps
+ * (VSYNCs with +-20 us jitter, 48 kHz sample counter) and signal_lock_update()
+ * is called once per 60 Hz output frame, as signal_lock_task() does on
+ * Core 1. Every update is recorded, and the checks look at the edges: when
+ * video goes live, held or blue, when audio mutes and unmutes, and when
+ * resyncs are requested.
+ */
+
+#include "signal_lock.h"
+#include "test_common.h"
+
+#include <string.h>
+
+#define STEP_US 100
+#define OUTPUT_FRAME_US 16683
+#define MAX_UPDATES 2048
+
+#define PERIOD_59_2 16897 // MVS 59.18 Hz
+#define PERIOD_60 16667
+
+typedef struct {
+    uint32_t t0_ms, t1_ms;
+    uint32_t period_us; // 0 = no sync
+    bool audio;
+} segment_t;
+
+typedef struct {
+    uint32_t t_us;
+    signal_lock_state_t state;
+    signal_lock_output_t out;
+} update_t;
+
+typedef struct {
+    update_t u[MAX_UPDATES];
+    int n;
+} record_t;
+
+signal_lock_t g_signal_lock;
+static record_t g_rec;
+
+static void run(const segment_t *segs, int nsegs, uint32_t end_ms, bool audio_running)
+{
+    signal_lock_t *lk = &g_signal_lock;
+    signal_lock_init(lk);
+    memset(&g_rec, 0, sizeof(g_rec));
+
+    uint32_t seed = 1, vsyncs = 0, period = 0, samples = 0, sample_acc = 0;
+    uint32_t next_vsync = UINT32_MAX, last_vsync = UINT32_MAX, next_out = 0;
+    for (uint32_t t = 0; t < end_ms * 1000; t += STEP_US) {
+        const segment_t *s = NULL;
+        for (int i = 0; i < nsegs; i++) {
+            if (t >= segs[i].t0_ms * 1000 && t < segs[i].t1_ms * 1000) {
+                s = &segs[i];
+            }
+        }
+
+        if (s != NULL && s->period_us != 0) {
+            if (next_vsync == UINT32_MAX) {
+                next_vsync = t;
+            }
+            if (t >= next_vsync) {
+                vsyncs++;
+                if (last_vsync != UINT32_MAX) {
+                    period = t - last_vsync;
+                }
+                last_vsync = t;
+                next_vsync = t + s->period_us + test_rand(&seed) % 41 - 20;
+            }
+        } else {
+            next_vsync = UINT32_MAX;
+        }
+
+        // 48 kHz: 4.8 frames per step
+        if (s != NULL && s->audio) {
+            sample_acc += 48;
+            samples += sample_acc / 10;
+            sample_acc %= 10;
+        }
+
+        if (t >= next_out) {
+            next_out += OUTPUT_FRAME_US;
+            signal_lock_input_t in = {
+                .now_us = t,
+                .vsyncs = vsyncs,
+                .frame_period_us = period,
+                .audio_samples = samples,
+                .audio_running = audio_running,
+            };
+            const signal_lock_output_t *out = signal_lock_update(lk, &in);
+            if (g_rec.n < MAX_UPDATES) {
+                g_rec.u[g_rec.n++] = (update_t){.t_us = t, .state = lk->state, .out = *out};
+            }
+        }
+    }
+}
+
+// First update at or after from_ms whose video output is v (-1 = never)
+static int32_t first_video(signal_video_out_t v, uint32_t from_ms)
+{
+    for (int i = 0; i < g_rec.n; i++) {
+        if (g_rec.u[i].t_us >= from_ms * 1000 && g_rec.u[i].out.video == v) {
+            return (int32_t)g_rec.u[i].t_us;
+        }
+    }
+    return -1;
+}
+
+// First update at or after from_ms with audio muted == muted
+static int32_t first_mute(bool muted, uint32_t from_ms)
+{
+    for (int i = 0; i < g_rec.n; i++) {
+        if (g_rec.u[i].t_us >= from_ms * 1000 && g_rec.u[i].out.audio_muted == muted) {
+            return (int32_t)g_rec.u[i].t_us;
+        }
+    }
+    return -1;
+}
+
+// Updates in [from_ms, to_ms) with video output v / unmuted / resync requests
+static int count_video(signal_video_out_t v, uint32_t from_ms, uint32_t to_ms)
+{
+    int n = 0;
+    for (int i = 0; i < g_rec.n; i++) {
+        n += g_rec.u[i].t_us >= from_ms * 1000 && g_rec.u[i].t_us < to_ms * 1000 && g_rec.u[i].out.video == v;
+    }
+    return n;
+}
+
+static int count_unmuted(uint32_t from_ms, uint32_t to_ms)
+{
+    int n = 0;
+    for (int i = 0; i < g_rec.n; i++) {
+        n += g_rec.u[i].t_us >= from_ms * 1000 && g_rec.u[i].t_us < to_ms * 1000 && !g_rec.u[i].out.audio_muted;
+    }
+    return n;
+}
+
+static int count_resyncs(bool video, uint32_t from_ms, uint32_t to_ms)
+{
+    int n = 0;
+    for (int i = 0; i < g_rec.n; i++) {
+        const update_t *u = &g_rec.u[i];
+        if (u->t_us >= from_ms * 1000 && u->t_us < to_ms * 1000) {
+            n += video ? u->out.video_resync : u->out.audio_resync;
+        }
+    }
+    return n;
+}
+
+// Microseconds from ms to the edge at t_us
+static int32_t after(int32_t t_us, uint32_t ms)
+{
+    return t_us < 0 ? -1 : t_us - (int32_t)(ms * 1000);
+}
+
+static void test_cold_start(void)
+{
+    const segment_t trace[] = {{500, 3000, PERIOD_59_2, true}};
+    run(trace, 1, 3000, true);
+    const signal_lock_stats_t *st = &g_signal_lock.stats;
+
+    // Blue and muted until the input is there and stable
+    CHECK(count_video(SIGNAL_VIDEO_BLUE, 0, 500) > 0 && count_video(SIGNAL_VIDEO_LIVE, 0, 500) == 0);
+    CHECK(count_unmuted(0, 500) == 0);
+
+    // Lock after SIGNAL_LOCK_STABLE_FRAMES periods, unmute after the settle time
+    int32_t live = after(first_video(SIGNAL_VIDEO_LIVE, 500), 500);
+    int32_t unmute = after(first_mute(false, 500), 500);
+    CHECK_MSG(live >= SIGNAL_LOCK_STABLE_FRAMES * PERIOD_59_2 && live < 200000, "live after %d us", live);
+    CHECK_MSG(unmute >= live && unmute < 300000, "unmuted after %d us", unmute);
+    CHECK(count_video(SIGNAL_VIDEO_HOLD, 0, 3000) == 0);
+    CHECK(st->locks == 1 && st->video_losses == 0 && st->audio_losses == 0);
+    CHECK(st->video_recovery_us_last < 200000);
+}
+
+static void test_loss_hold_then_blue(void)
+{
+    const segment_t trace[] = {{500, 3000, PERIOD_59_2, true}, {6000, 9000, PERIOD_59_2, true}};
+    run(trace, 2, 9000, true);
+    const signal_lock_stats_t *st = &g_signal_lock.stats;
+
+    // Sync gone at 3 s: the last frame is held after the VSYNC timeout ...
+    int32_t hold = after(first_video(SIGNAL_VIDEO_HOLD, 3000), 3000);
+    CHECK_MSG(hold >= SIGNAL_LOCK_VIDEO_TIMEOUT_US && hold < SIGNAL_LOCK_VIDEO_TIMEOUT_US + 2 * OUTPUT_FRAME_US,
+              "hold after %d us", hold);
+    // ... with audio muted at once and one video resync requested ...
+    CHECK(after(first_mute(true, 3000), 3000) <= hold);
+    CHECK(count_resyncs(true, 3000, 3200) == 1);
+    // ... then blue once SIGNAL_LOCK_HOLD_US has passed since the last VSYNC
+    int32_t blue = after(first_video(SIGNAL_VIDEO_BLUE, 3000), 3000);
+    CHECK_MSG(blue >= SIGNAL_LOCK_HOLD_US && blue < SIGNAL_LOCK_HOLD_US + 2 * OUTPUT_FRAME_US, "blue after %d us", blue);
+    CHECK(count_video(SIGNAL_VIDEO_LIVE, 3100, 6000) == 0 && count_unmuted(3100, 6000) == 0);
+
+    // Back after 3 s: the old period is forgotten, so a full acquisition
+    int32_t live = after(first_video(SIGNAL_VIDEO_LIVE, 6000), 6000);
+    CHECK_MSG(live >= SIGNAL_LOCK_STABLE_FRAMES * PERIOD_59_2 && live < 200000, "relive after %d us", live);
+    CHECK(count_video(SIGNAL_VIDEO_HOLD, 6000, 9000) == 0);
+    CHECK(st->locks == 2 && st->video_losses == 1);
+}
+
+static void test_short_outage_relock(void)
+{
+    const segment_t trace[] = {{500, 3000, PERIOD_59_2, true}, {3200, 6000, PERIOD_59_2, true}};
+    run(trace, 2, 6000, true);
+    const signal_lock_stats_t *st = &g_signal_lock.stats;
+
+    // 200 ms gap: held the whole time, never blue, fast relock on the old period
+    CHECK(count_video(SIGNAL_VIDEO_BLUE, 1000, 6000) == 0);
+    CHECK(count_video(SIGNAL_VIDEO_HOLD, 3000, 3200) > 0);
+    int32_t live = after(first_video(SIGNAL_VIDEO_LIVE, 3200), 3200);
+    CHECK_MSG(live >= SIGNAL_LOCK_RELOCK_FRAMES * PERIOD_59_2 && live < 80000, "relock after %d us", live);
+    CHECK(st->locks == 2 && st->video_losses == 1 && st->video_recovery_us_last < 80000);
+
+    // Audio follows the video lock back
+    int32_t unmute = after(first_mute(false, 3200), 3200);
+    CHECK_MSG(unmute >= live && unmute < 150000, "unmuted after %d us", unmute);
+}
+
+static void test_audio_gap(void)
+{
+    const segment_t trace[] = {
+        {500, 3000, PERIOD_59_2, true}, {3000, 3500, PERIOD_59_2, false}, {3500, 6000, PERIOD_59_2, true}};
+    run(trace, 3, 6000, true);
+    const signal_lock_stats_t *st = &g_signal_lock.stats;
+
+    // Video unaffected
+    CHECK(count_video(SIGNAL_VIDEO_HOLD, 1000, 6000) == 0 && count_video(SIGNAL_VIDEO_BLUE, 1000, 6000) == 0);
+    CHECK(st->locks == 1 && st->video_losses == 0 && count_resyncs(true, 1000, 6000) == 0);
+
+    // Muted within the I2S timeout, realigned every retry period while silent
+    int32_t mute = after(first_mute(true, 3000), 3000);
+    CHECK_MSG(mute > SIGNAL_LOCK_AUDIO_TIMEOUT_US && mute < SIGNAL_LOCK_AUDIO_TIMEOUT_US + 2 * OUTPUT_FRAME_US,
+              "muted after %d us", mute);
+    int resyncs = count_resyncs(false, 3000, 3500);
+    CHECK_MSG(resyncs == 2, "%d audio resyncs in a 500 ms gap", resyncs);
+    CHECK(count_resyncs(false, 3600, 6000) == 0);
+    CHECK(st->audio_losses == 1);
+
+    // Unmuted once audio has run for the settle time
+    int32_t unmute = after(first_mute(false, 3500), 3500);
+    CHECK_MSG(unmute >= SIGNAL_LOCK_AUDIO_SETTLE_US && unmute < 100000, "unmuted after %d us", unmute);
+}
+
+static void test_period_change(void)
+{
+    const segment_t trace[] = {{500, 3000, PERIOD_59_2, true}, {3000, 6000, PERIOD_60, true}};
+    run(trace, 2, 6000, true);
+    const signal_lock_stats_t *st = &g_signal_lock.stats;
+
+    // 59.2 -> 60 Hz while locked: held (not blue) while the new period is acquired
+    CHECK(st->unstable == 1 && st->locks == 2 && st->video_losses == 0);
+    CHECK(count_resyncs(true, 3000, 3200) == 1);
+    CHECK(count_video(SIGNAL_VIDEO_BLUE, 1000, 6000) == 0);
+    // The drop comes after SIGNAL_LOCK_UNSTABLE_FRAMES bad periods and mutes audio with it
+    int32_t hold = after(first_video(SIGNAL_VIDEO_HOLD, 3000), 3000);
+    CHECK_MSG(hold >= (SIGNAL_LOCK_UNSTABLE_FRAMES - 1) * PERIOD_60 && hold < 100000, "hold after %d us", hold);
+    CHECK(after(first_mute(true, 3000), 3000) == hold);
+    CHECK(st->video_recovery_us_last < 250000);
+}
+
+static void test_no_input(void)
+{
+    run(NULL, 0, 3000, true);
+    const signal_lock_stats_t *st = &g_signal_lock.stats;
+
+    // Blue and muted throughout, the I2S capture retried every period
+    CHECK(count_video(SIGNAL_VIDEO_BLUE, 0, 3000) == g_rec.n && count_unmuted(0, 3000) == 0);
+    CHECK(g_signal_lock.state == SIGNAL_LOCK_NO_SIGNAL);
+    int resyncs = count_resyncs(false, 0, 3000);
+    CHECK_MSG(resyncs >= 14 && resyncs <= 15, "%d audio resyncs in 3 s", resyncs);
+    CHECK(st->audio_losses == 0 && count_resyncs(true, 0, 3000) == 0);
+}
+
+static void test_audio_not_started(void)
+{
+    const segment_t trace[] = {{500, 3000, PERIOD_59_2, false}};
+    run(trace, 1, 3000, false);
+    const signal_lock_stats_t *st = &g_signal_lock.stats;
+
+    // Video locks as usual; the audio half stays muted and never resyncs
+    CHECK(first_video(SIGNAL_VIDEO_LIVE, 500) > 0);
+    CHECK(count_unmuted(0, 3000) == 0);
+    CHECK(count_resyncs(false, 0, 3000) == 0);
+    CHECK(st->audio_losses == 0 && st->audio_resyncs == 0);
+}
+
+int main(void)
+{
+    test_cold_start();
+    test_loss_hold_then_blue();
+    test_short_outage_relock();
+    test_audio_gap();
+    test_period_change();
+    test_no_input();
+    test_audio_not_started();
+    return test_finish("test_signal_lock");
+}
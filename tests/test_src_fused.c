@@ -0,0 +1,121 @@
+/**
+ * Fused DC block + lowpass + SRC against the separate stages.
+ *
+ * The same input goes through dc_filter_process_buffer() +
+ * lowpass_process_buffer() + src_process() and through src_process_fused(),
+ * in random block sizes (1-64 samples, like the pipeline's spans) and with
+ * the ratio moved by src_set_step() between blocks as the rate controller
+ * does. Output count, consumed count and every output sample must match,
+ * and the filter state left behind must be identical, for LINEAR and
+ * POLYPHASE. The input mixes full-scale noise (saturation paths), a sine and
+ * a DC offset.
+ *
+ * Built as well with the float DSP path (AUDIO_*_FLOAT=1).
+ */
+
+#include "src.h"
+#include "test_common.h"
+
+#include <math.h>
+#include <string.h>
+
+#define SAMPLES 200000
+#define BLOCK_MAX 64
+#define OUT_MAX (2 * BLOCK_MAX)
+
+static audio_sample_t g_input[SAMPLES];
+static audio_sample_t g_staged_in[BLOCK_MAX];
+static audio_sample_t g_staged_out[OUT_MAX];
+static audio_sample_t g_fused_out[OUT_MAX];
+
+static void make_input(void)
+{
+    uint32_t seed = 0x46555345;
+    for (int n = 0; n < SAMPLES; n++) {
+        int32_t l, r;
+        if ((n / 20000) % 2 == 0) {
+            // Full-scale noise
+            l = (int16_t)test_rand(&seed);
+            r = (int16_t)test_rand(&seed);
+        } else {
+            // 1 kHz / 7 kHz tones on a DC offset, with a little noise
+            l = (int32_t)lrint(3000 + 25000 * sin(2 * 3.14159265358979 * 1000 * n / 55556.0));
+            r = (int32_t)lrint(-2000 + 20000 * sin(2 * 3.14159265358979 * 7000 * n / 55556.0));
+            l += (int32_t)(test_rand(&seed) % 65) - 32;
+            r += (int32_t)(test_rand(&seed) % 65) - 32;
+        }
+        g_input[n].left = (int16_t)l;
+        g_input[n].right = (int16_t)r;
+    }
+}
+
+static void test_mode(src_mode_t mode)
+{
+    src_t s_staged, s_fused;
+    dc_filter_t dc_staged, dc_fused;
+    lowpass_t lp_staged, lp_fused;
+
+    src_init(&s_staged, SRC_INPUT_RATE_DEFAULT, SRC_OUTPUT_RATE_DEFAULT);
+    src_set_mode(&s_staged, mode);
+    dc_filter_init(&dc_staged);
+    dc_staged.enabled = true;
+    lowpass_init(&lp_staged, SRC_INPUT_RATE_DEFAULT, LOWPASS_CUTOFF_HZ);
+    s_fused = s_staged;
+    dc_fused = dc_staged;
+    lp_fused = lp_staged;
+    CHECK(src_fused_supported(&s_fused, &dc_fused, &lp_fused));
+
+    const uint32_t nominal = s_staged.step;
+    uint32_t seed = 0x53544147 + mode;
+    uint32_t blocks = 0, outputs = 0, mismatched_blocks = 0;
+
+    for (uint32_t i = 0; i < SAMPLES;) {
+        uint32_t block = 1 + test_rand(&seed) % BLOCK_MAX;
+        if (block > SAMPLES - i) {
+            block = SAMPLES - i;
+        }
+
+        // Ratio trims of up to +/-5%, as rate_ctrl applies them
+        if (test_rand(&seed) % 16 == 0) {
+            int32_t ppm = (int32_t)(test_rand(&seed) % 100001) - 50000;
+            uint32_t step = (uint32_t)((int64_t)nominal + (int64_t)nominal * ppm / 1000000);
+            src_set_step(&s_staged, step);
+            src_set_step(&s_fused, step);
+        }
+
+        memcpy(g_staged_in, &g_input[i], block * sizeof(audio_sample_t));
+        dc_filter_process_buffer(&dc_staged, g_staged_in, block);
+        lowpass_process_buffer(&lp_staged, g_staged_in, block);
+        uint32_t used_staged, used_fused;
+        uint32_t n_staged = src_process(&s_staged, g_staged_in, block, g_staged_out, OUT_MAX, &used_staged);
+        uint32_t n_fused = src_process_fused(&s_fused, &dc_fused, &lp_fused, &g_input[i], block, g_fused_out, OUT_MAX,
+                                             &used_fused);
+
+        CHECK(used_staged == block);
+        if (n_staged != n_fused || used_staged != used_fused ||
+            memcmp(g_staged_out, g_fused_out, n_staged * sizeof(audio_sample_t)) != 0) {
+            if (mismatched_blocks++ == 0) {
+                fprintf(stderr, "%s: first mismatch in the block at input %u\n", src_mode_name(mode), i);
+            }
+        }
+        outputs += n_staged;
+        blocks++;
+        i += block;
+    }
+
+    CHECK_MSG(mismatched_blocks == 0, "%s: %u of %u blocks differ", src_mode_name(mode), mismatched_blocks, blocks);
+    CHECK(memcmp(&dc_staged.state, &dc_fused.state, sizeof(dc_staged.state)) == 0);
+    CHECK(memcmp(lp_staged.state, lp_fused.state, sizeof(lp_staged.state)) == 0);
+    CHECK(s_staged.phase == s_fused.phase);
+    // Roughly 48/55.6 of the input came out
+    CHECK(outputs > SAMPLES * 0.8 && outputs < SAMPLES * 0.93);
+    printf("%s: %u blocks, %u output samples compared\n", src_mode_name(mode), blocks, outputs);
+}
+
+int main(void)
+{
+    make_input();
+    test_mode(SRC_MODE_LINEAR);
+    test_mode(SRC_MODE_POLYPHASE);
+    return test_finish(AUDIO_SRC_FLOAT ? "test_src_fused_float" : "test_src_fused");
+}
@@ -0,0 +1,121 @@
+/**
+ * SRC quality: THD+N of LINEAR against POLYPHASE.
+ *
+ * Sines at the MVS input rate (55556 Hz) are resampled to 48 kHz in
+ * 64-sample blocks. A least-squares fit of a sine at the expected output
+ * frequency is subtracted from the result, and the residual relative to the
+ * fitted tone is the THD+N. The polyphase bank has to stay under fixed
+ * limits through the passband and beat linear interpolation by a wide margin.
+ * A 30 kHz input, which folds to 18 kHz at the output rate, has to be
+ * suppressed.
+ *
+ * Built as well with AUDIO_SRC_FLOAT=1 for the float bank.
+ */
+
+#include "src.h"
+#include "test_common.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#define SAMPLES 120000
+#define SETTLE 2000
+#define AMPLITUDE 16000.0
+#define BLOCK 64
+#define PI 3.14159265358979
+
+static audio_sample_t g_in[SAMPLES];
+static audio_sample_t g_out[SAMPLES];
+
+static uint32_t resample(src_mode_t mode, double f, double *out_rate)
+{
+    for (int n = 0; n < SAMPLES; n++) {
+        int16_t v = (int16_t)lrint(AMPLITUDE * sin(2 * PI * f * n / SRC_INPUT_RATE_DEFAULT));
+        g_in[n].left = v;
+        g_in[n].right = (int16_t)-v;
+    }
+
+    src_t s;
+    src_init(&s, SRC_INPUT_RATE_DEFAULT, SRC_OUTPUT_RATE_DEFAULT);
+    src_set_mode(&s, mode);
+    *out_rate = SRC_INPUT_RATE_DEFAULT * (double)SRC_STEP_ONE / s.step;
+
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < SAMPLES;) {
+        uint32_t n = SAMPLES - i < BLOCK ? SAMPLES - i : BLOCK, used;
+        total += src_process(&s, &g_in[i], n, &g_out[total], SAMPLES - total, &used);
+        i += used;
+    }
+    return total;
+}
+
+// Residual power relative to the fitted tone, in dB; *level_db gets the
+// output power relative to the input tone
+static double thd_n_db(uint32_t count, double f, double fs, double *level_db)
+{
+    double ss = 0, cc = 0, sc = 0, ys = 0, yc = 0, total = 0;
+    for (uint32_t i = SETTLE; i < count; i++) {
+        double w = 2 * PI * f * i / fs, sn = sin(w), cs = cos(w), y = g_out[i].left;
+        ss += sn * sn;
+        cc += cs * cs;
+        sc += sn * cs;
+        ys += y * sn;
+        yc += y * cs;
+        total += y * y;
+    }
+    double det = ss * cc - sc * sc;
+    double a = (ys * cc - yc * sc) / det, b = (yc * ss - ys * sc) / det;
+
+    double signal = 0, residual = 0;
+    uint32_t mismatched = 0;
+    for (uint32_t i = SETTLE; i < count; i++) {
+        double w = 2 * PI * f * i / fs, fit = a * sin(w) + b * cos(w), e = g_out[i].left - fit;
+        signal += fit * fit;
+        residual += e * e;
+        // Rounding of the negated input may differ by one
+        mismatched += abs(g_out[i].right + g_out[i].left) > 1;
+    }
+    CHECK_MSG(mismatched == 0, "%.0f Hz: %u right samples are not the inverted left", f, mismatched);
+    *level_db = 10 * log10(total / (count - SETTLE) / (AMPLITUDE * AMPLITUDE / 2));
+    return 10 * log10(residual / signal);
+}
+
+int main(void)
+{
+    // Polyphase limits have ~6 dB of margin over the measured figures. At
+    // 1 kHz both modes are down at the 16-bit rounding floor; the gap opens
+    // as linear interpolation's images move into the band
+    static const struct {
+        double freq;
+        double poly_max_db;
+        double min_gain_db; // Polyphase improvement over LINEAR
+    } cases[] = {
+        {1000, -60, -3}, {5000, -46, 10}, {10000, -40, 15}, {15000, -36, 20}, {19000, -34, 24},
+    };
+
+    printf("%8s %12s %12s\n", "tone", "LINEAR", "POLYPHASE");
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        double fs, level, thd[2];
+        const src_mode_t modes[] = {SRC_MODE_LINEAR, SRC_MODE_POLYPHASE};
+        for (int m = 0; m < 2; m++) {
+            uint32_t count = resample(modes[m], cases[i].freq, &fs);
+            CHECK(count > SAMPLES * 0.85 && count < SAMPLES * 0.87);
+            thd[m] = thd_n_db(count, cases[i].freq, fs, &level);
+        }
+        printf("%6.0f Hz %9.1f dB %9.1f dB\n", cases[i].freq, thd[0], thd[1]);
+        CHECK_MSG(thd[1] <= cases[i].poly_max_db, "%.0f Hz: POLYPHASE THD+N %.1f dB", cases[i].freq, thd[1]);
+        CHECK_MSG(thd[0] - thd[1] >= cases[i].min_gain_db, "%.0f Hz: POLYPHASE only %.1f dB better than LINEAR",
+                  cases[i].freq, thd[0] - thd[1]);
+    }
+
+    // 30 kHz is above the output Nyquist: whatever gets through is alias
+    double fs, level[2];
+    for (int m = 0; m < 2; m++) {
+        uint32_t count = resample(m ? SRC_MODE_POLYPHASE : SRC_MODE_LINEAR, 30000, &fs);
+        thd_n_db(count, 30000, fs, &level[m]);
+    }
+    printf("30 kHz alias %6.1f dB %9.1f dB\n", level[0], level[1]);
+    CHECK_MSG(level[1] <= -60, "30 kHz input leaks through POLYPHASE at %.1f dB", level[1]);
+
+    return test_finish(AUDIO_SRC_FLOAT ? "test_src_quality_float" : "test_src_quality");
+}
@@ -0,0 +1,132 @@
+/**
+ * video_capture.pio on the PIO model: the frame state machine releases only
+ * active lines, and the pixel state machine packs two pixels per FIFO word,
+ * first pixel in the low half, so the words land in a uint16_t line buffer
+ * in pixel order on the little-endian core.
+ *
+ * Both programs run on an LCD waveform (lcd_waveform.h) with the X config
+ * words apply_timing() loads. The FIFO words of two whole frames are checked
+ * against the pixels on the bus, and a PCLK sweep finds how few system clocks
+ * per PCLK the program still keeps up with.
+ */
+
+#include "lcd_waveform.h"
+#include "pio_model.h"
+#include "test_common.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define PIO_PATH NEOPICO_SRC_DIR "/video/video_capture.pio"
+
+// A 320x240 panel: active window after the back porches, as the defaults
+#define H_BP 68
+#define H_ACTIVE 320
+#define V_BP 18
+#define V_ACTIVE 240
+
+static pio_model_program_t g_capture, g_frame;
+
+typedef struct {
+    uint32_t words;       // FIFO words received
+    uint32_t bad_words;   // Words that differ from the expected pixel pair
+    uint32_t frames;      // Frame starts signalled (IRQ 0)
+    uint32_t first_bad;   // Index of the first bad word
+    uint32_t got, expect; // ... and its value
+} capture_result_t;
+
+// Run both state machines for `frames` input frames and check the FIFO words
+static capture_result_t run_capture(uint32_t clocks_per_pclk, uint32_t frames)
+{
+    const lcd_waveform_t w = {
+        .clocks_per_pclk = clocks_per_pclk,
+        .h_total = 408,
+        .h_sync = 4,
+        .v_total = 262,
+        .v_sync = 3,
+    };
+
+    pio_model_t pio;
+    memset(&pio, 0, sizeof(pio));
+
+    // Configured as video_capture_init() does; X as loaded by load_sm_config()
+    pio_model_sm_t *px = pio_model_add_sm(&pio, &g_capture);
+    px->in_base = PIN_RGB_BASE;
+    px->in_shift_right = true;
+    px->autopush = true;
+    px->push_threshold = 32;
+    px->out_shift_right = true;
+    px->x = ((uint32_t)(H_ACTIVE / 2 - 1) << 16) | (H_BP - 1);
+
+    pio_model_sm_t *fr = pio_model_add_sm(&pio, &g_frame);
+    fr->out_shift_right = true;
+    fr->x = ((uint32_t)(V_ACTIVE - 1) << 16) | (V_BP - 1);
+
+    capture_result_t r = {0};
+    const uint32_t words_per_line = H_ACTIVE / 2;
+    const uint64_t frame_clocks = lcd_waveform_frame_clocks(&w);
+
+    // Start mid-frame, like a capture started at an arbitrary time, and stop
+    // just before the VSYNC after the last frame
+    for (uint64_t clk = frame_clocks / 2; clk < frame_clocks * (frames + 1); clk++) {
+        pio_model_step(&pio, lcd_waveform_gpios(&w, clk));
+
+        // The CPU acknowledges frame starts (IRQ 0)
+        if (pio.irq & 1) {
+            pio.irq &= ~1u;
+            r.frames++;
+        }
+
+        while (pio_model_rx_level(px) != 0) {
+            uint32_t word = pio_model_rx_get(px);
+            // The VSYNC line and V_BP lines after it are skipped
+            uint32_t line = V_BP + 1 + (r.words / words_per_line) % V_ACTIVE;
+            uint32_t pclk = H_BP + (r.words % words_per_line) * 2;
+            uint32_t expect = lcd_pixel(line, pclk) | (uint32_t)lcd_pixel(line, pclk + 1) << 16;
+            if (word != expect && r.bad_words++ == 0) {
+                r.first_bad = r.words;
+                r.got = word;
+                r.expect = expect;
+            }
+            r.words++;
+        }
+    }
+    return r;
+}
+
+int main(void)
+{
+    if (!pio_model_load(&g_capture, PIO_PATH, "video_capture") || !pio_model_load(&g_frame, PIO_PATH, "video_frame")) {
+        return 1;
+    }
+
+    // Two full frames at a comfortable PCLK (126 MHz / 8 = 15.75 MHz)
+    capture_result_t r = run_capture(8, 2);
+    CHECK_MSG(r.frames == 2, "%u frame starts", r.frames);
+    CHECK_MSG(r.words == 2 * V_ACTIVE * H_ACTIVE / 2, "%u FIFO words for two frames", r.words);
+    CHECK_MSG(r.bad_words == 0, "%u bad words, first #%u: got %08x, expected %08x", r.bad_words, r.first_bad, r.got,
+              r.expect);
+
+    // The word order as memory sees it: low half first
+    uint32_t word = lcd_pixel(V_BP + 1, H_BP) | (uint32_t)lcd_pixel(V_BP + 1, H_BP + 1) << 16;
+    uint16_t pixels[2];
+    memcpy(pixels, &word, sizeof(word));
+    CHECK(pixels[0] == lcd_pixel(V_BP + 1, H_BP) && pixels[1] == lcd_pixel(V_BP + 1, H_BP + 1));
+
+    // Fastest PCLK captured correctly for one frame. The pixel loop alone
+    // manages 4 clocks per PCLK; the `out y, 16` between the back porch loop
+    // and the first pixel makes it miss the first rising edge at 4, so the
+    // limit is 5 (25.2 MHz at 126 MHz), well above the panel's PCLK
+    uint32_t fastest = 0;
+    for (uint32_t cpp = 8; cpp >= 2; cpp--) {
+        capture_result_t s = run_capture(cpp, 1);
+        if (s.words != V_ACTIVE * H_ACTIVE / 2 || s.bad_words != 0) {
+            break;
+        }
+        fastest = cpp;
+    }
+    printf("video_capture keeps up down to %u system clocks per PCLK\n", fastest);
+    CHECK(fastest != 0 && fastest <= 5);
+
+    return test_finish("test_video_capture_pio");
+}
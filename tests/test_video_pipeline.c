@@ -0,0 +1,172 @@
+/**
+ * Golden-frame test of the scanline path: synthetic frames go through the
+ * frame manager and video_pipeline_scanline_callback() for all 480 output
+ * lines, and each output frame is compared with a committed golden frame.
+ *
+ * Golden frames are stored as one CRC-32 per output line (tests/golden/
+ * video_<name>.crc), so a mismatch names the first bad line. Every line is
+ * also checked against the definition of pixel doubling directly.
+ *
+ *   test_video_pipeline               compare against the golden frames
+ *   test_video_pipeline --update      rewrite the golden frames
+ *   test_video_pipeline --dump DIR    also write each output frame as PPM
+ */
+
+#include "video_frames.h"
+
+#include "pico_hdmi/video_output.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+uint16_t g_frame_buf[FRAME_BUFFER_COUNT][FRAME_WIDTH * FRAME_HEIGHT];
+
+static uint32_t g_out[OUTPUT_HEIGHT][OUTPUT_WIDTH / 2];
+static bool g_update;
+static const char *g_dump_dir;
+
+// Output frame as 8-bit PPM (RGB565 expanded) for inspection
+static void dump_ppm(const char *name)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/video_%s.ppm", g_dump_dir, name);
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        return;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", OUTPUT_WIDTH, OUTPUT_HEIGHT);
+    for (uint32_t y = 0; y < OUTPUT_HEIGHT; y++) {
+        const uint16_t *px = (const uint16_t *)g_out[y];
+        for (uint32_t x = 0; x < OUTPUT_WIDTH; x++) {
+            uint8_t rgb[3] = {(uint8_t)((px[x] >> 11) << 3), (uint8_t)(((px[x] >> 5) & 0x3F) << 2),
+                              (uint8_t)((px[x] & 0x1F) << 3)};
+            fwrite(rgb, 1, 3, f);
+        }
+    }
+    fclose(f);
+}
+
+// Compare (or with --update, write) the per-line CRCs of g_out
+static void check_golden(const char *name)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/video_%s.crc", NEOPICO_TEST_GOLDEN_DIR, name);
+    if (g_dump_dir != NULL) {
+        dump_ppm(name);
+    }
+
+    FILE *f = fopen(path, g_update ? "w" : "r");
+    CHECK_MSG(f != NULL, "cannot open %s", path);
+    if (f == NULL) {
+        return;
+    }
+    for (uint32_t y = 0; y < OUTPUT_HEIGHT; y++) {
+        uint32_t crc = test_crc32(0, g_out[y], sizeof(g_out[y]));
+        if (g_update) {
+            fprintf(f, "%08x\n", crc);
+            continue;
+        }
+        unsigned golden = 0;
+        if (fscanf(f, "%x", &golden) != 1 || golden != crc) {
+            CHECK_MSG(false, "%s: output line %u differs from the golden frame", name, y);
+            break;
+        }
+    }
+    fclose(f);
+}
+
+// Every output line is its source line with each pixel doubled
+static void check_doubled(test_frame_t kind)
+{
+    static uint16_t src[FRAME_WIDTH * FRAME_HEIGHT];
+    test_frame_fill(src, kind);
+    for (uint32_t y = 0; y < OUTPUT_HEIGHT; y++) {
+        const uint16_t *row = &src[(y >> 1) * FRAME_WIDTH];
+        for (uint32_t x = 0; x < FRAME_WIDTH; x++) {
+            if (g_out[y][x] != ((uint32_t)row[x] | (uint32_t)row[x] << 16)) {
+                CHECK_MSG(false, "output (%u, %u) is not the doubled source pixel", x * 2, y);
+                return;
+            }
+        }
+    }
+}
+
+static void check_fill(uint16_t color)
+{
+    uint32_t word = (uint32_t)color | (uint32_t)color << 16;
+    for (uint32_t y = 0; y < OUTPUT_HEIGHT; y++) {
+        for (uint32_t x = 0; x < OUTPUT_WIDTH / 2; x++) {
+            if (g_out[y][x] != word) {
+                CHECK_MSG(false, "output (%u, %u) is not the fill colour", x * 2, y);
+                return;
+            }
+        }
+    }
+}
+
+static void render_and_check(const char *golden, test_frame_t kind)
+{
+    memset(g_out, 0xA5, sizeof(g_out));
+    test_frame_render(g_out);
+    check_golden(golden);
+    check_doubled(kind);
+}
+
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--update") == 0) {
+            g_update = true;
+        } else if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc) {
+            g_dump_dir = argv[++i];
+        }
+    }
+
+    frame_manager_init();
+    video_pipeline_init(FRAME_WIDTH, FRAME_HEIGHT);
+    CHECK(host_video_output_scanline_callback() == video_pipeline_scanline_callback);
+
+    // Live frames, each picked up at the next output line 0
+    test_frame_publish(TEST_FRAME_BARS);
+    render_and_check("bars", TEST_FRAME_BARS);
+    test_frame_publish(TEST_FRAME_NOISE);
+    render_and_check("noise", TEST_FRAME_NOISE);
+
+    // No new frame: the last one is shown again
+    render_and_check("noise", TEST_FRAME_NOISE);
+
+#if VIDEO_SCANLINE_CACHE
+    // Second line of every source line pair came from the cache copy
+    video_pipeline_stats_t stats;
+    video_pipeline_get_stats(&stats);
+    CHECK(stats.cached_lines == FRAME_HEIGHT);
+#endif
+
+    // HOLD: a frame published meanwhile stays hidden until live video returns
+    video_pipeline_set_fallback(VIDEO_FALLBACK_HOLD);
+    test_frame_publish(TEST_FRAME_RAMP);
+    render_and_check("noise", TEST_FRAME_NOISE);
+    video_pipeline_set_fallback(VIDEO_FALLBACK_NONE);
+    render_and_check("ramp", TEST_FRAME_RAMP);
+
+    // BLUE: the no-signal colour on every line, source not read
+    video_pipeline_set_fallback(VIDEO_FALLBACK_BLUE);
+    memset(g_out, 0xA5, sizeof(g_out));
+    test_frame_render(g_out);
+    check_golden("blue");
+    check_fill(VIDEO_NO_SIGNAL_COLOR);
+
+    // The fallback is latched at line 0: a change mid-frame waits for the next
+    video_pipeline_set_fallback(VIDEO_FALLBACK_BLUE);
+    memset(g_out, 0xA5, sizeof(g_out));
+    for (uint32_t line = 0; line < OUTPUT_HEIGHT; line++) {
+        if (line == OUTPUT_HEIGHT / 2) {
+            video_pipeline_set_fallback(VIDEO_FALLBACK_NONE);
+        }
+        video_pipeline_scanline_callback(TEST_V_ACTIVE_START + line, line, g_out[line]);
+    }
+    check_fill(VIDEO_NO_SIGNAL_COLOR);
+    render_and_check("ramp", TEST_FRAME_RAMP);
+
+    return test_finish("test_video_pipeline");
+}
@@ -0,0 +1,246 @@
+/**
+ * Input timing detection: the video_timing probe program on the PIO model,
+ * and video_timing_detect() on sync-count traces.
+ *
+ * The probe part runs src/video/video_timing.pio against an LCD waveform the
+ * way video_capture_detect_timing() does (HSYNC counted in PCLKs, then VSYNC
+ * counted in HSYNCs) and checks the counts it reports and the timing derived
+ * from them, plus the fastest PCLK it still counts exactly.
+ *
+ * The trace part replays fixture files given on the command line. A fixture
+ * holds samples in the units measure_sync() stores them in, the defaults to
+ * fit into, and the expected outcome:
+ *
+ *   # comment
+ *   defaults <h_bp> <h_active> <v_bp> <v_active>
+ *   h <pulse> <period>                 (one per HSYNC sample)
+ *   v <pulse> <period>                 (one per VSYNC sample)
+ *   expect <h_total> <h_sync> <h_bp> <h_active> <v_total> <v_sync> <v_bp> <v_active>
+ *   expect reject
+ *
+ *   test_video_timing --record FILE    write the probe's trace as a fixture
+ */
+
+#include "lcd_waveform.h"
+#include "pio_model.h"
+#include "test_common.h"
+#include "video_config.h"
+#include "video_timing.h"
+
+#include <string.h>
+
+#define PIO_PATH NEOPICO_SRC_DIR "/video/video_timing.pio"
+
+// As in video_capture.c
+#define TIMING_H_SAMPLES 16
+#define TIMING_V_SAMPLES 5
+
+static pio_model_program_t g_probe;
+
+static const video_timing_t g_defaults = {
+    .h_back_porch = H_BACK_PORCH,
+    .h_active = FRAME_WIDTH,
+    .v_back_porch = V_BACK_PORCH,
+    .v_active = FRAME_HEIGHT,
+};
+
+// -----------------------------------------------------------------------------
+// Probe program
+// -----------------------------------------------------------------------------
+
+// measure_sync(): run the probe with the given sync and count pins until
+// `count` samples are in (or the clock limit), pairing pulse and period words
+static uint32_t measure_sync(const lcd_waveform_t *w, uint64_t start, uint32_t sync_pin, uint32_t clk_pin,
+                             video_timing_sample_t *samples, uint32_t count, uint64_t clock_limit)
+{
+    static pio_model_t pio;
+    memset(&pio, 0, sizeof(pio));
+    pio_model_sm_t *sm = pio_model_add_sm(&pio, &g_probe);
+    sm->in_base = clk_pin;
+    sm->jmp_pin = sync_pin;
+    sm->in_shift_right = false;
+    sm->autopush = true;
+    sm->push_threshold = 32;
+
+    uint32_t n = 0, words = 0;
+    for (uint64_t clk = start; n < count && clk < start + clock_limit; clk++) {
+        pio_model_step(&pio, lcd_waveform_gpios(w, clk));
+        while (pio_model_rx_level(sm) != 0 && n < count) {
+            // Counter runs down from 0xFFFFFFFF
+            uint32_t clocks = ~pio_model_rx_get(sm);
+            if (words++ % 2 == 0) {
+                samples[n].pulse = clocks;
+            } else {
+                samples[n++].period = clocks;
+            }
+        }
+    }
+    return n;
+}
+
+typedef struct {
+    video_timing_sample_t h[TIMING_H_SAMPLES];
+    video_timing_sample_t v[TIMING_V_SAMPLES];
+    uint32_t h_count, v_count;
+} probe_trace_t;
+
+static void probe(const lcd_waveform_t *w, probe_trace_t *t)
+{
+    // Started at an arbitrary point of the frame
+    uint64_t start = lcd_waveform_frame_clocks(w) / 3 + 7;
+    t->h_count = measure_sync(w, start, PIN_HSYNC, PIN_PCLK, t->h, TIMING_H_SAMPLES,
+                              (uint64_t)w->clocks_per_pclk * w->h_total * (TIMING_H_SAMPLES + 2));
+    t->v_count = measure_sync(w, start, PIN_VSYNC, PIN_HSYNC, t->v, TIMING_V_SAMPLES,
+                              lcd_waveform_frame_clocks(w) * (TIMING_V_SAMPLES + 2));
+}
+
+static bool trace_exact(const probe_trace_t *t, const lcd_waveform_t *w)
+{
+    for (uint32_t i = 0; i < t->h_count; i++) {
+        if (t->h[i].pulse != w->h_sync || t->h[i].period != w->h_total) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < t->v_count; i++) {
+        if (t->v[i].pulse != w->v_sync || t->v[i].period != w->v_total) {
+            return false;
+        }
+    }
+    return t->h_count == TIMING_H_SAMPLES && t->v_count == TIMING_V_SAMPLES;
+}
+
+static void test_probe(void)
+{
+    static probe_trace_t t;
+    lcd_waveform_t w = {.clocks_per_pclk = 20, .h_total = 408, .h_sync = 4, .v_total = 262, .v_sync = 3};
+
+    // A 6.3 MHz PCLK, about what the panel runs at
+    probe(&w, &t);
+    CHECK_MSG(trace_exact(&t, &w), "%u/%u samples, first H %u/%u, first V %u/%u", t.h_count, t.v_count,
+              t.h[0].pulse, t.h[0].period, t.v[0].pulse, t.v[0].period);
+
+    video_timing_t out;
+    CHECK(video_timing_detect(t.h, t.h_count, t.v, t.v_count, &g_defaults, &out));
+    CHECK(out.h_total == 408 && out.h_sync == 4 && out.h_back_porch == H_BACK_PORCH && out.h_active == FRAME_WIDTH);
+    CHECK(out.v_total == 262 && out.v_sync == 3 && out.v_back_porch == V_BACK_PORCH && out.v_active == FRAME_HEIGHT);
+
+    // Fastest PCLK counted exactly: five instructions per PCLK in the count loops
+    uint32_t fastest = 0;
+    for (uint32_t cpp = 10; cpp >= 2; cpp--) {
+        w.clocks_per_pclk = cpp;
+        probe(&w, &t);
+        if (!trace_exact(&t, &w)) {
+            break;
+        }
+        fastest = cpp;
+    }
+    printf("video_timing counts exactly down to %u system clocks per PCLK\n", fastest);
+    CHECK(fastest != 0 && fastest <= 6);
+}
+
+static int record(const char *path)
+{
+    static probe_trace_t t;
+    const lcd_waveform_t w = {.clocks_per_pclk = 20, .h_total = 408, .h_sync = 4, .v_total = 262, .v_sync = 3};
+    probe(&w, &t);
+
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        fprintf(stderr, "%s: cannot write\n", path);
+        return 1;
+    }
+    fprintf(f, "# video_timing probe on the PIO model: 408x262 LCD, HSYNC 4, VSYNC 3, 20 clocks per PCLK\n");
+    fprintf(f, "defaults %u %u %u %u\n", g_defaults.h_back_porch, g_defaults.h_active, g_defaults.v_back_porch,
+            g_defaults.v_active);
+    for (uint32_t i = 0; i < t.h_count; i++) {
+        fprintf(f, "h %u %u\n", t.h[i].pulse, t.h[i].period);
+    }
+    for (uint32_t i = 0; i < t.v_count; i++) {
+        fprintf(f, "v %u %u\n", t.v[i].pulse, t.v[i].period);
+    }
+    fclose(f);
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Fixture replay
+// -----------------------------------------------------------------------------
+
+static void replay(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        CHECK_MSG(false, "%s: cannot open", path);
+        return;
+    }
+
+    video_timing_sample_t h[VIDEO_TIMING_MAX_SAMPLES], v[VIDEO_TIMING_MAX_SAMPLES];
+    uint32_t h_count = 0, v_count = 0;
+    video_timing_t defaults = g_defaults, expect;
+    bool have_expect = false, expect_reject = false;
+    unsigned a[8];
+    char line[256];
+    int line_no = 0;
+
+    memset(&expect, 0, sizeof(expect));
+    while (fgets(line, sizeof(line), f) != NULL) {
+        line_no++;
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+        if (sscanf(line, "h %u %u", &a[0], &a[1]) == 2 && h_count < VIDEO_TIMING_MAX_SAMPLES) {
+            h[h_count++] = (video_timing_sample_t){a[0], a[1]};
+        } else if (sscanf(line, "v %u %u", &a[0], &a[1]) == 2 && v_count < VIDEO_TIMING_MAX_SAMPLES) {
+            v[v_count++] = (video_timing_sample_t){a[0], a[1]};
+        } else if (sscanf(line, "defaults %u %u %u %u", &a[0], &a[1], &a[2], &a[3]) == 4) {
+            defaults.h_back_porch = (uint16_t)a[0];
+            defaults.h_active = (uint16_t)a[1];
+            defaults.v_back_porch = (uint16_t)a[2];
+            defaults.v_active = (uint16_t)a[3];
+        } else if (strncmp(line, "expect reject", 13) == 0) {
+            have_expect = expect_reject = true;
+        } else if (sscanf(line, "expect %u %u %u %u %u %u %u %u", &a[0], &a[1], &a[2], &a[3], &a[4], &a[5], &a[6],
+                          &a[7]) == 8) {
+            expect = (video_timing_t){(uint16_t)a[0], (uint16_t)a[1], (uint16_t)a[2], (uint16_t)a[3],
+                                      (uint16_t)a[4], (uint16_t)a[5], (uint16_t)a[6], (uint16_t)a[7]};
+            have_expect = true;
+        } else {
+            CHECK_MSG(false, "%s:%d: cannot parse: %s", path, line_no, line);
+        }
+    }
+    fclose(f);
+    CHECK_MSG(have_expect, "%s: no expect line", path);
+
+    video_timing_t out;
+    bool ok = video_timing_detect(h, h_count, v, v_count, &defaults, &out);
+    if (expect_reject) {
+        CHECK_MSG(!ok, "%s: accepted, expected a rejection", path);
+    } else if (!ok) {
+        CHECK_MSG(false, "%s: rejected", path);
+    } else {
+        CHECK_MSG(memcmp(&out, &expect, sizeof(out)) == 0,
+                  "%s: got H %u/%u/%u/%u V %u/%u/%u/%u, expected H %u/%u/%u/%u V %u/%u/%u/%u", path, out.h_total,
+                  out.h_sync, out.h_back_porch, out.h_active, out.v_total, out.v_sync, out.v_back_porch, out.v_active,
+                  expect.h_total, expect.h_sync, expect.h_back_porch, expect.h_active, expect.v_total, expect.v_sync,
+                  expect.v_back_porch, expect.v_active);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (!pio_model_load(&g_probe, PIO_PATH, "video_timing")) {
+        return 1;
+    }
+    if (argc == 3 && strcmp(argv[1], "--record") == 0) {
+        return record(argv[2]);
+    }
+
+    test_probe();
+
+    CHECK_MSG(argc > 1, "no fixtures given");
+    for (int i = 1; i < argc; i++) {
+        replay(argv[i]);
+    }
+
+    return test_finish("test_video_timing");
+}
@@ -0,0 +1,64 @@
+/**
+ * Synthetic source frames and an output-frame driver for the video pipeline
+ * tests: fills capture buffers, publishes them through the frame manager and
+ * plays the HSTX loop by calling the scanline callback for every output line.
+ */
+
+#ifndef VIDEO_FRAMES_H
+#define VIDEO_FRAMES_H
+
+#include "test_common.h"
+#include "video_buffers.h"
+#include "video_config.h"
+#include "video_pipeline.h"
+
+#include <stdint.h>
+
+// First active line in the 525-line output frame (only passed through)
+#define TEST_V_ACTIVE_START (OUTPUT_V_TOTAL - OUTPUT_HEIGHT)
+
+typedef enum {
+    TEST_FRAME_BARS,  // Eight colour bars over a vertical ramp
+    TEST_FRAME_NOISE, // Every pixel random (catches any lane or index mixup)
+    TEST_FRAME_RAMP,  // Pixel value = x + y * width
+} test_frame_t;
+
+static inline void test_frame_fill(uint16_t *buf, test_frame_t kind)
+{
+    static const uint16_t bars[8] = {0xFFFF, 0xFFE0, 0x07FF, 0x07E0, 0xF81F, 0xF800, 0x001F, 0x0000};
+    uint32_t seed = 0x12345678u;
+    for (uint32_t y = 0; y < FRAME_HEIGHT; y++) {
+        for (uint32_t x = 0; x < FRAME_WIDTH; x++) {
+            uint16_t p;
+            switch (kind) {
+                case TEST_FRAME_BARS:
+                    p = bars[x * 8 / FRAME_WIDTH] ^ (uint16_t)(y >> 3);
+                    break;
+                case TEST_FRAME_NOISE:
+                    p = (uint16_t)test_rand(&seed);
+                    break;
+                default:
+                    p = (uint16_t)(x + y * FRAME_WIDTH);
+                    break;
+            }
+            buf[y * FRAME_WIDTH + x] = p;
+        }
+    }
+}
+
+// Capture side: write a frame into the capture buffer and publish it
+static inline void test_frame_publish(test_frame_t kind)
+{
+    test_frame_fill(g_frame_buf[frame_manager_write_index()], kind);
+    frame_manager_capture_done();
+}
+
+// Output side: one whole output frame, as the HSTX loop would request it
+static inline void test_frame_render(uint32_t out[OUTPUT_HEIGHT][OUTPUT_WIDTH / 2])
+{
+    for (uint32_t line = 0; line < OUTPUT_HEIGHT; line++) {
+        video_pipeline_scanline_callback(TEST_V_ACTIVE_START + line, line, out[line]);
+    }
+}
+
+#endif // VIDEO_FRAMES_H